@@ -0,0 +1,93 @@
+// Compares the perfect-hash keyword lookup against the comparison chain it replaced.
+// Build with `-DWOMBAT_BENCH=ON` and run `keyword_bench [words]`.
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "token.hpp"
+
+using Tokenizer::Keyword;
+
+// The lookup used before keywords were classified through a perfect hash.
+static Option<Keyword> keyword_from_token_chain(std::string_view lexeme) {
+    if(lexeme == "import") return Keyword::Import;
+    if(lexeme == "fn")     return Keyword::Fn;
+    if(lexeme == "end")    return Keyword::End;
+    if(lexeme == "return") return Keyword::Return;
+    if(lexeme == "if")     return Keyword::If;
+    if(lexeme == "else")   return Keyword::Else; 
+    if(lexeme == "let")    return Keyword::Let;
+    if(lexeme == "mut")    return Keyword::Mut;
+    if(lexeme == "loop")   return Keyword::Loop;
+    if(lexeme == "break")  return Keyword::Break;
+    if(lexeme == "with")   return Keyword::With;
+    if(lexeme == "and")    return Keyword::And;
+    if(lexeme == "or")     return Keyword::Or;
+    if(lexeme == "not")    return Keyword::Not;
+    if(lexeme == "ptr")    return Keyword::Ptr;
+    return std::nullopt;
+}
+
+// A keyword-heavy corpus, roughly two keywords for every identifier.
+static std::vector<std::string> build_corpus(size_t words) {
+    static const char* VOCABULARY[] = {
+        "fn", "let", "mut", "if", "else", "return", "loop", "break", "end",
+        "and", "or", "not", "ptr", "with", "import",
+        "main", "count", "fib", "n", "putnum", "x", "acc", "int", "char",
+        "true", "false", "retval", "endless", "lets", "iff",
+    };
+    CONST size_t VOCABULARY_SIZE = sizeof(VOCABULARY) / sizeof(VOCABULARY[0]);
+
+    std::vector<std::string> corpus;
+    corpus.reserve(words);
+
+    // A fixed LCG keeps the corpus identical between runs.
+    uint32_t state = 0x2545F491u;
+    for (size_t i = 0; i < words; ++i) {
+        state = state * 1664525u + 1013904223u;
+        corpus.emplace_back(VOCABULARY[(state >> 8) % VOCABULARY_SIZE]);
+    }
+    return corpus;
+}
+
+template<typename Lookup>
+static double measure(const std::vector<std::string>& corpus, Lookup lookup, size_t rounds, size_t& hits) {
+    auto start = std::chrono::steady_clock::now();
+    for (size_t r = 0; r < rounds; ++r) {
+        for (const auto& word : corpus) {
+            auto keyword = lookup(std::string_view{word});
+            hits += keyword.has_value() ? static_cast<size_t>(keyword.value()) + 1 : 0;
+        }
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    return std::chrono::duration<double, std::nano>(elapsed).count() / static_cast<double>(corpus.size() * rounds);
+}
+
+int main(int argc, char** argv) {
+    size_t words = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1'000'000;
+    CONST size_t ROUNDS = 20;
+
+    auto corpus = build_corpus(words);
+
+    // Both lookups must agree before timing anything.
+    for (const auto& word : corpus) {
+        ASSERT(
+            keyword_from_token_chain(word) == Tokenizer::keyword_from_token(word),
+            "keyword lookups disagree on: " + word
+        );
+    }
+
+    size_t chain_hits = 0, hash_hits = 0;
+    double chain_ns = measure(corpus, keyword_from_token_chain, ROUNDS, chain_hits);
+    double hash_ns = measure(corpus, [](std::string_view w) { return Tokenizer::keyword_from_token(w); }, ROUNDS, hash_hits);
+
+    std::printf("words: %zu x %zu rounds\n", words, ROUNDS);
+    std::printf("comparison chain: %6.2f ns/word (checksum %zu)\n", chain_ns, chain_hits);
+    std::printf("perfect hash:     %6.2f ns/word (checksum %zu)\n", hash_ns, hash_hits);
+    std::printf("speedup:          %6.2fx\n", chain_ns / hash_ns);
+    return 0;
+}
@@ -0,0 +1,184 @@
+// Compares tag-dispatched AST walks against the RTTI downcasts they replaced, on a synthetic program.
+// Build with `-DWOMBAT_BENCH=ON` and run `walk_bench [functions]`.
+
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+#include "lex.hpp"
+#include "parser.hpp"
+#include "ir.hpp"
+#include "sema_visitor.hpp"
+
+namespace fs = std::filesystem;
+
+// Nodes seen by a walk, indexed by `NodeId`.
+using NodeCounts = std::array<size_t, static_cast<size_t>(NodeId::FnCall) + 1>;
+
+// Every function exercises declarations, branches, loops, calls and pointer writes.
+static fs::path write_program(size_t functions) {
+    fs::path path = fs::temp_directory_path() / "walk_bench.wo";
+    std::ofstream out(path);
+
+    for (size_t i = 0; i < functions; ++i) {
+        out << "fn int f" << i << "(a: int, b: int)\n"
+            << "    mut x: int = a * 2 + b - (a % 3);\n"
+            << "    mut p: ptr(int) = &x;\n"
+            << "    if x > 10 and not (b == 4) { x = x - 1; } else { @p = @p + 1; }\n"
+            << "    loop {\n"
+            << "        if x < 0 { break; }\n"
+            << "        x = x - b - 1;\n"
+            << "    }\n"
+            << "    putnum(x);\n";
+        if (i == 0) {
+            out << "    return x;\n";
+        } else {
+            out << "    return f" << i - 1 << "(x, b);\n";
+        }
+        out << "end\n\n";
+    }
+    out << "fn int main()\n    return f" << functions - 1 << "(1, 2);\nend\n";
+    return path;
+}
+
+// The walk as it was written before, every downcast checked through RTTI.
+static void walk_rtti(Node* node, NodeCounts& counts) {
+    if (node == nullptr) return;
+    counts[static_cast<size_t>(node->id)]++;
+
+    if (auto* fn = dynamic_cast<FnNode*>(node)) {
+        walk_rtti(fn->header.get(), counts);
+        walk_rtti(fn->body.get(), counts);
+    } else if (auto* block = dynamic_cast<BlockNode*>(node)) {
+        for (auto& child : block->children) walk_rtti(child.get(), counts);
+    } else if (auto* decl = dynamic_cast<VarDeclarationNode*>(node)) {
+        walk_rtti(decl->init.get(), counts);
+    } else if (auto* assign = dynamic_cast<AssignmentNode*>(node)) {
+        walk_rtti(assign->rvalue.get(), counts);
+    } else if (auto* deref = dynamic_cast<DerefAssignmentNode*>(node)) {
+        walk_rtti(deref->lvalue.get(), counts);
+        walk_rtti(deref->rvalue.get(), counts);
+    } else if (auto* branch = dynamic_cast<IfNode*>(node)) {
+        walk_rtti(branch->condition.get(), counts);
+        walk_rtti(branch->if_block.get(), counts);
+        walk_rtti(branch->else_block.get(), counts);
+    } else if (auto* loop = dynamic_cast<LoopNode*>(node)) {
+        walk_rtti(loop->body.get(), counts);
+    } else if (auto* ret = dynamic_cast<ReturnNode*>(node)) {
+        walk_rtti(ret->expr.get(), counts);
+    } else if (auto* call = dynamic_cast<FnCallNode*>(node)) {
+        for (auto& arg : call->args) walk_rtti(arg.get(), counts);
+    } else if (auto* bin = dynamic_cast<BinOpNode*>(node)) {
+        walk_rtti(bin->lhs.get(), counts);
+        walk_rtti(bin->rhs.get(), counts);
+    } else if (auto* un = dynamic_cast<UnaryOpNode*>(node)) {
+        walk_rtti(un->lhs.get(), counts);
+    }
+}
+
+// The same walk through `NodeVisitor`.
+struct CountingVisitor : NodeVisitor<CountingVisitor> {
+    NodeCounts counts{};
+
+    void walk(Node* node) {
+        if (node == nullptr) return;
+        counts[static_cast<size_t>(node->id)]++;
+        dispatch(*node);
+    }
+
+    void visit(FnNode& fn) { walk(fn.header.get()); walk(fn.body.get()); }
+    void visit(BlockNode& block) { for (auto& child : block.children) walk(child.get()); }
+    void visit(VarDeclarationNode& decl) { walk(decl.init.get()); }
+    void visit(AssignmentNode& assign) { walk(assign.rvalue.get()); }
+    void visit(DerefAssignmentNode& deref) { walk(deref.lvalue.get()); walk(deref.rvalue.get()); }
+    void visit(IfNode& branch) {
+        walk(branch.condition.get());
+        walk(branch.if_block.get());
+        walk(branch.else_block.get());
+    }
+    void visit(LoopNode& loop) { walk(loop.body.get()); }
+    void visit(ReturnNode& ret) { walk(ret.expr.get()); }
+    void visit(FnCallNode& call) { for (auto& arg : call.args) walk(arg.get()); }
+    void visit(BinOpNode& bin) { walk(bin.lhs.get()); walk(bin.rhs.get()); }
+    void visit(UnaryOpNode& un) { walk(un.lhs.get()); }
+
+    // Leaves.
+    void visit(FnHeaderNode&) {}
+    void visit(LiteralNode&) {}
+    void visit(VarTerminalNode&) {}
+    void visit(BreakNode&) {}
+    void visit(ImportNode&) {}
+};
+
+template<typename Fn>
+static double measure_ms(Fn&& fn) {
+    auto start = std::chrono::steady_clock::now();
+    fn();
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    return std::chrono::duration<double, std::milli>(elapsed).count();
+}
+
+static size_t total(const NodeCounts& counts) {
+    size_t sum = 0;
+    for (size_t count : counts) sum += count;
+    return sum;
+}
+
+int main(int argc, char** argv) {
+    size_t functions = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 100'000;
+    CONST size_t ROUNDS = 10;
+
+    fs::path path = write_program(functions);
+
+    Arena arena;
+    AST ast;
+    double parse_ms = measure_ms([&] {
+        Lexer lexer(path.string());
+        lexer.open_and_populate_cursor();
+        Parser parser(lexer, arena);
+        parser.parse(ast);
+    });
+
+    NodeCounts rtti{};
+    double rtti_ms = measure_ms([&] {
+        for (size_t r = 0; r < ROUNDS; ++r) {
+            for (auto& fn : ast.functions) walk_rtti(fn.get(), rtti);
+        }
+    });
+
+    CountingVisitor tagged;
+    double tagged_ms = measure_ms([&] {
+        for (size_t r = 0; r < ROUNDS; ++r) {
+            for (auto& fn : ast.functions) tagged.walk(fn.get());
+        }
+    });
+
+    // Both walks must see the same tree before their timings mean anything.
+    ASSERT(rtti == tagged.counts, "walks disagree on the node counts.");
+
+    double sema_ms = measure_ms([&] {
+        SemanticVisitor globals;
+        for (auto& fn : ast.functions) globals.declare(*fn);
+        SemanticVisitor sema(&globals.table);
+        for (auto& fn : ast.functions) sema.visit(*fn);
+    });
+
+    WorkerPool pool(WorkerPool::hardware_workers());
+    IrProgram ir;
+    double ir_ms = measure_ms([&] { ir.gen(ast, pool); });
+
+    std::printf("functions: %zu, nodes: %zu, walks: %zu rounds\n", functions + 1, total(rtti) / ROUNDS, ROUNDS);
+    std::printf("parse:            %8.2f ms\n", parse_ms);
+    std::printf("rtti walk:        %8.2f ms\n", rtti_ms);
+    std::printf("tagged walk:      %8.2f ms\n", tagged_ms);
+    std::printf("speedup:          %8.2fx\n", rtti_ms / tagged_ms);
+    std::printf("sema:             %8.2f ms\n", sema_ms);
+    std::printf("ir lowering:      %8.2f ms (%zu functions, %zu workers)\n", ir_ms, ir.lowered_program.size(), pool.size());
+
+    fs::remove(path);
+    return 0;
+}
@@ -1,3 +1,5 @@
+#include <charconv>
+
 #include "env.hpp"
 #include "file.hpp"
 #include "builder.hpp"
@@ -63,6 +65,34 @@ void Builder::parse_out_file(std::span<char*>& args, size_t& cur) {
     config.dst = obj;
 }
 
+void Builder::parse_jobs(std::span<char*>& args, size_t& cur) {
+    auto jobs = next(args, cur);
+
+    if(!jobs) {
+        dump_err_and_exit(
+            ErrCode::NoInput, 
+            "-j requires a number of jobs", 
+            "try --help for more detailed information"
+        );
+    }
+
+    // Bump into the given count.
+    ++cur;
+    const std::string& count = jobs.value();
+
+    size_t parsed = 0;
+    auto [end, ec] = std::from_chars(count.data(), count.data() + count.size(), parsed);
+    if(ec != std::errc{} || end != count.data() + count.size() || parsed == 0) {
+        dump_err_and_exit(
+            ErrCode::InvalidArgument, 
+            "invalid number of jobs: " + count,
+            "-j expects a positive number, e.g -j 4"
+        );
+    }
+
+    config.jobs = parsed;
+}
+
 void Builder::parse_option(std::span<char*>& args, size_t& cur, const std::string& opt) {
     ASSERT(cur < args.size(), "Range exceeded when parsing an optional.");
     if(opt == "-v0") {
@@ -75,6 +105,16 @@ void Builder::parse_option(std::span<char*>& args, size_t& cur, const std::strin
         config.run = true;
     } else if(opt == "-o") {
         parse_out_file(args, cur);
+    } else if(opt == "-j") {
+        parse_jobs(args, cur);
+    } else if(opt == "-O0") {
+        config.opt_level = 0;
+    } else if(opt == "-O1") {
+        config.opt_level = 1;
+    } else if(opt == "-O2") {
+        config.opt_level = 2;
+    } else if(opt == "-O3") {
+        config.opt_level = 3;
     } else if(opt == "-C") {
         config.compile_only = true;
     } else if(opt == "-S") {
@@ -128,7 +168,10 @@ void Builder::parse_arguments(int argc, char** argv) {
     {   
         const auto& cur_arg = std::string(args[cur]);
 
-        if(cur_arg.starts_with(OPTION_PREFIX)) {
+        if(cur_arg == STDIN_SOURCE && !config.src) {
+            config.src = cur_arg;
+        }
+        else if(cur_arg.starts_with(OPTION_PREFIX)) {
             parse_option(args, cur, cur_arg);
         }
         else if(!config.src) {
@@ -167,6 +210,7 @@ void Builder::dump_err_and_exit(ErrCode code, const std::string& description, co
 
 void Builder::usage(const char* exec) const {
     std::printf("Usage: %s [options] <FILE>", exec);
+    std::printf("\n       <FILE> may be '-' to read the program from stdin.");
     std::printf("\n\n");
     std::printf("Options:\n");
     std::printf("    --run          - Run the executable after compilation.\n");
@@ -174,8 +218,13 @@ void Builder::usage(const char* exec) const {
     std::printf("                     Defaults to the ~/cwd/<file_name.wombat.out>.\n");
     std::printf("    --version      - Print version information.\n");
     std::printf("    --help         - Display this help menu.\n");
+    std::printf("    -j <N>         - Compile on <N> threads, defaults to one per hardware thread.\n");
+    std::printf("    -O0            - Do not optimize, the default.\n");
+    std::printf("    -O1            - Promote scalar locals into SSA form, fold constants and remove dead code.\n");
+    std::printf("    -O2            - As -O1, and keep values in registers with a linear-scan allocator.\n");
+    std::printf("    -O3            - As -O2, allocating registers by graph coloring with move coalescing.\n");
     std::printf("    -C             - Compile only, do not link or assemble.\n");
-    std::printf("    -S             - Compile and assemble, do not link.\n");
+    std::printf("    -S             - Write the assembly text into bin/, do not assemble or link.\n");
     std::printf("    -q             - Disable detailed process logging.\n");
     std::printf("    -v0            - Enable detailed subprocess logging.\n");
     std::printf("    -v1            - Enable deeper subprocess logging.\n");
@@ -33,6 +33,8 @@ struct BuildConfig {
     bool print_ast;
     bool print_tokens;
     bool print_ir;
+    size_t jobs = 0;    // Worker threads, 0 picks one per hardware thread.
+    size_t opt_level = 0; // Optimization level, from -O0 to -O3.
 
     BuildConfig() = default;
     BuildConfig(
@@ -78,6 +80,7 @@ struct Builder {
     void parse_arguments(int argc, char** argv);
     void parse_input_file(std::span<char*>& view, size_t& cur, std::string input);
     void parse_out_file(std::span<char*>& view, size_t& cur);
+    void parse_jobs(std::span<char*>& view, size_t& cur);
     void parse_option(std::span<char*>& view, size_t& cur, const std::string& opt);
 
     Option<std::string> next(std::span<char*>& view, size_t& cur);
@@ -5,7 +5,7 @@
 #include "pp_visitor.hpp"
 
 struct AST {
-    using FnContainer = std::vector<Ptr<FnNode>>;
+    using FnContainer = std::vector<ArenaPtr<FnNode>>;
 
     // Since `Wombat` is a functional programming language,
     // An AST is built from multiple functions.
@@ -13,13 +13,13 @@ struct AST {
 
     AST() : functions{} {}
 
-    void push_function(Ptr<FnNode>&& fn) {
+    void push_function(ArenaPtr<FnNode>&& fn) {
         functions.push_back(std::move(fn));
     }
 
     void traverse(PPVisitor& visitor) {
         for(const auto& fn : functions) {
-            fn->accept(visitor);
+            visitor.visit(*fn);
         }
     }
 };
@@ -5,11 +5,10 @@
 #include <optional>
 #include <sstream>
 
+#include "arena.hpp"
 #include "expr.hpp"
 #include "stmt.hpp"
 #include "typing.hpp"
-#include "pp_visitor.hpp"
-#include "sema_visitor.hpp"
 
 using Declaration::VarInfo;
 using Declaration::Parameter;
@@ -35,6 +34,8 @@ enum class NodeId : int {
     DerefAssign,
     // Represents a function declaration.
     FnDecl,
+    // Represents the signature of a function declaration.
+    FnHeader,
     // Represents a block of statements.
     Block,
     // Represents a break statement used to exit loops.
@@ -56,9 +57,9 @@ struct Node {
 
   Node(NodeId&& id) : id{std::move(id)} {}
 
+  // Nodes are only destroyed through their owning `ArenaPtr`, which may point at a base.
+  // Walks never go through the vtable, see `visit.hpp`.
   virtual ~Node() = default;
-  virtual void accept(PPVisitor& visitor) = 0;
-  virtual void analyze(SemanticVisitor& analyzer) = 0;
 
   std::string id_str() const noexcept {
     switch(id) {
@@ -80,6 +81,8 @@ struct Node {
           return "dereference_assignment";
       case NodeId::FnDecl:
           return "function_declaration";
+      case NodeId::FnHeader:
+          return "function_header";
       case NodeId::Block:
           return "block";
       case NodeId::Break:
@@ -107,20 +110,21 @@ enum class ValueCategory : int {
     RValue
 };
 
-struct StmtNode : virtual public Node {
+struct StmtNode : public Node {
   ~StmtNode() = default;
   StmtNode(NodeId&& id) : Node(std::move(id)) {}
 };
 
-struct ExprNode : virtual public Node {
+// Every expression can stand as a statement, e.g a function call whose value is discarded.
+struct ExprNode : public StmtNode {
   // A type attached to the expression during sema analysis.
-  SharedPtr<Type> sema_type;
+  TypeRef sema_type;
   // The value category of the expression, which can be either l-value or r-value.
   ValueCategory category = ValueCategory::RValue;
   // A mutability flag indicating whether the expression can be modified.
   Mutability mut = Mutability::Immutable;
 
-  ExprNode(NodeId&& id) : Node(std::move(id)), sema_type{nullptr} {}
+  ExprNode(NodeId&& id) : StmtNode(std::move(id)), sema_type{nullptr} {}
   ExprNode(ExprNode&&) noexcept = default;
   ExprNode& operator=(ExprNode&&) noexcept = default;
 
@@ -135,91 +139,54 @@ struct LiteralNode : public ExprNode {
   LiteralKind kind;
   Location src_loc;
 
-  LiteralNode(const Expr::Literal& expr) 
-    : Node(NodeId::Lit), 
-      ExprNode(NodeId::Lit), 
-      str(std::move(expr.val)), 
-      kind(std::move(expr.kind)), 
-      src_loc(std::move(expr.loc)) {}
+  LiteralNode(LitStr&& str, LiteralKind kind, Location loc) 
+    : ExprNode(NodeId::Lit), 
+      str(std::move(str)), 
+      kind(kind), 
+      src_loc(loc) {}
 
   inline bool match(LiteralKind k) const {
     return kind == k;
   }
-
-  void analyze(SemanticVisitor& analyzer) override {
-    analyzer.sema_analyze(*this);
-  }
-
-  void accept(PPVisitor& visitor) override {
-    visitor.visit(*this);
-  }
 };
 
 struct VarTerminalNode : public ExprNode {
   Identifier ident;
 
   explicit VarTerminalNode(Identifier&& ident)
-    : Node(NodeId::Term), 
-      ExprNode(NodeId::Term), 
+    : ExprNode(NodeId::Term), 
       ident(std::move(ident)) {}
-
-  void analyze(SemanticVisitor& analyzer) override {
-    analyzer.sema_analyze(*this);
-  }
-
-  void accept(PPVisitor& visitor) override {
-    visitor.visit(*this);
-  }
 };
 
 struct BinOpNode : public ExprNode {
   BinOpKind op;
-  Ptr<ExprNode> lhs;
-  Ptr<ExprNode> rhs;
+  ArenaPtr<ExprNode> lhs;
+  ArenaPtr<ExprNode> rhs;
 
-  BinOpNode(BinOpKind op_kind, Ptr<ExprNode> lhs, Ptr<ExprNode> rhs)
-    : Node(NodeId::Bin), 
-      ExprNode(NodeId::Bin), 
+  BinOpNode(BinOpKind op_kind, ArenaPtr<ExprNode> lhs, ArenaPtr<ExprNode> rhs)
+    : ExprNode(NodeId::Bin), 
       op{std::move(op_kind)}, 
       lhs(std::move(lhs)), 
       rhs(std::move(rhs)) {}
-
-  void analyze(SemanticVisitor& analyzer) override {
-    analyzer.sema_analyze(*this);
-  }
-
-  void accept(PPVisitor& visitor) override {
-    visitor.visit(*this);
-  }
 };
 
 struct UnaryOpNode : public ExprNode {
   UnOpKind op;
-  Ptr<ExprNode> lhs;
+  ArenaPtr<ExprNode> lhs;
 
-  UnaryOpNode(UnOpKind op_kind, Ptr<ExprNode> lhs)
-    : Node(NodeId::Un),
-      ExprNode(NodeId::Un), 
+  UnaryOpNode(UnOpKind op_kind, ArenaPtr<ExprNode> lhs)
+    : ExprNode(NodeId::Un), 
       op{std::move(op_kind)}, 
       lhs(std::move(lhs)) {}
-
-  void analyze(SemanticVisitor& analyzer) override {
-    analyzer.sema_analyze(*this);
-  }
-
-  void accept(PPVisitor& visitor) override {
-    visitor.visit(*this);
-  }
 };
 
 struct VarDeclarationNode : public StmtNode {
   VarInfo info;
-  Ptr<ExprNode> init;
+  ArenaPtr<ExprNode> init;
   Option<AssignOp> op;
 
-  VarDeclarationNode(VarInfo&& info, Option<AssignOp> op, Ptr<ExprNode>&& init)
-    : Node(NodeId::VarDecl), 
-      StmtNode(NodeId::VarDecl), 
+  VarDeclarationNode(VarInfo&& info, Option<AssignOp> op, ArenaPtr<ExprNode>&& init)
+    : StmtNode(NodeId::VarDecl), 
       info(std::move(info)), 
       init(std::move(init)), 
       op(std::move(op)) {}
@@ -227,60 +194,34 @@ struct VarDeclarationNode : public StmtNode {
   inline bool initialized() const {
     return init != nullptr;
   }
-
-  void analyze(SemanticVisitor& analyzer) override {
-    analyzer.sema_analyze(*this);
-  }
-
-  void accept(PPVisitor& visitor) override {
-    visitor.visit(*this);
-  }
 };
 
 struct AssignmentNode : public StmtNode {
   Tokenizer::AssignOp op;
   Identifier lvalue;
-  Ptr<ExprNode> rvalue;
+  ArenaPtr<ExprNode> rvalue;
 
-  AssignmentNode(Tokenizer::AssignOp op, Identifier lvalue, Ptr<ExprNode>&& rvalue)
-    : Node(NodeId::Assign), 
-      StmtNode(NodeId::Assign), 
+  AssignmentNode(Tokenizer::AssignOp op, Identifier lvalue, ArenaPtr<ExprNode>&& rvalue)
+    : StmtNode(NodeId::Assign), 
       op{std::move(op)}, 
       lvalue(std::move(lvalue)), 
       rvalue(std::move(rvalue)) {}
-
-  void analyze(SemanticVisitor& analyzer) override {
-    analyzer.sema_analyze(*this);
-  }
-
-  void accept(PPVisitor& visitor) override {
-    visitor.visit(*this);
-  }
 };
 
 struct DerefAssignmentNode : public StmtNode {
   Tokenizer::AssignOp op;
-  Ptr<ExprNode> lvalue;
-  Ptr<ExprNode> rvalue;
+  ArenaPtr<ExprNode> lvalue;
+  ArenaPtr<ExprNode> rvalue;
 
   DerefAssignmentNode(
     Tokenizer::AssignOp op, 
-    Ptr<ExprNode>&& lvalue, 
-    Ptr<ExprNode>&& rvalue
+    ArenaPtr<ExprNode>&& lvalue, 
+    ArenaPtr<ExprNode>&& rvalue
   )
-    : Node(NodeId::DerefAssign), 
-      StmtNode(NodeId::Assign), 
+    : StmtNode(NodeId::DerefAssign), 
       op{std::move(op)}, 
       lvalue(std::move(lvalue)), 
       rvalue(std::move(rvalue)) {}
-
-  void analyze(SemanticVisitor& analyzer) override {
-    analyzer.sema_analyze(*this);
-  }
-
-  void accept(PPVisitor& visitor) override {
-    visitor.visit(*this);
-  }
 };
 
 struct FnHeaderNode : public StmtNode {
@@ -288,164 +229,83 @@ struct FnHeaderNode : public StmtNode {
 
   Identifier name;
   FnParams params;
-  SharedPtr<Type> ret_type;
+  TypeRef ret_type;
 
   FnHeaderNode(Declaration::FnHeader&& header) 
-    : Node(NodeId::FnDecl),
-      StmtNode(NodeId::FnDecl), 
+    : StmtNode(NodeId::FnHeader), 
       name(std::move(header.ident)),
       params(std::move(header.params)),
-      ret_type(std::move(header.ret_type)) {} 
-
-  void analyze(SemanticVisitor& analyzer) override {
-    analyzer.sema_analyze(*this);
-  }
-
-  void accept(PPVisitor& visitor) override {
-    visitor.visit(*this);
-  }
+      ret_type(header.ret_type) {} 
 };
 
 struct BlockNode : public StmtNode {
-  std::vector<Ptr<StmtNode>> children;
+  std::vector<ArenaPtr<StmtNode>> children;
 
-  BlockNode(std::vector<Ptr<StmtNode>>&& nodes)
-    : Node(NodeId::Block), 
-      StmtNode(NodeId::Block), 
+  BlockNode(std::vector<ArenaPtr<StmtNode>>&& nodes)
+    : StmtNode(NodeId::Block), 
       children(std::move(nodes)) {}
-
-  void analyze(SemanticVisitor& analyzer) override {
-    analyzer.sema_analyze(*this);
-  }
-
-  void accept(PPVisitor& visitor) override {
-    visitor.visit(*this);
-  }
 };
 
 struct BreakNode : public StmtNode {
-  BreakNode() : Node(NodeId::Break), StmtNode(NodeId::Break) {}
-
-  void analyze(SemanticVisitor& analyzer) override {
-    analyzer.sema_analyze(*this);
-  }
-
-  void accept(PPVisitor& visitor) override {
-    visitor.visit(*this);
-  }
+  BreakNode() : StmtNode(NodeId::Break) {}
 };
 
 struct LoopNode : public StmtNode {
-  Ptr<BlockNode> body;
+  ArenaPtr<BlockNode> body;
 
-  LoopNode(Ptr<BlockNode>&& loop_body)
-    : Node(NodeId::Loop), 
-      StmtNode(NodeId::Loop), 
+  LoopNode(ArenaPtr<BlockNode>&& loop_body)
+    : StmtNode(NodeId::Loop), 
       body(std::move(loop_body)) {}
-
-  void analyze(SemanticVisitor& analyzer) override {
-    analyzer.sema_analyze(*this);
-  }
-
-  void accept(PPVisitor& visitor) override {
-    visitor.visit(*this);
-  }
 };
 
 struct IfNode : public StmtNode {
-  Ptr<ExprNode> condition;
-  Ptr<BlockNode> if_block;
-  Ptr<BlockNode> else_block;
+  ArenaPtr<ExprNode> condition;
+  ArenaPtr<BlockNode> if_block;
+  ArenaPtr<BlockNode> else_block;
 
-  IfNode(Ptr<ExprNode> condition, Ptr<BlockNode>&& if_block, Ptr<BlockNode>&& else_block)
-  : Node(NodeId::If), 
-    StmtNode(NodeId::If), 
+  IfNode(ArenaPtr<ExprNode> condition, ArenaPtr<BlockNode>&& if_block, ArenaPtr<BlockNode>&& else_block)
+  : StmtNode(NodeId::If), 
     condition(std::move(condition)), 
     if_block(std::move(if_block)), 
     else_block(std::move(else_block)) {}
-
-  void analyze(SemanticVisitor& analyzer) override {
-    analyzer.sema_analyze(*this);
-  }
-
-  void accept(PPVisitor& visitor) override {
-    visitor.visit(*this);
-  }
 };
 
 struct FnNode : public StmtNode {
-  Ptr<FnHeaderNode> header;
-  Ptr<BlockNode> body;
+  ArenaPtr<FnHeaderNode> header;
+  ArenaPtr<BlockNode> body;
 
-  FnNode(Ptr<FnHeaderNode>&& header, Ptr<BlockNode>&& body)
-    : Node(NodeId::FnDecl), 
-      StmtNode(NodeId::FnDecl), 
+  FnNode(ArenaPtr<FnHeaderNode>&& header, ArenaPtr<BlockNode>&& body)
+    : StmtNode(NodeId::FnDecl), 
       header(std::move(header)), 
       body(std::move(body)) {}
-
-  void analyze(SemanticVisitor& analyzer) override {
-    analyzer.sema_analyze(*this);
-  }
-
-  void accept(PPVisitor& visitor) override {
-    visitor.visit(*this);
-  }
 };
 
 struct ReturnNode : public StmtNode {
   Identifier fn;
-  Ptr<ExprNode> expr;
+  ArenaPtr<ExprNode> expr;
 
-  ReturnNode(Identifier&& ident, Ptr<ExprNode>&& expr)
-    : Node(NodeId::Return), 
-      StmtNode(NodeId::Return), 
+  ReturnNode(Identifier&& ident, ArenaPtr<ExprNode>&& expr)
+    : StmtNode(NodeId::Return), 
       fn(std::move(ident)), 
       expr(std::move(expr)) {}
-
-  void analyze(SemanticVisitor& analyzer) override {
-    analyzer.sema_analyze(*this);
-  }
-
-  void accept(PPVisitor& visitor) override {
-    visitor.visit(*this);
-  }
 };
 
-struct FnCallNode : public ExprNode, public StmtNode {
+struct FnCallNode : public ExprNode {
   Identifier ident;
-  std::vector<Ptr<ExprNode>> args;
+  std::vector<ArenaPtr<ExprNode>> args;
 
-  FnCallNode(Identifier&& ident, std::vector<Ptr<ExprNode>>&& args)
-    : Node(NodeId::FnCall), 
-      ExprNode(NodeId::FnCall), 
-      StmtNode(NodeId::FnCall), 
+  FnCallNode(Identifier&& ident, std::vector<ArenaPtr<ExprNode>>&& args)
+    : ExprNode(NodeId::FnCall), 
       ident(std::move(ident)), 
       args(std::move(args)) {}
-
-  void analyze(SemanticVisitor& analyzer) override {
-    analyzer.sema_analyze(*this);
-  }
-
-  void accept(PPVisitor& visitor) override {
-    visitor.visit(*this);
-  }
 };
 
 struct ImportNode : public StmtNode {
   Identifier ident;
 
   ImportNode(Identifier&& ident)
-    : Node(NodeId::Import), 
-      StmtNode(NodeId::FnCall), 
+    : StmtNode(NodeId::Import), 
       ident(std::move(ident)) {}
-
-  void analyze(SemanticVisitor& analyzer) override {
-    analyzer.sema_analyze(*this);
-  }
-
-  void accept(PPVisitor& visitor) override {
-    visitor.visit(*this);
-  }
 };
 
 #endif // NODE_HPP_
\ No newline at end of file
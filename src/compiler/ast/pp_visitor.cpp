@@ -21,11 +21,11 @@ void PPVisitor::visit(BinOpNode& bn) {
     print(format("Op: {}\n", bin_op_str(bn.op)));
 
     print_node_header("Left");
-    bn.lhs->accept(*this);
+    dispatch(*bn.lhs);
     decrease_depth();
 
     print_node_header("Right");
-    bn.rhs->accept(*this);
+    dispatch(*bn.rhs);
     decrease_depth();
 }
 
@@ -34,7 +34,7 @@ void PPVisitor::visit(UnaryOpNode& un) {
     print(format("Op: {}\n", un_op_str(un.op)));
 
     print_node_header("Left");
-    un.lhs->accept(*this);
+    dispatch(*un.lhs);
     decrease_depth();
 }
 
@@ -53,7 +53,7 @@ void PPVisitor::visit(VarDeclarationNode& vdn) {
     if (vdn.init != nullptr && vdn.op.has_value()) {
         print_node_header("Initializer");
         print(format("Op: {}\n", assign_op_str(vdn.op.value())));
-        vdn.init->accept(*this);
+        dispatch(*vdn.init);
         decrease_depth();
     }
 }
@@ -93,11 +93,11 @@ void PPVisitor::visit(FnNode& fn) {
     print_node_header("Fn");
 
     print_node_header("Left");
-    fn.header->accept(*this);
+    visit(*fn.header);
     decrease_depth();
 
     print_node_header("Right");
-    fn.body->accept(*this);
+    visit(*fn.body);
     decrease_depth();
 }
 
@@ -105,7 +105,7 @@ void PPVisitor::visit(BlockNode& fb) {
     print_node_header("Block");
     for (auto& child : fb.children) {
         if(child) {
-            child->accept(*this);
+            dispatch(*child);
             decrease_depth();
         }
     }
@@ -117,23 +117,23 @@ void PPVisitor::visit(BreakNode& brk) {
 
 void PPVisitor::visit(LoopNode& ln) {
     print_node_header("Loop");
-    ln.body->accept(*this);
+    visit(*ln.body);
     decrease_depth();
 }
 
 void PPVisitor::visit(IfNode& cfn) {
     print_node_header("If");
     print_node_header("Condition");
-    cfn.condition->accept(*this);
+    dispatch(*cfn.condition);
     decrease_depth();
 
     print_node_header("IfBlock");
-    cfn.if_block->accept(*this);
+    visit(*cfn.if_block);
     decrease_depth();
 
     if(cfn.else_block != nullptr) {
         print_node_header("ElseBlock");
-        cfn.else_block->accept(*this);
+        visit(*cfn.else_block);
         decrease_depth();
     }
 }
@@ -157,7 +157,7 @@ void PPVisitor::visit(FnCallNode& fn) {
             auto& arg = fn.args.at(cur);
 
             int cur_depth = depth;
-            arg->accept(*this);
+            dispatch(*arg);
             int new_depth = depth;
 
             while(cur_depth < new_depth--) {
@@ -178,7 +178,7 @@ void PPVisitor::visit(AssignmentNode& an) {
     print(format("LValue: {}\n", an.lvalue.as_str()));
     print(format("Op: {}\n", assign_op_str(an.op)));
     print_node_header("RValue");
-    an.rvalue->accept(*this);
+    dispatch(*an.rvalue);
     decrease_depth(2);
 }
 
@@ -186,10 +186,10 @@ void PPVisitor::visit(DerefAssignmentNode& dn) {
     print_node_header("Dereference_Assignment");
     print(format("Op: {}\n", assign_op_str(dn.op)));
     print_node_header("LValue");
-    dn.lvalue->accept(*this);
+    dispatch(*dn.lvalue);
     decrease_depth();
     print_node_header("RValue");
-    dn.rvalue->accept(*this);
+    dispatch(*dn.rvalue);
     decrease_depth();
 }
 
@@ -197,7 +197,7 @@ void PPVisitor::visit(ReturnNode& rn) {
     print_node_header("Return");
     print(format("Fn: {}\n", rn.fn.as_str()));
     print_node_header("Expr");
-    rn.expr->accept(*this);
+    dispatch(*rn.expr);
     decrease_depth();
 }
 
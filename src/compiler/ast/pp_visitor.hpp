@@ -4,24 +4,9 @@
 #include <format>
 using std::format;
 
-struct LiteralNode;
-struct BinOpNode;
-struct UnaryOpNode;
-struct VarDeclarationNode;
-struct VarTerminalNode;
-struct AssignmentNode;
-struct DerefAssignmentNode;
-struct FnHeaderNode;
-struct FnNode;
-struct BlockNode;
-struct LoopNode;
-struct IfNode;
-struct BreakNode;
-struct ReturnNode;
-struct FnCallNode;
-struct ImportNode;
+#include "visit.hpp"
 
-struct PPVisitor {
+struct PPVisitor : NodeVisitor<PPVisitor> {
     std::ostream& buffer;
     int depth = 0;
 
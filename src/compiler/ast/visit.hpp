@@ -0,0 +1,53 @@
+#ifndef VISIT_HPP_
+#define VISIT_HPP_
+
+#include <format>
+#include <utility>
+
+#include "common.hpp"
+#include "node.hpp"
+
+/// @brief `visit_node`
+/// Calls `fn` with `node` downcast to its concrete type, which is picked from `node.id`.
+/// Every walk over the AST goes through here instead of virtual calls, so `fn` is usually a generic lambda
+/// or an overload set, and every alternative must return the same type.
+template<typename Fn>
+decltype(auto) visit_node(Node& node, Fn&& fn) {
+    switch(node.id)
+    {
+        case NodeId::Lit:         return fn(static_cast<LiteralNode&>(node));
+        case NodeId::Term:        return fn(static_cast<VarTerminalNode&>(node));
+        case NodeId::Bin:         return fn(static_cast<BinOpNode&>(node));
+        case NodeId::Un:          return fn(static_cast<UnaryOpNode&>(node));
+        case NodeId::FnCall:      return fn(static_cast<FnCallNode&>(node));
+        case NodeId::VarDecl:     return fn(static_cast<VarDeclarationNode&>(node));
+        case NodeId::Assign:      return fn(static_cast<AssignmentNode&>(node));
+        case NodeId::DerefAssign: return fn(static_cast<DerefAssignmentNode&>(node));
+        case NodeId::FnDecl:      return fn(static_cast<FnNode&>(node));
+        case NodeId::FnHeader:    return fn(static_cast<FnHeaderNode&>(node));
+        case NodeId::Block:       return fn(static_cast<BlockNode&>(node));
+        case NodeId::Break:       return fn(static_cast<BreakNode&>(node));
+        case NodeId::Loop:        return fn(static_cast<LoopNode&>(node));
+        case NodeId::If:          return fn(static_cast<IfNode&>(node));
+        case NodeId::Return:      return fn(static_cast<ReturnNode&>(node));
+        case NodeId::Import:      return fn(static_cast<ImportNode&>(node));
+        default:
+            break;
+    }
+    ASSERT(false, std::format("cannot visit a node of kind '{}'", node.id_str()));
+    std::unreachable();
+}
+
+/// @brief `NodeVisitor`
+/// Compile-time dispatched visitor, `Derived` provides a `visit` overload for every concrete node.
+/// `dispatch` is only needed when the static type of a child is a base, e.g `ExprNode`.
+template<typename Derived>
+struct NodeVisitor {
+    decltype(auto) dispatch(Node& node) {
+        return visit_node(node, [this](auto& concrete) -> decltype(auto) {
+            return static_cast<Derived&>(*this).visit(concrete);
+        });
+    }
+};
+
+#endif // VISIT_HPP_
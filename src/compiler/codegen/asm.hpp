@@ -12,12 +12,23 @@ enum class Register: int {
     Rdx,
     Rcx,
     R8,
-    R9
+    R9,
+    R10,
+    R11,
+    R12,
+    R13,
+    R14,
+    R15,
+    // Only addressed through, never allocated.
+    Rsp,
+    Rbp
 };
 
 enum class AllocRegion: int {
     Stack, 
-    Heap
+    Heap,
+    // Kept in a register for its whole lifetime, see `regalloc.hpp`.
+    Register
 };
 
 struct AsmVar {
@@ -29,8 +40,19 @@ struct AsmVar {
     AllocRegion where;
     // Is it a temporary.
     bool temp;
+    // Where it is kept when `where` is a register.
+    Register reg = Register::Rax;
+    // Decided by the allocator before the function is emitted, see `regalloc.hpp`.
+    bool placed = false;
 
     AsmVar() : offset{0}, memsize{0}, where{AllocRegion::Stack} {}
+    AsmVar(Register reg, size_t memsize) 
+        : offset{0}, 
+          memsize{memsize}, 
+          where{AllocRegion::Register}, 
+          temp{false}, 
+          reg{reg},
+          placed{true} {}
     AsmVar(size_t offset, size_t&& memsize, AllocRegion&& where, bool&& temp) 
         : offset{std::move(offset)}, 
           memsize{std::move(memsize)},
@@ -39,12 +61,13 @@ struct AsmVar {
 }; 
 
 struct AsmStackFrame {
-    using AsmIdent = std::string;
+    // Variables and temporaries are keyed by their operand.
+    using AsmIdent = Operand;
     using _Table = std::unordered_map<AsmIdent, AsmVar>;
 
     // Debug data.
     size_t seq_num;
-    String name;
+    SymId name;
 
     // Context.
     _Table frame;
@@ -53,17 +76,22 @@ struct AsmStackFrame {
     size_t aligned_size = 0;
     size_t extra_arguments = 0;
 
-    AsmStackFrame(size_t seq_num, String name) 
+    AsmStackFrame(size_t seq_num, SymId name) 
         : seq_num{std::move(seq_num)},
-          name{std::move(name)}, 
+          name{name}, 
           frame() {}
 
     void update_offest(size_t chunk) {
         offset += chunk;
     }
 
-    void alloc(String&& name, size_t&& size, bool temp = false) {
-        ASSERT(frame.count(name) == 0, format("[codegen::err] cannot 'realloc', used on '{}'", name));
+    void alloc(const AsmIdent& name, size_t&& size, bool temp = false) {
+        // Values the allocator placed already have their register or shared slot.
+        auto placed = frame.find(name);
+        if (placed != frame.end() && placed->second.placed) {
+            return;
+        }
+        ASSERT(placed == frame.end(), format("[codegen::err] cannot 'realloc', used on '{}'", name.as_str()));
 
         update_offest(size);
         frame[name] = AsmVar { offset, std::move(size), AllocRegion::Stack, std::move(temp) };
@@ -72,32 +100,52 @@ struct AsmStackFrame {
         align_size();
     }
 
-    int var_offset(const String& name) const {
+    // Keeps `name` in `reg` for the whole function.
+    void place(const AsmIdent& name, Register reg, size_t size) {
+        frame[name] = AsmVar { reg, size };
+    }
+
+    // Keeps `name` in the slot at `offset`, which other values may share.
+    void place_in_slot(const AsmIdent& name, size_t offset, size_t size) {
+        AsmVar var { offset, std::move(size), AllocRegion::Stack, true };
+        var.placed = true;
+        frame[name] = var;
+    }
+
+    // A slot that belongs to no variable, e.g for a saved register. Returns its offset.
+    size_t reserve(size_t size) {
+        update_offest(size);
+        total_size += size;
+        align_size();
+        return offset;
+    }
+
+    Option<Register> var_register(const AsmIdent& name) const {
+        auto it = frame.find(name);
+        if (it == frame.end() || it->second.where != AllocRegion::Register) {
+            return std::nullopt;
+        }
+        return it->second.reg;
+    }
+
+    int var_offset(const AsmIdent& name) const {
         auto it = frame.find(name);
         ASSERT(
             it != frame.end(),
-            format("variable not found in stack frame: {}", name)
+            format("variable not found in stack frame: {}", name.as_str())
         );
         return it->second.offset;
     }
 
-    size_t var_memsize(const String& name) const {
+    size_t var_memsize(const AsmIdent& name) const {
         auto it = frame.find(name);
         ASSERT(
             it != frame.end(),
-            format("variable not found in stack frame: {}", name)
+            format("variable not found in stack frame: {}", name.as_str())
         );
         return it->second.memsize;
     }
 
-    void free(String name) {
-        auto it = frame.find(name);
-        ASSERT(it == frame.end(), format("cannot free unknown variable {}", name));
-        AsmVar& var = it->second;
-        ASSERT(var.temp, format("{} is not a temporary.", name));
-        frame.erase(it);
-    }
-
     void align_size() {
         if(total_size % 16 == 1) {
             aligned_size  = (total_size / 16 + 1) * 16;
@@ -121,9 +169,9 @@ struct AsmStack {
     _Stack stack;
     size_t cur_seq_num;
 
-    AsmStack() : stack() {}
+    AsmStack() : stack(), cur_seq_num{0} {}
 
-    void enter_func(String name) {
+    void enter_func(SymId name) {
         // generate a new frame.
         stack.emplace(AsmStackFrame(cur_seq_num++, name));
     }
@@ -142,27 +190,27 @@ struct AsmStack {
         stack.pop();
     }
 
-    void allocate_temp(String name, size_t size) {
+    void allocate_temp(const Operand& name, size_t size) {
         _core_assert("no active functions.");
-        stack.top().alloc(std::move(name), std::move(size), true);
+        stack.top().alloc(name, std::move(size), true);
     }
 
-    void allocate(String name, size_t size) {
+    void allocate(const Operand& name, size_t size) {
         _core_assert("no active functions.");
-        stack.top().alloc(std::move(name), std::move(size));
+        stack.top().alloc(name, std::move(size));
     }
 
-    void free(String name) {
+    size_t offset(const Operand& name) const {
         _core_assert("no active functions.");
-        stack.top().free(std::move(name));
+        return stack.top().var_offset(name);
     }
 
-    size_t offset(const String& name) const {
+    Option<Register> register_of(const Operand& name) const {
         _core_assert("no active functions.");
-        return stack.top().var_offset(name);
+        return stack.top().var_register(name);
     }
 
-    size_t memsize(const String& name) const {
+    size_t memsize(const Operand& name) const {
         _core_assert("no active functions.");
         return stack.top().var_memsize(name);
     }
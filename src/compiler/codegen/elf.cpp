@@ -0,0 +1,410 @@
+#include <elf.h>
+#include <cstring>
+#include <format>
+#include <unordered_map>
+
+#include "elf.hpp"
+
+namespace {
+
+/// @brief `Image`
+/// The bytes of a file being laid out.
+class Image {
+public:
+    template<typename T>
+    size_t put(const T& value) {
+        size_t at = bytes.size();
+        bytes.resize(at + sizeof(T));
+        std::memcpy(bytes.data() + at, &value, sizeof(T));
+        return at;
+    }
+
+    size_t put(const std::vector<uint8_t>& data) {
+        size_t at = bytes.size();
+        bytes.insert(bytes.end(), data.begin(), data.end());
+        return at;
+    }
+
+    void align(size_t alignment) {
+        bytes.resize((bytes.size() + alignment - 1) / alignment * alignment, 0);
+    }
+
+    template<typename T>
+    T& at(size_t offset) {
+        return *reinterpret_cast<T*>(bytes.data() + offset);
+    }
+
+    std::vector<uint8_t> bytes;
+};
+
+/// @brief `StringTable`
+/// The contents of '.strtab' or '.shstrtab', starting with the empty name.
+struct StringTable {
+    std::vector<uint8_t> bytes{ 0 };
+
+    uint32_t add(std::string_view name) {
+        uint32_t at = static_cast<uint32_t>(bytes.size());
+        bytes.insert(bytes.end(), name.begin(), name.end());
+        bytes.push_back(0);
+        return at;
+    }
+};
+
+enum Section : uint16_t { Null, Text, Data, Symtab, Strtab, RelaText, Shstrtab, Count };
+
+// `<elf.h>` structs have no default member initializers, these zero what they do not set.
+Elf64_Sym symbol_entry(uint32_t name, unsigned char info, uint16_t section, uint64_t value) {
+    Elf64_Sym sym{};
+    sym.st_name = name;
+    sym.st_info = info;
+    sym.st_shndx = section;
+    sym.st_value = value;
+    return sym;
+}
+
+uint16_t section_of(ObjectCode::Section section) {
+    switch (section) {
+        case ObjectCode::Section::Text: return Section::Text;
+        case ObjectCode::Section::Data: return Section::Data;
+        default:
+            return SHN_UNDEF;
+    }
+}
+
+Elf64_Shdr section_header(uint32_t name, uint32_t type, uint64_t flags, uint64_t alignment) {
+    Elf64_Shdr header{};
+    header.sh_name = name;
+    header.sh_type = type;
+    header.sh_flags = flags;
+    header.sh_addralign = alignment;
+    return header;
+}
+
+// Where executables are loaded, as 'ld' does by default.
+CONST uint64_t BASE_ADDRESS = 0x400000;
+CONST uint64_t PAGE_SIZE = 0x1000;
+
+uint64_t align_up(uint64_t value, uint64_t alignment) {
+    return alignment > 1 ? (value + alignment - 1) / alignment * alignment : value;
+}
+
+/// @brief `Input`
+/// A relocatable object being linked, and where its sections were placed.
+struct Input {
+    const std::vector<uint8_t>& bytes;
+    std::vector<Elf64_Shdr> sections;
+    std::vector<Elf64_Sym> symbols;
+    // Offset of the names of `symbols`.
+    uint64_t names = 0;
+    // Virtual address of every section, 0 for the ones not loaded.
+    std::vector<uint64_t> addresses;
+
+    template<typename T>
+    T read(uint64_t offset) const {
+        ASSERT(offset + sizeof(T) <= bytes.size(), "[linker::err] truncated object file.");
+        T value;
+        std::memcpy(&value, bytes.data() + offset, sizeof(T));
+        return value;
+    }
+
+    // Address of a symbol defined in this object.
+    uint64_t address_of(const Elf64_Sym& sym) const {
+        if (sym.st_shndx == SHN_ABS) {
+            return sym.st_value;
+        }
+        ASSERT(sym.st_shndx < sections.size() && addresses[sym.st_shndx] != 0,
+               "[linker::err] symbol in a section that is not loaded.");
+        return addresses[sym.st_shndx] + sym.st_value;
+    }
+
+    std::string_view name(uint64_t offset) const {
+        ASSERT(offset < bytes.size(), "[linker::err] symbol name out of bounds.");
+        return reinterpret_cast<const char*>(bytes.data() + offset);
+    }
+
+    explicit Input(const std::vector<uint8_t>& object) : bytes(object) {
+        auto header = read<Elf64_Ehdr>(0);
+        ASSERT(
+            std::memcmp(header.e_ident, ELFMAG, SELFMAG) == 0 && header.e_ident[EI_CLASS] == ELFCLASS64
+                && header.e_type == ET_REL && header.e_machine == EM_X86_64,
+            "[linker::err] only x86-64 ELF64 relocatable objects can be linked."
+        );
+
+        for (uint16_t i = 0; i < header.e_shnum; ++i) {
+            sections.push_back(read<Elf64_Shdr>(header.e_shoff + i * sizeof(Elf64_Shdr)));
+        }
+        addresses.assign(sections.size(), 0);
+
+        for (const auto& section : sections) {
+            if (section.sh_type != SHT_SYMTAB) continue;
+            for (uint64_t at = 0; at < section.sh_size; at += sizeof(Elf64_Sym)) {
+                symbols.push_back(read<Elf64_Sym>(section.sh_offset + at));
+            }
+            names = sections[section.sh_link].sh_offset;
+        }
+    }
+};
+
+} // namespace
+
+std::vector<uint8_t> elf::relocatable(const ObjectCode& object) {
+    StringTable strtab;
+    std::vector<Elf64_Sym> symtab(1, Elf64_Sym{});
+    std::vector<size_t> symbol_of(object.symbols.size());
+
+    for (uint16_t section : { Section::Text, Section::Data }) {
+        symtab.push_back(symbol_entry(0, ELF64_ST_INFO(STB_LOCAL, STT_SECTION), section, 0));
+    }
+
+    // Local symbols must come before the global ones.
+    uint32_t first_global = 0;
+    for (bool global : { false, true }) {
+        if (global) first_global = static_cast<uint32_t>(symtab.size());
+        for (size_t i = 0; i < object.symbols.size(); ++i) {
+            const auto& sym = object.symbols[i];
+            if (sym.global != global) continue;
+
+            symbol_of[i] = symtab.size();
+            symtab.push_back(symbol_entry(
+                strtab.add(sym.name),
+                ELF64_ST_INFO(global ? STB_GLOBAL : STB_LOCAL, STT_NOTYPE),
+                section_of(sym.section),
+                sym.offset
+            ));
+        }
+    }
+
+    std::vector<Elf64_Rela> relocations;
+    for (const auto& reloc : object.relocations) {
+        relocations.push_back(Elf64_Rela{
+            .r_offset = reloc.offset,
+            .r_info = ELF64_R_INFO(
+                symbol_of[reloc.symbol], 
+                reloc.kind == ObjectCode::Relocation::Kind::Absolute64 ? R_X86_64_64 : R_X86_64_PC32
+            ),
+            .r_addend = reloc.addend,
+        });
+    }
+
+    StringTable shstrtab;
+    Elf64_Shdr headers[Section::Count] = {};
+    headers[Section::Text] = section_header(shstrtab.add(".text"), SHT_PROGBITS, SHF_ALLOC | SHF_EXECINSTR, 16);
+    headers[Section::Data] = section_header(shstrtab.add(".data"), SHT_PROGBITS, SHF_ALLOC | SHF_WRITE, 4);
+    headers[Section::Symtab] = section_header(shstrtab.add(".symtab"), SHT_SYMTAB, 0, 8);
+    headers[Section::Symtab].sh_link = Section::Strtab;
+    headers[Section::Symtab].sh_info = first_global;
+    headers[Section::Symtab].sh_entsize = sizeof(Elf64_Sym);
+    headers[Section::Strtab] = section_header(shstrtab.add(".strtab"), SHT_STRTAB, 0, 1);
+    headers[Section::RelaText] = section_header(shstrtab.add(".rela.text"), SHT_RELA, SHF_INFO_LINK, 8);
+    headers[Section::RelaText].sh_link = Section::Symtab;
+    headers[Section::RelaText].sh_info = Section::Text;
+    headers[Section::RelaText].sh_entsize = sizeof(Elf64_Rela);
+    headers[Section::Shstrtab] = section_header(shstrtab.add(".shstrtab"), SHT_STRTAB, 0, 1);
+
+    Image image;
+    size_t ehdr = image.put(Elf64_Ehdr{});
+
+    auto place = [&](Section section, const auto& put) {
+        Elf64_Shdr& header = headers[section];
+        image.align(header.sh_addralign);
+        header.sh_offset = image.bytes.size();
+        put();
+        header.sh_size = image.bytes.size() - header.sh_offset;
+    };
+    place(Section::Text, [&] { image.put(object.text); });
+    place(Section::Data, [&] { image.put(object.data); });
+    place(Section::Symtab, [&] { for (const auto& sym : symtab) image.put(sym); });
+    place(Section::Strtab, [&] { image.put(strtab.bytes); });
+    place(Section::RelaText, [&] { for (const auto& rela : relocations) image.put(rela); });
+    place(Section::Shstrtab, [&] { image.put(shstrtab.bytes); });
+
+    image.align(8);
+    size_t shoff = image.bytes.size();
+    for (const auto& header : headers) {
+        image.put(header);
+    }
+
+    Elf64_Ehdr& header = image.at<Elf64_Ehdr>(ehdr);
+    std::memcpy(header.e_ident, ELFMAG, SELFMAG);
+    header.e_ident[EI_CLASS] = ELFCLASS64;
+    header.e_ident[EI_DATA] = ELFDATA2LSB;
+    header.e_ident[EI_VERSION] = EV_CURRENT;
+    header.e_ident[EI_OSABI] = ELFOSABI_SYSV;
+    header.e_type = ET_REL;
+    header.e_machine = EM_X86_64;
+    header.e_version = EV_CURRENT;
+    header.e_shoff = shoff;
+    header.e_ehsize = sizeof(Elf64_Ehdr);
+    header.e_shentsize = sizeof(Elf64_Shdr);
+    header.e_shnum = Section::Count;
+    header.e_shstrndx = Section::Shstrtab;
+    return std::move(image.bytes);
+}
+
+std::vector<uint8_t> elf::link(const std::vector<std::vector<uint8_t>>& objects) {
+    std::vector<Input> inputs;
+    for (const auto& object : objects) {
+        inputs.emplace_back(object);
+    }
+
+    auto loaded = [](const Elf64_Shdr& section) {
+        return (section.sh_flags & SHF_ALLOC) && section.sh_size > 0;
+    };
+
+    // Code and read-only data share the first segment with the headers, as 'ld' lays them out.
+    uint64_t headers = sizeof(Elf64_Ehdr) + 2 * sizeof(Elf64_Phdr);
+    uint64_t offset = headers;
+    for (auto& input : inputs) {
+        for (size_t i = 0; i < input.sections.size(); ++i) {
+            const Elf64_Shdr& section = input.sections[i];
+            if (!loaded(section) || (section.sh_flags & SHF_WRITE)) continue;
+
+            offset = align_up(offset, section.sh_addralign);
+            input.addresses[i] = BASE_ADDRESS + offset;
+            offset += section.sh_size;
+        }
+    }
+    uint64_t text_size = offset;
+
+    // Writable sections start on the next page, '.bss' and the like only take memory.
+    uint64_t data_offset = align_up(offset, PAGE_SIZE);
+    uint64_t data_file = 0;
+    offset = data_offset;
+    for (bool nobits : { false, true }) {
+        for (auto& input : inputs) {
+            for (size_t i = 0; i < input.sections.size(); ++i) {
+                const Elf64_Shdr& section = input.sections[i];
+                if (!loaded(section) || !(section.sh_flags & SHF_WRITE)) continue;
+                if ((section.sh_type == SHT_NOBITS) != nobits) continue;
+
+                offset = align_up(offset, section.sh_addralign);
+                input.addresses[i] = BASE_ADDRESS + offset;
+                offset += section.sh_size;
+            }
+        }
+        if (!nobits) {
+            data_file = offset - data_offset;
+        }
+    }
+    uint64_t data_memory = offset - data_offset;
+
+    // Global symbols of every object, by name.
+    std::unordered_map<std::string_view, uint64_t> globals;
+    for (const auto& input : inputs) {
+        for (const auto& sym : input.symbols) {
+            uint8_t bind = ELF64_ST_BIND(sym.st_info);
+            if ((bind != STB_GLOBAL && bind != STB_WEAK) || sym.st_shndx == SHN_UNDEF) continue;
+
+            std::string_view name = input.name(input.names + sym.st_name);
+            bool fresh = globals.emplace(name, input.address_of(sym)).second;
+            ASSERT(fresh, std::format("[linker::err] symbol '{}' is defined twice.", name));
+        }
+    }
+
+    auto resolve = [&](const Input& input, uint32_t index) -> uint64_t {
+        ASSERT(index < input.symbols.size(), "[linker::err] relocation against an unknown symbol.");
+        const Elf64_Sym& sym = input.symbols[index];
+        if (sym.st_shndx == SHN_UNDEF) {
+            std::string_view name = input.name(input.names + sym.st_name);
+            auto it = globals.find(name);
+            ASSERT(it != globals.end(), std::format("[linker::err] undefined symbol '{}'.", name));
+            return it->second;
+        }
+        return input.address_of(sym);
+    };
+
+    std::vector<uint8_t> image(data_offset + data_file, 0);
+    for (const auto& input : inputs) {
+        for (size_t i = 0; i < input.sections.size(); ++i) {
+            const Elf64_Shdr& section = input.sections[i];
+            if (input.addresses[i] == 0 || section.sh_type == SHT_NOBITS) continue;
+
+            ASSERT(section.sh_offset + section.sh_size <= input.bytes.size(), "[linker::err] truncated object file.");
+            std::memcpy(
+                image.data() + (input.addresses[i] - BASE_ADDRESS), 
+                input.bytes.data() + section.sh_offset, 
+                section.sh_size
+            );
+        }
+    }
+
+    for (const auto& input : inputs) {
+        for (const auto& section : input.sections) {
+            ASSERT(section.sh_type != SHT_REL, "[linker::err] relocations without addends are not supported on x86-64.");
+            if (section.sh_type != SHT_RELA || input.addresses[section.sh_info] == 0) continue;
+
+            const Elf64_Shdr& target = input.sections[section.sh_info];
+            ASSERT(target.sh_type != SHT_NOBITS, "[linker::err] relocation into a section without contents.");
+
+            for (uint64_t at = 0; at < section.sh_size; at += sizeof(Elf64_Rela)) {
+                auto rela = input.read<Elf64_Rela>(section.sh_offset + at);
+                ASSERT(rela.r_offset < target.sh_size, "[linker::err] relocation outside of its section.");
+
+                uint64_t place = input.addresses[section.sh_info] + rela.r_offset;
+                int64_t value = static_cast<int64_t>(resolve(input, ELF64_R_SYM(rela.r_info))) + rela.r_addend;
+                uint8_t* patch = image.data() + (place - BASE_ADDRESS);
+
+                auto write = [&](auto field) { std::memcpy(patch, &field, sizeof(field)); };
+                switch (ELF64_R_TYPE(rela.r_info)) {
+                    case R_X86_64_64:
+                        write(static_cast<uint64_t>(value));
+                        break;
+                    case R_X86_64_PC32:
+                    case R_X86_64_PLT32:
+                        value -= static_cast<int64_t>(place);
+                        ASSERT(value == static_cast<int32_t>(value), "[linker::err] relative relocation out of range.");
+                        write(static_cast<int32_t>(value));
+                        break;
+                    case R_X86_64_32:
+                        ASSERT(value == static_cast<uint32_t>(value), "[linker::err] absolute relocation out of range.");
+                        write(static_cast<uint32_t>(value));
+                        break;
+                    case R_X86_64_32S:
+                        ASSERT(value == static_cast<int32_t>(value), "[linker::err] absolute relocation out of range.");
+                        write(static_cast<int32_t>(value));
+                        break;
+                    default:
+                        ASSERT(false, std::format("[linker::err] unsupported relocation type {}.", ELF64_R_TYPE(rela.r_info)));
+                }
+            }
+        }
+    }
+
+    auto entry = globals.find("_start");
+    ASSERT(entry != globals.end(), "[linker::err] no '_start' to enter the executable at.");
+
+    Elf64_Ehdr header{};
+    std::memcpy(header.e_ident, ELFMAG, SELFMAG);
+    header.e_ident[EI_CLASS] = ELFCLASS64;
+    header.e_ident[EI_DATA] = ELFDATA2LSB;
+    header.e_ident[EI_VERSION] = EV_CURRENT;
+    header.e_ident[EI_OSABI] = ELFOSABI_SYSV;
+    header.e_type = ET_EXEC;
+    header.e_machine = EM_X86_64;
+    header.e_version = EV_CURRENT;
+    header.e_entry = entry->second;
+    header.e_phoff = sizeof(Elf64_Ehdr);
+    header.e_ehsize = sizeof(Elf64_Ehdr);
+    header.e_phentsize = sizeof(Elf64_Phdr);
+    header.e_phnum = data_memory > 0 ? 2 : 1;
+    std::memcpy(image.data(), &header, sizeof(header));
+
+    Elf64_Phdr segments[2] = {
+        Elf64_Phdr{
+            .p_type = PT_LOAD, .p_flags = PF_R | PF_X, .p_offset = 0, .p_vaddr = BASE_ADDRESS, .p_paddr = BASE_ADDRESS,
+            .p_filesz = text_size, .p_memsz = text_size, .p_align = PAGE_SIZE,
+        },
+        Elf64_Phdr{
+            .p_type = PT_LOAD, .p_flags = PF_R | PF_W, .p_offset = data_offset, 
+            .p_vaddr = BASE_ADDRESS + data_offset, .p_paddr = BASE_ADDRESS + data_offset,
+            .p_filesz = data_file, .p_memsz = data_memory, .p_align = PAGE_SIZE,
+        },
+    };
+    std::memcpy(image.data() + sizeof(Elf64_Ehdr), segments, sizeof(segments));
+
+    // Nothing is written past the code when there is no data.
+    if (data_memory == 0) {
+        image.resize(text_size);
+    }
+    return image;
+}
@@ -0,0 +1,22 @@
+#ifndef ELF_HPP_
+#define ELF_HPP_
+
+#include "encoder.hpp"
+
+/// @brief `elf`
+/// Writes `ObjectCode` as ELF64 files for x86-64 Linux, and links them.
+namespace elf {
+
+// A relocatable object with '.text', '.data', a symbol table and the relocations of '.text',
+// linkable against `std.asm` just as what 'nasm -f elf64' writes for the same program.
+std::vector<uint8_t> relocatable(const ObjectCode& object);
+
+// A static executable entering at '_start', linked from relocatable objects as 'ld' would for
+// programs without libc. Executable and read-only sections are loaded together, writable ones
+// after them, in the order of `objects`. Global symbols are resolved across objects, and the
+// absolute and PC-relative relocations assemblers emit for x86-64 are applied.
+std::vector<uint8_t> link(const std::vector<std::vector<uint8_t>>& objects);
+
+} // namespace elf
+
+#endif // ELF_HPP_
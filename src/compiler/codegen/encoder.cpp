@@ -0,0 +1,708 @@
+#include <charconv>
+#include <format>
+#include <limits>
+
+#include "alias.hpp"
+#include "encoder.hpp"
+
+namespace {
+
+using Kind = AsmArg::Kind;
+using RelocKind = ObjectCode::Relocation::Kind;
+
+// The number of every `Register` in ModR/M, REX extends it to four bits.
+CONST uint8_t NUMBERS[] = { 0, 3, 7, 6, 2, 1, 8, 9, 10, 11, 12, 13, 14, 15, 4, 5 };
+
+// By number, then 8, 4, 2 and 1 bytes wide.
+CONST char* REGISTER_NAMES[16][4] = {
+    { "rax", "eax", "ax", "al" },      { "rcx", "ecx", "cx", "cl" },
+    { "rdx", "edx", "dx", "dl" },      { "rbx", "ebx", "bx", "bl" },
+    { "rsp", "esp", "sp", "spl" },     { "rbp", "ebp", "bp", "bpl" },
+    { "rsi", "esi", "si", "sil" },     { "rdi", "edi", "di", "dil" },
+    { "r8", "r8d", "r8w", "r8b" },     { "r9", "r9d", "r9w", "r9b" },
+    { "r10", "r10d", "r10w", "r10b" }, { "r11", "r11d", "r11w", "r11b" },
+    { "r12", "r12d", "r12w", "r12b" }, { "r13", "r13d", "r13w", "r13b" },
+    { "r14", "r14d", "r14w", "r14b" }, { "r15", "r15d", "r15w", "r15b" },
+};
+
+CONST uint8_t WIDTHS[] = { 8, 4, 2, 1 };
+
+// In the order of `Mnemonic`.
+CONST char* MNEMONIC_NAMES[] = {
+    "mov", "movzx", "lea",
+    "add", "or", "and", "sub", "xor", "cmp", "test",
+    "imul", "idiv", "div", "neg", "not", "inc", "dec",
+    "shl", "shr", "sar",
+    "sete", "setne", "setl", "setle", "setg", "setge",
+    "jmp", "je", "jne", "jl", "jle", "jg", "jge", "js", "jns",
+    "call", "push", "pop", "ret", "syscall", "cqo",
+};
+
+CONST std::pair<std::string_view, uint8_t> SIZE_KEYWORDS[] = {
+    { "byte ", 1 }, { "word ", 2 }, { "dword ", 4 }, { "qword ", 8 },
+};
+
+uint8_t number(Register reg) {
+    return NUMBERS[static_cast<int>(reg)];
+}
+
+// Codegen wrote something the encoder does not know, the message is only built when it happens.
+[[noreturn]] void reject(std::string_view what, std::string_view text) {
+    ASSERT(false, std::format("[encoder::err] {} '{}'", what, text));
+    std::abort();
+}
+
+std::string_view register_name(Register reg, uint8_t size) {
+    for (size_t width = 0; width < std::size(WIDTHS); ++width) {
+        if (WIDTHS[width] == size) return REGISTER_NAMES[number(reg)][width];
+    }
+    reject("invalid register width", REGISTER_NAMES[number(reg)][0]);
+}
+
+const std::unordered_map<std::string_view, AsmArg>& registers_by_name() {
+    static const std::unordered_map<std::string_view, AsmArg> names = [] {
+        std::unordered_map<std::string_view, AsmArg> found;
+        for (size_t reg = 0; reg < std::size(NUMBERS); ++reg) {
+            for (uint8_t size : WIDTHS) {
+                auto arg = AsmArg::gpr(static_cast<Register>(reg), size);
+                found.emplace(register_name(arg.reg, size), arg);
+            }
+        }
+        return found;
+    }();
+    return names;
+}
+
+const std::unordered_map<std::string_view, Mnemonic>& mnemonics_by_name() {
+    static const std::unordered_map<std::string_view, Mnemonic> names = [] {
+        std::unordered_map<std::string_view, Mnemonic> found{ { "jz", Mnemonic::Je }, { "jnz", Mnemonic::Jne } };
+        for (size_t op = 0; op < std::size(MNEMONIC_NAMES); ++op) {
+            found.emplace(MNEMONIC_NAMES[op], static_cast<Mnemonic>(op));
+        }
+        return found;
+    }();
+    return names;
+}
+
+// The condition code of 'jcc' and 'setcc'.
+uint8_t condition(Mnemonic op) {
+    switch (op) {
+        case Mnemonic::Js:    return 0x8;
+        case Mnemonic::Jns:   return 0x9;
+        case Mnemonic::Je:
+        case Mnemonic::Sete:  return 0x4;
+        case Mnemonic::Jne:
+        case Mnemonic::Setne: return 0x5;
+        case Mnemonic::Jl:
+        case Mnemonic::Setl:  return 0xC;
+        case Mnemonic::Jge:
+        case Mnemonic::Setge: return 0xD;
+        case Mnemonic::Jle:
+        case Mnemonic::Setle: return 0xE;
+        case Mnemonic::Jg:
+        case Mnemonic::Setg:  return 0xF;
+        default:
+            reject("no condition code for", MNEMONIC_NAMES[static_cast<size_t>(op)]);
+    }
+}
+
+// The 'reg' field selecting the operation of a group opcode, e.g 0x81 for arithmetic or 0xF7 for 'neg'.
+uint8_t extension(Mnemonic op) {
+    switch (op) {
+        case Mnemonic::Add:  return 0;
+        case Mnemonic::Or:   return 1;
+        case Mnemonic::And:  return 4;
+        case Mnemonic::Sub:  return 5;
+        case Mnemonic::Xor:  return 6;
+        case Mnemonic::Cmp:  return 7;
+        case Mnemonic::Inc:  return 0;
+        case Mnemonic::Dec:  return 1;
+        case Mnemonic::Not:  return 2;
+        case Mnemonic::Neg:  return 3;
+        case Mnemonic::Imul: return 5;
+        case Mnemonic::Div:  return 6;
+        case Mnemonic::Idiv: return 7;
+        case Mnemonic::Shl:  return 4;
+        case Mnemonic::Shr:  return 5;
+        case Mnemonic::Sar:  return 7;
+        default:
+            reject("no opcode extension for", MNEMONIC_NAMES[static_cast<size_t>(op)]);
+    }
+}
+
+// Byte registers that only exist with a REX prefix, e.g 'sil', without it they would be 'dh' and the like.
+bool needs_rex(const AsmArg& arg) {
+    return arg.is(Kind::Reg) && arg.size == 1 && number(arg.reg) >= 4 && number(arg.reg) < 8;
+}
+
+bool reg_or_mem(const AsmArg& arg) {
+    return arg.is(Kind::Reg) || arg.is(Kind::Mem);
+}
+
+bool fits_i8(int64_t value) {
+    return value >= std::numeric_limits<int8_t>::min() && value <= std::numeric_limits<int8_t>::max();
+}
+
+bool fits_i32(int64_t value) {
+    return value >= std::numeric_limits<int32_t>::min() && value <= std::numeric_limits<int32_t>::max();
+}
+
+std::string_view trim(std::string_view text) {
+    size_t first = text.find_first_not_of(" \t\r\n");
+    if (first == std::string_view::npos) return {};
+    size_t last = text.find_last_not_of(" \t\r\n");
+    return text.substr(first, last - first + 1);
+}
+
+// Splits off the first word, e.g 'mov' of 'mov rax, 1'.
+std::pair<std::string_view, std::string_view> split_word(std::string_view text) {
+    size_t space = text.find_first_of(" \t");
+    if (space == std::string_view::npos) return { text, {} };
+    return { text.substr(0, space), trim(text.substr(space)) };
+}
+
+std::string_view strip_comment(std::string_view text) {
+    bool quoted = false;
+    for (size_t i = 0; i < text.size(); ++i) {
+        if (text[i] == '\'') {
+            quoted = !quoted;
+        } else if (text[i] == ';' && !quoted) {
+            return text.substr(0, i);
+        }
+    }
+    return text;
+}
+
+Option<int64_t> parse_number(std::string_view text) {
+    int64_t value = 0;
+    auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), value);
+    if (error != std::errc{} || end != text.data() + text.size()) {
+        return std::nullopt;
+    }
+    return value;
+}
+
+std::string arg_as_str(const AsmArg& arg) {
+    auto added = [](int64_t value) {
+        if (value == 0) return std::string{};
+        return std::format(" {} {}", value < 0 ? '-' : '+', value < 0 ? -value : value);
+    };
+
+    switch (arg.kind) {
+        case Kind::Reg:
+            return std::string(register_name(arg.reg, arg.size));
+        case Kind::Mem:
+        {
+            std::string_view size;
+            for (auto [keyword, bytes] : SIZE_KEYWORDS) {
+                if (bytes == arg.size) size = keyword;
+            }
+            std::string base = arg.symbol.empty() ? std::string(register_name(arg.reg, 8)) : arg.symbol;
+            return std::format("{}[{}{}]", size, base, added(arg.imm));
+        }
+        case Kind::Imm:
+            return std::to_string(arg.imm);
+        case Kind::Label:
+            return arg.symbol + added(arg.imm);
+        default:
+            return {};
+    }
+}
+
+} // namespace
+
+String AsmInst::as_str() const {
+    std::string text = MNEMONIC_NAMES[static_cast<size_t>(op)];
+    if (!lhs.is(Kind::None)) {
+        text += ' ';
+        text += arg_as_str(lhs);
+    }
+    if (!rhs.is(Kind::None)) {
+        text += ", ";
+        text += arg_as_str(rhs);
+    }
+    return text;
+}
+
+void Encoder::global(std::string_view name) {
+    object.symbols[symbol(name)].global = true;
+}
+
+void Encoder::label(std::string_view name) {
+    if (name.front() != '.') {
+        scope = name;
+        ObjectCode::Symbol& sym = object.symbols[symbol(name)];
+        sym.section = ObjectCode::Section::Text;
+        sym.offset = object.text.size();
+    }
+    if (!labels.emplace(qualify(name), object.text.size()).second) reject("label defined twice", name);
+}
+
+void Encoder::encode(const AsmInst& inst) {
+    size_t first = fixups.size();
+    if (!instruction(inst)) reject("cannot encode", inst.as_str());
+
+    for (size_t i = first; i < fixups.size(); ++i) {
+        fixups[i].end = object.text.size();
+    }
+}
+
+void Encoder::append(Encoder&& other) {
+    size_t base = object.text.size();
+    object.text.insert(object.text.end(), other.object.text.begin(), other.object.text.end());
+
+    for (const auto& [name, offset] : other.labels) {
+        if (!labels.emplace(name, base + offset).second) reject("label defined twice", name);
+    }
+    for (auto& fix : other.fixups) {
+        fix.offset += base;
+        fix.end += base;
+        fixups.push_back(std::move(fix));
+    }
+    for (const auto& sym : other.object.symbols) {
+        ObjectCode::Symbol& into = object.symbols[symbol(sym.name)];
+        if (sym.section == ObjectCode::Section::Text) {
+            into.section = sym.section;
+            into.offset = base + sym.offset;
+        }
+        into.global |= sym.global;
+    }
+    if (!other.scope.empty()) {
+        scope = std::move(other.scope);
+    }
+}
+
+ObjectCode Encoder::finish() {
+    for (const auto& fix : fixups) {
+        bool relative = fix.kind == RelocKind::Relative32;
+        if (auto it = labels.find(fix.label); relative && it != labels.end()) {
+            int64_t rel = static_cast<int64_t>(it->second) + fix.addend - static_cast<int64_t>(fix.end);
+            for (size_t i = 0; i < 4; ++i) {
+                object.text[fix.offset + i] = static_cast<uint8_t>(rel >> (8 * i));
+            }
+            continue;
+        }
+
+        // Not in '.text' here, the linker finds it, e.g 'putnum' of `std.asm` or a label in '.data'.
+        auto sym = symbol_index.find(fix.label);
+        if (sym == symbol_index.end()) reject("undefined label", fix.label);
+        const ObjectCode::Symbol& target = object.symbols[sym->second];
+        if (target.section == ObjectCode::Section::Undefined && !target.global) reject("undefined label", fix.label);
+
+        int64_t addend = relative ? fix.addend - static_cast<int64_t>(fix.end - fix.offset) : fix.addend;
+        object.relocations.push_back(ObjectCode::Relocation{ fix.offset, sym->second, addend, fix.kind });
+    }
+    fixups.clear();
+    return std::move(object);
+}
+
+ObjectCode Encoder::assemble(std::string_view program) {
+    while (!program.empty()) {
+        size_t end = program.find('\n');
+        line(program.substr(0, end));
+        program = end == std::string_view::npos ? std::string_view{} : program.substr(end + 1);
+    }
+    return finish();
+}
+
+void Encoder::line(std::string_view text) {
+    text = trim(strip_comment(text));
+    if (text.empty()) return;
+
+    if (text.back() == ':') {
+        if (!in_text) reject("label outside of '.text'", text);
+        label(text.substr(0, text.size() - 1));
+        return;
+    }
+
+    auto [first, rest] = split_word(text);
+    if (first == "section") {
+        if (rest != ".text" && rest != ".data") reject("unknown section", rest);
+        in_text = rest == ".text";
+        return;
+    }
+    if (first == "global" || first == "extern") {
+        global(rest);
+        return;
+    }
+
+    auto [directive, values] = split_word(rest);
+    if (directive == "equ") {
+        auto constant = value(values);
+        if (!constant.has_value()) reject("bad constant", text);
+        constants[std::string(first)] = constant.value();
+        return;
+    }
+    if (directive == "db") {
+        if (in_text) reject("data outside of '.data'", text);
+        data(first, values);
+        return;
+    }
+
+    auto op = mnemonics_by_name().find(first);
+    if (op == mnemonics_by_name().end()) reject("unknown instruction", text);
+    if (!in_text) reject("instruction outside of '.text'", text);
+
+    AsmInst inst{ op->second };
+    for (AsmArg* arg : { &inst.lhs, &inst.rhs }) {
+        if (rest.empty()) break;
+        size_t comma = rest.find(',');
+        *arg = parse_arg(trim(rest.substr(0, comma)));
+        rest = comma == std::string_view::npos ? std::string_view{} : rest.substr(comma + 1);
+    }
+    if (!rest.empty()) reject("too many operands", text);
+    encode(inst);
+}
+
+void Encoder::data(std::string_view name, std::string_view values) {
+    ObjectCode::Symbol& sym = object.symbols[symbol(name)];
+    if (sym.section != ObjectCode::Section::Undefined) reject("label defined twice", name);
+    sym.section = ObjectCode::Section::Data;
+    sym.offset = object.data.size();
+
+    // Bytes, or 'N dup(V)' for N of them.
+    while (!values.empty()) {
+        size_t comma = values.find(',');
+        std::string_view item = trim(values.substr(0, comma));
+        values = comma == std::string_view::npos ? std::string_view{} : values.substr(comma + 1);
+
+        int64_t count = 1;
+        if (size_t dup = item.find(" dup("); dup != std::string_view::npos && item.back() == ')') {
+            auto times = value(trim(item.substr(0, dup)));
+            if (!times.has_value() || times.value() < 0) reject("bad 'dup' count", item);
+            count = times.value();
+            item = trim(item.substr(dup + 5, item.size() - dup - 6));
+        }
+
+        auto byte_value = value(item);
+        if (!byte_value.has_value()) reject("bad byte", item);
+        object.data.insert(object.data.end(), count, static_cast<uint8_t>(byte_value.value()));
+    }
+}
+
+AsmArg Encoder::parse_arg(std::string_view text) const {
+    uint8_t size = 0;
+    for (auto [keyword, bytes] : SIZE_KEYWORDS) {
+        if (text.starts_with(keyword)) {
+            size = bytes;
+            text = trim(text.substr(keyword.size()));
+            break;
+        }
+    }
+
+    // A name and what is added to it, e.g 'rbp - 8' or 'buffer + 20'.
+    auto split_offset = [&](std::string_view expr) -> std::pair<std::string_view, int64_t> {
+        size_t sign = expr.find_first_of("+-");
+        if (sign == std::string_view::npos) return { trim(expr), 0 };
+
+        auto added = value(trim(expr.substr(sign + 1)));
+        if (!added.has_value()) reject("bad offset", text);
+        int64_t offset = expr[sign] == '-' ? -added.value() : added.value();
+        if (!fits_i32(offset)) reject("offset out of range", text);
+        return { trim(expr.substr(0, sign)), offset };
+    };
+
+    if (text.starts_with('[')) {
+        if (!text.ends_with(']')) reject("unterminated memory operand", text);
+        auto [base, disp] = split_offset(text.substr(1, text.size() - 2));
+
+        if (auto reg = registers_by_name().find(base); reg != registers_by_name().end()) {
+            if (reg->second.size != 8) reject("not a base register", base);
+            return AsmArg::memory(reg->second.reg, disp, size);
+        }
+        AsmArg arg = AsmArg::memory(Register::Rax, disp, size);
+        arg.symbol = std::string(base);
+        return arg;
+    }
+
+    if (auto reg = registers_by_name().find(text); reg != registers_by_name().end()) {
+        return reg->second;
+    }
+    if (auto imm = value(text)) {
+        return AsmArg::immediate(imm.value());
+    }
+
+    auto [name, offset] = split_offset(text);
+    AsmArg arg = AsmArg::label(std::string(name));
+    arg.imm = offset;
+    return arg;
+}
+
+Option<int64_t> Encoder::value(std::string_view text) const {
+    if (text.size() == 3 && text.front() == '\'' && text.back() == '\'') {
+        return static_cast<uint8_t>(text[1]);
+    }
+    if (auto constant = constants.find(std::string(text)); constant != constants.end()) {
+        return constant->second;
+    }
+    return parse_number(text);
+}
+
+std::string Encoder::qualify(std::string_view label) const {
+    if (label.front() == '.') {
+        return scope + std::string(label);
+    }
+    return std::string(label);
+}
+
+size_t Encoder::symbol(std::string_view name) {
+    auto [it, fresh] = symbol_index.emplace(std::string(name), object.symbols.size());
+    if (fresh) {
+        object.symbols.push_back(ObjectCode::Symbol{ .name = std::string(name) });
+    }
+    return it->second;
+}
+
+bool Encoder::instruction(const AsmInst& inst) {
+    const AsmArg& dst = inst.lhs;
+    const AsmArg& src = inst.rhs;
+    auto shape = [&](Kind lhs, Kind rhs) {
+        return dst.is(lhs) && src.is(rhs);
+    };
+    bool byte_rex = needs_rex(dst) || needs_rex(src);
+
+    switch (inst.op) {
+        case Mnemonic::Ret:
+        case Mnemonic::Syscall:
+        case Mnemonic::Cqo:
+        {
+            if (!shape(Kind::None, Kind::None)) return false;
+            if (inst.op == Mnemonic::Ret) {
+                byte(0xC3);
+            } else if (inst.op == Mnemonic::Syscall) {
+                byte(0x0F);
+                byte(0x05);
+            } else {
+                byte(0x48);
+                byte(0x99);
+            }
+            return true;
+        }
+        case Mnemonic::Call:
+        case Mnemonic::Jmp:
+        {
+            if (!shape(Kind::Label, Kind::None)) return false;
+            byte(inst.op == Mnemonic::Call ? 0xE8 : 0xE9);
+            fixup(dst, RelocKind::Relative32);
+            return true;
+        }
+        case Mnemonic::Je:
+        case Mnemonic::Jne:
+        case Mnemonic::Jl:
+        case Mnemonic::Jle:
+        case Mnemonic::Jg:
+        case Mnemonic::Jge:
+        case Mnemonic::Js:
+        case Mnemonic::Jns:
+        {
+            if (!shape(Kind::Label, Kind::None)) return false;
+            byte(0x0F);
+            byte(0x80 | condition(inst.op));
+            fixup(dst, RelocKind::Relative32);
+            return true;
+        }
+        case Mnemonic::Sete:
+        case Mnemonic::Setne:
+        case Mnemonic::Setl:
+        case Mnemonic::Setle:
+        case Mnemonic::Setg:
+        case Mnemonic::Setge:
+        {
+            if (!shape(Kind::Reg, Kind::None) || dst.size != 1) return false;
+            rm_op({ 0x0F, static_cast<uint8_t>(0x90 | condition(inst.op)) }, 1, 0, dst, byte_rex);
+            return true;
+        }
+        case Mnemonic::Push:
+        case Mnemonic::Pop:
+        {
+            if (!shape(Kind::Reg, Kind::None) || dst.size != 8) return false;
+            rex(false, 0, number(dst.reg));
+            byte((inst.op == Mnemonic::Push ? 0x50 : 0x58) + (number(dst.reg) & 7));
+            return true;
+        }
+        case Mnemonic::Not:
+        case Mnemonic::Neg:
+        case Mnemonic::Div:
+        case Mnemonic::Idiv:
+        case Mnemonic::Inc:
+        case Mnemonic::Dec:
+        {
+            if (!shape(Kind::Reg, Kind::None)) return false;
+            bool step = inst.op == Mnemonic::Inc || inst.op == Mnemonic::Dec;
+            uint8_t opcode = step ? (dst.size == 1 ? 0xFE : 0xFF) : (dst.size == 1 ? 0xF6 : 0xF7);
+            rm_op({ opcode }, dst.size, extension(inst.op), dst, byte_rex);
+            return true;
+        }
+        case Mnemonic::Imul:
+        {
+            if (shape(Kind::Reg, Kind::None)) {
+                rm_op({ static_cast<uint8_t>(dst.size == 1 ? 0xF6 : 0xF7) }, dst.size, extension(inst.op), dst, byte_rex);
+            } else if (dst.is(Kind::Reg) && dst.size >= 4 && reg_or_mem(src) && (src.size == 0 || src.size == dst.size)) {
+                rm_op({ 0x0F, 0xAF }, dst.size, number(dst.reg), src);
+            } else if (shape(Kind::Reg, Kind::Imm) && dst.size >= 4 && fits_i8(src.imm)) {
+                // 'imul rax, 10' multiplies 'rax' in place.
+                rm_op({ 0x6B }, dst.size, number(dst.reg), dst);
+                byte(static_cast<uint8_t>(src.imm));
+            } else if (shape(Kind::Reg, Kind::Imm) && dst.size >= 4 && fits_i32(src.imm)) {
+                rm_op({ 0x69 }, dst.size, number(dst.reg), dst);
+                imm32(src.imm);
+            } else {
+                return false;
+            }
+            return true;
+        }
+        case Mnemonic::Shl:
+        case Mnemonic::Shr:
+        case Mnemonic::Sar:
+        {
+            if (!shape(Kind::Reg, Kind::Reg) || number(src.reg) != 1 || src.size != 1) return false;
+            rm_op({ static_cast<uint8_t>(dst.size == 1 ? 0xD2 : 0xD3) }, dst.size, extension(inst.op), dst, needs_rex(dst));
+            return true;
+        }
+        case Mnemonic::Mov:
+        {
+            bool fits_u32 = src.imm >= 0 && src.imm <= std::numeric_limits<uint32_t>::max();
+            if (shape(Kind::Reg, Kind::Imm) && dst.size == 8) {
+                if (fits_u32) {
+                    // Writing the low half zeroes the rest, one byte shorter than the sign-extending form.
+                    rex(false, 0, number(dst.reg));
+                    byte(0xB8 + (number(dst.reg) & 7));
+                    imm32(src.imm);
+                } else if (fits_i32(src.imm)) {
+                    rm_op({ 0xC7 }, 8, 0, dst);
+                    imm32(src.imm);
+                } else {
+                    rex(true, 0, number(dst.reg));
+                    byte(0xB8 + (number(dst.reg) & 7));
+                    imm32(src.imm);
+                    imm32(src.imm >> 32);
+                }
+            } else if (shape(Kind::Reg, Kind::Imm) && dst.size == 4 && (fits_u32 || fits_i32(src.imm))) {
+                rex(false, 0, number(dst.reg));
+                byte(0xB8 + (number(dst.reg) & 7));
+                imm32(src.imm);
+            } else if (shape(Kind::Reg, Kind::Label) && dst.size == 8) {
+                // The address of a label, e.g 'mov rdx, buffer + 20'.
+                rex(true, 0, number(dst.reg));
+                byte(0xB8 + (number(dst.reg) & 7));
+                fixup(src, RelocKind::Absolute64);
+            } else if (reg_or_mem(dst) && src.is(Kind::Reg) && (dst.size == 0 || dst.size == src.size)) {
+                rm_op({ static_cast<uint8_t>(src.size == 1 ? 0x88 : 0x89) }, src.size, number(src.reg), dst, byte_rex);
+            } else if (shape(Kind::Reg, Kind::Mem) && (src.size == 0 || src.size == dst.size)) {
+                rm_op({ static_cast<uint8_t>(dst.size == 1 ? 0x8A : 0x8B) }, dst.size, number(dst.reg), src, byte_rex);
+            } else {
+                return false;
+            }
+            return true;
+        }
+        case Mnemonic::Movzx:
+        {
+            if (!dst.is(Kind::Reg) || dst.size < 2 || !reg_or_mem(src) || (src.size != 1 && src.size != 2)) return false;
+            rm_op({ 0x0F, static_cast<uint8_t>(src.size == 1 ? 0xB6 : 0xB7) }, dst.size, number(dst.reg), src, byte_rex);
+            return true;
+        }
+        case Mnemonic::Lea:
+        {
+            if (!shape(Kind::Reg, Kind::Mem)) return false;
+            rm_op({ 0x8D }, dst.size, number(dst.reg), src);
+            return true;
+        }
+        case Mnemonic::Test:
+        {
+            if (!reg_or_mem(dst) || !src.is(Kind::Reg) || (dst.size != 0 && dst.size != src.size)) return false;
+            rm_op({ static_cast<uint8_t>(src.size == 1 ? 0x84 : 0x85) }, src.size, number(src.reg), dst, byte_rex);
+            return true;
+        }
+        case Mnemonic::Add:
+        case Mnemonic::Or:
+        case Mnemonic::And:
+        case Mnemonic::Sub:
+        case Mnemonic::Xor:
+        case Mnemonic::Cmp:
+        {
+            uint8_t op = extension(inst.op);
+            if (reg_or_mem(dst) && src.is(Kind::Imm)) {
+                size_t width = dst.size;
+                if (width == 1) {
+                    rm_op({ 0x80 }, 1, op, dst, byte_rex);
+                    byte(static_cast<uint8_t>(src.imm));
+                } else if (width != 0 && fits_i8(src.imm)) {
+                    rm_op({ 0x83 }, width, op, dst);
+                    byte(static_cast<uint8_t>(src.imm));
+                } else if ((width == 4 || width == 8) && fits_i32(src.imm)) {
+                    rm_op({ 0x81 }, width, op, dst);
+                    imm32(src.imm);
+                } else {
+                    return false;
+                }
+            } else if (reg_or_mem(dst) && src.is(Kind::Reg) && (dst.size == 0 || dst.size == src.size)) {
+                uint8_t opcode = static_cast<uint8_t>(op * 8 + (src.size == 1 ? 0 : 1));
+                rm_op({ opcode }, src.size, number(src.reg), dst, byte_rex);
+            } else if (shape(Kind::Reg, Kind::Mem) && (src.size == 0 || src.size == dst.size)) {
+                uint8_t opcode = static_cast<uint8_t>(op * 8 + (dst.size == 1 ? 2 : 3));
+                rm_op({ opcode }, dst.size, number(dst.reg), src, byte_rex);
+            } else {
+                return false;
+            }
+            return true;
+        }
+    }
+    return false;
+}
+
+void Encoder::byte(uint8_t value) {
+    object.text.push_back(value);
+}
+
+void Encoder::imm32(int64_t value) {
+    for (size_t i = 0; i < 4; ++i) {
+        byte(static_cast<uint8_t>(value >> (8 * i)));
+    }
+}
+
+void Encoder::rex(bool wide, uint8_t reg, uint8_t base, bool force) {
+    uint8_t prefix = 0x40 | (wide << 3) | ((reg >> 3) << 2) | (base >> 3);
+    if (prefix != 0x40 || force) byte(prefix);
+}
+
+void Encoder::modrm(uint8_t reg, const AsmArg& rm) {
+    if (rm.is(Kind::Reg)) {
+        byte(0xC0 | ((reg & 7) << 3) | (number(rm.reg) & 7));
+        return;
+    }
+
+    // Memory at a label is addressed relative to the next instruction.
+    if (!rm.symbol.empty()) {
+        byte(0x05 | ((reg & 7) << 3));
+        fixup(rm, RelocKind::Relative32);
+        return;
+    }
+
+    // 'rbp' and 'r13' without a displacement would mean 'rip', so they always carry one.
+    uint8_t base = number(rm.reg);
+    uint8_t mod = rm.imm == 0 && (base & 7) != 5 ? 0 : fits_i8(rm.imm) ? 1 : 2;
+    byte((mod << 6) | ((reg & 7) << 3) | (base & 7));
+    // 'rsp' and 'r12' as a base need a SIB byte without an index.
+    if ((base & 7) == 4) byte(0x24);
+
+    if (mod == 1) byte(static_cast<uint8_t>(rm.imm));
+    if (mod == 2) imm32(rm.imm);
+}
+
+void Encoder::rm_op(std::initializer_list<uint8_t> opcode, size_t width, uint8_t reg, const AsmArg& rm, bool byte_rex) {
+    uint8_t base = rm.is(Kind::Mem) && !rm.symbol.empty() ? 0 : number(rm.reg);
+    if (width == 2) byte(0x66);
+    rex(width == 8, reg, base, byte_rex);
+    for (uint8_t code : opcode) {
+        byte(code);
+    }
+    modrm(reg, rm);
+}
+
+void Encoder::fixup(const AsmArg& target, RelocKind kind) {
+    fixups.push_back(Fixup{ object.text.size(), 0, qualify(target.symbol), target.imm, kind });
+    size_t width = kind == RelocKind::Absolute64 ? 8 : 4;
+    for (size_t i = 0; i < width; ++i) {
+        byte(0);
+    }
+}
@@ -0,0 +1,171 @@
+#ifndef ENCODER_HPP_
+#define ENCODER_HPP_
+
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "asm.hpp"
+
+/// @brief `Mnemonic`
+/// The instructions `CodeGen` emits and `std.asm` is written in.
+enum class Mnemonic : uint8_t {
+    Mov, Movzx, Lea,
+    Add, Or, And, Sub, Xor, Cmp, Test,
+    Imul, Idiv, Div, Neg, Not, Inc, Dec,
+    Shl, Shr, Sar,
+    Sete, Setne, Setl, Setle, Setg, Setge,
+    Jmp, Je, Jne, Jl, Jle, Jg, Jge, Js, Jns,
+    Call, Push, Pop, Ret, Syscall, Cqo,
+};
+
+/// @brief `AsmArg`
+/// An instruction operand: a register, memory, an immediate or a label.
+struct AsmArg {
+    enum class Kind : uint8_t { None, Reg, Mem, Imm, Label };
+
+    Kind kind = Kind::None;
+    // The register, or the base of memory that is not at a label.
+    Register reg = Register::Rax;
+    // Width in bytes, 0 for memory without a size keyword.
+    uint8_t size = 0;
+    // The immediate, the displacement of memory, or what is added to a label.
+    int64_t imm = 0;
+    // The target of a jump or a call, memory at a label is addressed relative to the next instruction.
+    std::string symbol{};
+
+    static AsmArg gpr(Register reg, uint8_t size = 8) {
+        return AsmArg{ .kind = Kind::Reg, .reg = reg, .size = size };
+    }
+
+    // E.g 'qword [rbp - 8]' for `memory(Register::Rbp, -8, 8)`.
+    static AsmArg memory(Register base, int64_t disp, uint8_t size = 0) {
+        return AsmArg{ .kind = Kind::Mem, .reg = base, .size = size, .imm = disp };
+    }
+
+    static AsmArg immediate(int64_t value) {
+        return AsmArg{ .kind = Kind::Imm, .imm = value };
+    }
+
+    static AsmArg label(std::string name) {
+        return AsmArg{ .kind = Kind::Label, .symbol = std::move(name) };
+    }
+
+    bool is(Kind other) const {
+        return kind == other;
+    }
+};
+
+/// @brief `AsmInst`
+/// One x86-64 instruction, its operands in Intel order.
+struct AsmInst {
+    Mnemonic op;
+    AsmArg lhs{};
+    AsmArg rhs{};
+
+    // How it reads in NASM, e.g 'mov qword [rbp - 8], rax'.
+    String as_str() const;
+};
+
+/// @brief `ObjectCode`
+/// The machine code of a program and what a linker needs to place it.
+struct ObjectCode {
+    enum class Section : uint8_t { Undefined, Text, Data };
+
+    struct Symbol {
+        std::string name{};
+        // `Undefined` when another object defines it.
+        Section section = Section::Undefined;
+        // Offset into its section.
+        uint64_t offset = 0;
+        bool global = false;
+    };
+
+    /// @brief `Relocation`
+    /// A field in `text` the linker fills with the address of `symbol` plus `addend`.
+    /// `Relative32` is relative to the field, e.g the target of a 'call' into `std.asm`.
+    /// `Absolute64` is the address itself, e.g 'mov rdx, buffer + 20'.
+    struct Relocation {
+        enum class Kind : uint8_t { Relative32, Absolute64 };
+
+        uint64_t offset;
+        size_t symbol;
+        int64_t addend;
+        Kind kind = Kind::Relative32;
+    };
+
+    std::vector<uint8_t> text;
+    std::vector<uint8_t> data;
+    std::vector<Symbol> symbols;
+    std::vector<Relocation> relocations;
+};
+
+/// @brief `Encoder`
+/// Encodes x86-64 instructions into machine code, without leaving the process.
+/// `CodeGen` drives it an instruction at a time, `std.asm` goes through `assemble`.
+/// Labels follow NASM's scoping, '.label' belongs to the last label without a dot.
+/// A form it does not know is a codegen bug and asserts.
+class Encoder {
+public:
+    // `scope` is the label '.labels' belong to until another is defined, for code emitted apart from its function.
+    explicit Encoder(std::string scope = {}) : scope(std::move(scope)) {}
+
+    // Exports a symbol defined here, or names one another object defines.
+    void global(std::string_view name);
+    // Defines a label at the end of the code.
+    void label(std::string_view name);
+    void encode(const AsmInst& inst);
+    // Moves the code of `other` after this one's, e.g the body of a function after its prologue.
+    void append(Encoder&& other);
+    // Resolves the jumps and calls between labels, those to other objects are left as relocations.
+    ObjectCode finish();
+
+    // Assembles NASM text as `std.asm` is written: 'section', 'global' and 'extern', labels,
+    // 'db' data and 'equ' constants, and instructions `encode` knows.
+    ObjectCode assemble(std::string_view program);
+
+private:
+    /// @brief `Fixup`
+    /// A field referring to a label, patched once every label is known.
+    struct Fixup {
+        size_t offset;
+        // End of the instruction, relative fields count from it.
+        size_t end;
+        std::string label;
+        int64_t addend;
+        ObjectCode::Relocation::Kind kind;
+    };
+
+    ObjectCode object;
+    std::unordered_map<std::string, size_t> symbol_index;
+    // Offset in `.text` of every label, the ones scoped under a function included.
+    std::unordered_map<std::string, size_t> labels;
+    std::vector<Fixup> fixups;
+    // The last label without a leading dot, which '.labels' are scoped under.
+    std::string scope;
+
+    // Only while assembling text.
+    bool in_text = false;
+    std::unordered_map<std::string, int64_t> constants;
+
+    // Encodes one instruction, returns false for a form it does not know.
+    bool instruction(const AsmInst& inst);
+    std::string qualify(std::string_view label) const;
+    size_t symbol(std::string_view name);
+
+    void line(std::string_view text);
+    void data(std::string_view name, std::string_view values);
+    AsmArg parse_arg(std::string_view text) const;
+    Option<int64_t> value(std::string_view text) const;
+
+    void byte(uint8_t value);
+    void imm32(int64_t value);
+    void rex(bool wide, uint8_t reg, uint8_t base, bool force = false);
+    // ModR/M, and SIB and displacement when `rm` is memory, with `reg` in the middle field.
+    void modrm(uint8_t reg, const AsmArg& rm);
+    // `opcode` with a ModR/M byte, prefixed as the operand size of `width` requires.
+    void rm_op(std::initializer_list<uint8_t> opcode, size_t width, uint8_t reg, const AsmArg& rm, bool byte_rex = false);
+    void fixup(const AsmArg& target, ObjectCode::Relocation::Kind kind);
+};
+
+#endif // ENCODER_HPP_
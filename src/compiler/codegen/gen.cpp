@@ -13,7 +13,7 @@ Option<Register> CodeGen::register_for_arguement_pipelining() {
             return reg;
         }
     }
-    log("Register spilling is not implemented.");
+    // Arguments past the sixth are passed on the stack.
     return std::nullopt;
 }
 
@@ -25,27 +25,29 @@ void CodeGen::clean_registers(size_t passed_arguments) {
     }
 }
 
-void CodeGen::load_operand(
-    Ptr<Operand>& op, 
-    String&& reg,
-    Option<String> sym
-) {
-    switch (op->kind) {
+void CodeGen::load_operand(const Operand& op, Register reg) {
+    switch (op.kind) {
         case OpKind::Lit: 
         {
-            auto* lop = dynamic_cast<LitOp*>(op.get());
-            appendln(format("mov {}, {}", reg, op->as_str()));
+            emit(Mnemonic::Mov, AsmArg::gpr(reg), AsmArg::immediate(op.imm));
             break;
         }
         case OpKind::Sym:
         case OpKind::Temp:
         {
-            size_t offset = stack.offset(sym.value());
-            size_t memsize = stack.memsize(sym.value());
+            if (auto placed = stack.register_of(op)) {
+                if (placed.value() != reg) {
+                    emit(Mnemonic::Mov, AsmArg::gpr(reg), AsmArg::gpr(placed.value()));
+                }
+                break;
+            }
+
+            size_t offset = stack.offset(op);
+            size_t memsize = stack.memsize(op);
 
             switch(memsize) {
-                case 1: appendln(format("movzx {}, byte [rbp - {}]", reg, offset)); break;
-                case 8: appendln(format("mov {}, qword [rbp - {}]", reg, offset)); break;
+                case 1: emit(Mnemonic::Movzx, AsmArg::gpr(reg), frame_slot(offset, 1)); break;
+                case 8: emit(Mnemonic::Mov, AsmArg::gpr(reg), frame_slot(offset, 8)); break;
                 default: 
                     UNREACHABLE();
             }
@@ -53,8 +55,8 @@ void CodeGen::load_operand(
         }
         case OpKind::Addr:
         {
-            size_t offset = stack.offset(sym.value());
-            appendln(format("lea {}, [rbp - {}]", reg, offset));
+            size_t offset = stack.offset(slot_of(op));
+            emit(Mnemonic::Lea, AsmArg::gpr(reg), frame_slot(offset));
             break;
         }
         default: 
@@ -62,6 +64,16 @@ void CodeGen::load_operand(
     }
 }
 
+void CodeGen::store_operand(const Operand& op, Register reg) {
+    if (auto placed = stack.register_of(op)) {
+        if (placed.value() != reg) {
+            emit(Mnemonic::Mov, AsmArg::gpr(placed.value()), AsmArg::gpr(reg));
+        }
+        return;
+    }
+    emit(Mnemonic::Mov, frame_slot(stack.offset(op), 8), AsmArg::gpr(reg));
+}
+
 void CodeGen::set_abi_registers() {
     abi_registers = {
         Register::Rdi, 
@@ -81,13 +93,20 @@ void CodeGen::set_abi_registers() {
     };
 }
 
-void CodeGen::assemble(IrProgram& program) {
+void CodeGen::assemble(IrProgram& program, WorkerPool& pool, OptLevel level, bool as_text) {
     raw_program.str("");
     raw_program.clear();
+    code = Encoder();
     depth = 0;
+    this->level = level;
+    this->as_text = as_text;
 
     set_abi_registers();
     emit_header(program);
     emit_data_section(program);
-    emit_text_section(program);
+    emit_text_section(program, pool);
+
+    if (!as_text) {
+        object = code.finish();
+    }
 }
\ No newline at end of file
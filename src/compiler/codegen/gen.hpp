@@ -3,6 +3,8 @@
 
 #include <string>
 #include "asm.hpp"
+#include "encoder.hpp"
+#include "regalloc.hpp"
 
 class CodeGen {
 public:
@@ -17,12 +19,19 @@ public:
           depth{0},
           argument_position{0} {}
 
-    void assemble(IrProgram& program);
+    // Functions are emitted in parallel on `pool`, the output does not depend on its size.
+    // From `-O2` values are kept in registers, `-O3` colors them for better code.
+    // Machine code goes straight to the encoder, the NASM text is only written with `as_text`.
+    void assemble(IrProgram& program, WorkerPool& pool, OptLevel level = OptLevel::O0, bool as_text = false);
 
     inline std::string get_raw_program() const { 
         return raw_program.str(); 
     }    
 
+    inline const ObjectCode& get_object_code() const {
+        return object;
+    }
+
     fs::path transform_extension(fs::path& from) {
         fs::path asm_file { from };
         asm_file.replace_extension(CodeGen::EXT);
@@ -38,8 +47,14 @@ private:
     _Regs abi_registers;
     size_t depth;
     size_t argument_position;
+    OptLevel level = OptLevel::O0;
+    bool as_text = false;
     std::stringstream raw_program;
+    Encoder code;
+    ObjectCode object;
     std::stringstream conv;
+    // Logs of the function being emitted, printed once every function is done.
+    std::string pending_logs;
 
     // Size of temporary variables in memory.
     static CONST int TEMP_SIZE = 8;
@@ -47,12 +62,13 @@ private:
     void set_abi_registers();
     void emit_header(IrProgram& ir);
     void emit_data_section(IrProgram& ir);
-    void emit_text_section(IrProgram& ir);
+    void emit_text_section(IrProgram& ir, WorkerPool& pool);
 
     void emit_function(IrFn& func);
     void emit_instruction(IrFn& fn, Instruction& inst);
     void emit_call(Instruction& inst);
     void emit_assign(Instruction& inst);
+    void emit_copy(Instruction& inst);
     void emit_store(Instruction& inst);
     void emit_alloc(Instruction& inst);
     void emit_deref(Instruction& inst);
@@ -77,8 +93,11 @@ private:
     void emit_jmp_false(Instruction& inst);
     void emit_cmp(Instruction& inst);
 
-    // Loads into the given registers memory 'op'.
-    void load_operand(Ptr<Operand>& op, String&& reg, Option<String> sym);
+    // Loads 'op' into the given register.
+    void load_operand(const Operand& op, Register reg);
+
+    // Stores the 64-bit 'reg' into the register or the slot of 'op'.
+    void store_operand(const Operand& op, Register reg);
 
     // Returns the current available register for pipelining function arguments.
     Option<Register> register_for_arguement_pipelining();
@@ -86,16 +105,9 @@ private:
     // Cleans all the registers until 'passed_arguments', if 'passed_arguments' is more than 6, we clear the stack.
     void clean_registers(size_t passed_arguments);
 
-    // Is the operand a symbol? for register allocation.
-    Option<String> gain_symbol(Ptr<Operand>& op) {
-        if(op->kind == OpKind::Lit) {
-            return std::nullopt;
-        }
-        if(op->kind == OpKind::Addr) {
-            auto* addr_op = dynamic_cast<AddrOp*>(op.get());
-            return addr_op->ident;
-        }
-        return op->as_str();
+    // The stack slot behind an operand, an address lives in the slot of its variable.
+    Operand slot_of(const Operand& op) {
+        return op.is(OpKind::Addr) ? Operand::var(op.sym) : op;
     }
 
     String reg_to_str(Register reg) {
@@ -108,6 +120,12 @@ private:
             case Register::Rcx: return "rcx";
             case Register::R8:  return "r8";
             case Register::R9:  return "r9";
+            case Register::R10: return "r10";
+            case Register::R11: return "r11";
+            case Register::R12: return "r12";
+            case Register::R13: return "r13";
+            case Register::R14: return "r14";
+            case Register::R15: return "r15";
             default:
                 ASSERT(false, "unreachable");
         }
@@ -125,84 +143,42 @@ private:
         return (n + align - 1) & ~(align - 1);
     }
 
-    std::string mem_ident_from_size(size_t size) {
-        switch(size) {
-            case 8: return "qword"; 
-            case 4: return "dword"; 
-            case 2: return "word"; 
-            case 1: return "byte";
-            default: {
-                ASSERT(false, format("[codegen::err] invalid operand size, {}", size));
-                return "";
-            } 
+    // The slot `offset` bytes below the frame pointer.
+    static AsmArg frame_slot(size_t offset, uint8_t size = 0) {
+        return AsmArg::memory(Register::Rbp, -static_cast<int64_t>(offset), size);
+    }
+
+    void emit(Mnemonic op, AsmArg lhs = {}, AsmArg rhs = {}) {
+        AsmInst inst{ op, std::move(lhs), std::move(rhs) };
+        if (!as_text) {
+            code.encode(inst);
+            return;
         }
+        appendln(inst.as_str());
     }
 
-    String register_variant_from_size(Register reg, size_t memsize) {
-        switch (reg) {
-            case Register::Rdi:
-                switch (memsize) {
-                    case 1: return "dil";
-                    case 2: return "di";
-                    case 4: return "edi";
-                    case 8: return "rdi";
-                }
-                break;
-            case Register::Rsi:
-                switch (memsize) {
-                    case 1: return "sil";
-                    case 2: return "si";
-                    case 4: return "esi";
-                    case 8: return "rsi";
-                }
-                break;
-            case Register::Rdx:
-                switch (memsize) {
-                    case 1: return "dl";
-                    case 2: return "dx";
-                    case 4: return "edx";
-                    case 8: return "rdx";
-                }
-                break;
-            case Register::Rcx:
-                switch (memsize) {
-                    case 1: return "cl";
-                    case 2: return "cx";
-                    case 4: return "ecx";
-                    case 8: return "rcx";
-                }
-                break;
-            case Register::R8:
-                switch (memsize) {
-                    case 1: return "r8b";
-                    case 2: return "r8w";
-                    case 4: return "r8d";
-                    case 8: return "r8";
-                }
-                break;
-            case Register::R9:
-                switch (memsize) {
-                    case 1: return "r9b";
-                    case 2: return "r9w";
-                    case 4: return "r9d";
-                    case 8: return "r9";
-                }
-                break;
-            default:
-                UNREACHABLE();
+    void label(std::string_view name) {
+        if (!as_text) {
+            code.label(name);
+            return;
         }
+        raw_program << name << ':' << NEWLINE;
     }
 
+    // The lines below only make up the text, e.g comments.
     void append_inline_comment(String&& line) { 
+        if (!as_text) return;
         raw_program << DOC << line << NEWLINE; 
     };
 
     void append(String&& line) { 
+        if (!as_text) return;
         raw_program << std::string(depth, TAB) << line; 
     };
 
     void appendln(String&& line) {
         ASSERT(depth >= 0, "depth must be greater or equal to 0");
+        if (!as_text) return;
         raw_program << std::string(depth, TAB) << line << NEWLINE;
     }
 
@@ -218,7 +194,8 @@ private:
     };
 
     void log(String&& log) {
-        std::printf("%s\n", log.c_str());
+        pending_logs += log;
+        pending_logs += NEWLINE;
     }
 };
 
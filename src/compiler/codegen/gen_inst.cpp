@@ -1,37 +1,39 @@
 #include <fstream>
 #include "gen.hpp"
+#include "builtins.hpp"
 
 void CodeGen::emit_alloc(Instruction& inst) {
-    auto ident = inst.dst.value();
+    auto ident = inst.dst;
     auto& op = inst.parts.front();
 
-    ASSERT(op->kind == OpKind::Lit, "alloc must provide a size.");
-    size_t size = std::stoull(op->as_str());
+    ASSERT(op.is(OpKind::Lit), "alloc must provide a size.");
+    size_t size = op.imm;
+    if (auto placed = stack.register_of(ident)) {
+        appendln(format("; '{}' lives in {}", ident.as_str(), reg_to_str(placed.value())));
+        return;
+    }
     stack.allocate(ident, size);
 
-    String doc = format("; '{}' allocation of {} bytes", ident, size);
+    String doc = format("; '{}' allocation of {} bytes", ident.as_str(), size);
     appendln(std::move(doc));
 }
 
 void CodeGen::emit_deref(Instruction& inst) {
-    auto sym = inst.dst.value();
+    auto sym = inst.dst;
     stack.allocate(sym, TEMP_SIZE);
     
     auto& op = inst.parts.front();
-    size_t offset = stack.offset(op->as_str());
-    size_t memsize = stack.memsize(op->as_str());
 
     // load it into "rax".
-    load_operand(op, "rax", gain_symbol(op));
+    load_operand(op, Register::Rax);
 
-    appendln(format("mov rax, qword [rax]"));
-    size_t dest_offset = stack.offset(sym);
-    appendln(format("mov qword [rbp - {}], rax", dest_offset));
+    emit(Mnemonic::Mov, AsmArg::gpr(Register::Rax), AsmArg::memory(Register::Rax, 0, 8));
+    store_operand(sym, Register::Rax);
     appendln("");
 }
 
 void CodeGen::emit_assign(Instruction& inst) {
-    auto ident = inst.dst.value();
+    auto ident = inst.dst;
     auto& op = inst.parts.front();
 
     size_t offset = stack.offset(ident);
@@ -40,31 +42,45 @@ void CodeGen::emit_assign(Instruction& inst) {
     switch(memsize)
     {
         case 1: {
-            load_operand(op, "rax", gain_symbol(op));
-            String nasm = format("mov byte [rbp - {}], al", offset);
-            appendln(std::move(nasm));
+            load_operand(op, Register::Rax);
+            emit(Mnemonic::Mov, frame_slot(offset, 1), AsmArg::gpr(Register::Rax, 1));
             break;
         }
         case 8:
         {
-            load_operand(op, "rax", gain_symbol(op));
-            String nasm = format("mov qword [rbp - {}], rax", offset);
-            appendln(std::move(nasm));
+            if (auto placed = stack.register_of(ident)) {
+                load_operand(op, placed.value());
+                break;
+            }
+            load_operand(op, Register::Rax);
+            emit(Mnemonic::Mov, frame_slot(offset, 8), AsmArg::gpr(Register::Rax));
             break;
         }
         default: 
-            log(format("'{}' is of size {}, therefore we dont support it.", ident, memsize));
+            log(format("'{}' is of size {}, therefore we dont support it.", ident.as_str(), memsize));
     }
 }
 
+void CodeGen::emit_copy(Instruction& inst) {
+    auto sym = inst.dst;
+    stack.allocate(sym, TEMP_SIZE);
+
+    if (auto placed = stack.register_of(sym)) {
+        load_operand(inst.parts.front(), placed.value());
+        return;
+    }
+    load_operand(inst.parts.front(), Register::Rax);
+    store_operand(sym, Register::Rax);
+}
+
 void CodeGen::emit_store(Instruction& inst) {
     auto& address = inst.parts.at(0);
     auto& value = inst.parts.at(1);
 
-    load_operand(value, "rax", gain_symbol(value));
-    load_operand(address, "rbx", gain_symbol(address));
+    load_operand(value, Register::Rax);
+    load_operand(address, Register::R11);
 
-    appendln("mov qword [rbx], rax");
+    emit(Mnemonic::Mov, AsmArg::memory(Register::R11, 0, 8), AsmArg::gpr(Register::Rax));
 }
 
 void CodeGen::emit_push(Instruction& inst) {
@@ -76,14 +92,13 @@ void CodeGen::emit_push(Instruction& inst) {
 
     if(!unoccupied_register.has_value()) {
         // Pass it through the stack.
-        load_operand(op, "rax", gain_symbol(op));
-        appendln("push rax");
+        load_operand(op, Register::Rax);
+        emit(Mnemonic::Push, AsmArg::gpr(Register::Rax));
 
         AsmStackFrame& fm = stack.get_current();
         fm.extra_arguments++; 
     } else {
-        String reg = reg_to_str(unoccupied_register.value());
-        load_operand(op, std::move(reg), gain_symbol(op));
+        load_operand(op, unoccupied_register.value());
     }
 }
 
@@ -91,40 +106,42 @@ void CodeGen::emit_ret(Instruction& inst) {
     size_t label_index = 0;
 
     if (inst.parts.size() == 2) {
-        load_operand(inst.parts.at(0), "rax", gain_symbol(inst.parts.at(0)));
+        load_operand(inst.parts.at(0), Register::Rax);
         label_index = 1;
     }
 
     auto& label = inst.parts.at(label_index);
-    appendln(format("jmp .end_{}", label->as_str()));
+    emit(Mnemonic::Jmp, AsmArg::label(format(".end_{}", label.as_str())));
 }
 
 void CodeGen::emit_pop(Instruction& inst) {
-    auto ident = inst.dst.value();
-    auto* size_op = dynamic_cast<LitOp*>(inst.parts.front().get());
-    size_t size = std::stoull(size_op->value);
+    auto ident = inst.dst;
+    size_t size = inst.parts.front().imm;
 
     stack.allocate(ident, size);
+    if (auto placed = stack.register_of(ident)) {
+        if (argument_position < abi_registers.size()) {
+            store_operand(ident, abi_registers.at(argument_position));
+        } else {
+            size_t stack_offset = 16 + 8 * (argument_position - abi_registers.size());
+            emit(Mnemonic::Mov, AsmArg::gpr(placed.value()), AsmArg::memory(Register::Rbp, stack_offset));
+        }
+        argument_position++;
+        return;
+    }
     size_t offset = stack.offset(ident);
     size_t memsize = stack.memsize(ident);
 
     if (argument_position < abi_registers.size()) 
     {
         Register slot = abi_registers.at(argument_position);
-        String reg = reg_to_str(slot);
-        String nasm = format(
-            "mov {} [rbp - {}], {}", 
-            mem_ident_from_size(memsize), 
-            offset, 
-            register_variant_from_size(slot, memsize)
-        );
-        appendln(std::move(nasm));
+        emit(Mnemonic::Mov, frame_slot(offset, memsize), AsmArg::gpr(slot, memsize));
     } 
     else
     {
         size_t stack_offset = 16 + 8 * (argument_position - abi_registers.size());
-        appendln(format("mov rax, [rbp + {}]", stack_offset));
-        appendln(format("mov qword [rbp - {}], rax", offset));
+        emit(Mnemonic::Mov, AsmArg::gpr(Register::Rax), AsmArg::memory(Register::Rbp, stack_offset));
+        emit(Mnemonic::Mov, frame_slot(offset, 8), AsmArg::gpr(Register::Rax));
     }
     // Update position for next arguement.
     argument_position++;
@@ -138,48 +155,49 @@ void CodeGen::emit_call(Instruction& inst) {
     auto& args_op = inst.parts.at(1); 
 
     // emit a call.
-    appendln(format("call {}", name_op->as_str()));
+    emit(Mnemonic::Call, AsmArg::label(name_op.as_str()));
 
     // store the value of the function.
-    if(sym.has_value()) {
+    if(inst.has_dst()) {
         // temporary allocation.
-        stack.allocate(sym.value(), TEMP_SIZE);
-        String nasm = format("mov qword [rbp - {}], rax", stack.offset(sym.value()));
-        appendln(std::move(nasm));
+        stack.allocate(sym, TEMP_SIZE);
+        store_operand(sym, Register::Rax);
     }
 
     // clean the occupied register.
-    size_t passed_arguments = std::stoull(args_op->as_str());
+    size_t passed_arguments = args_op.imm;
     clean_registers(passed_arguments);
 
     // Clean the stack if extra arguements used.
     AsmStackFrame& fm = stack.get_current();
     if (fm.extra_arguments > 0) {
         size_t cleanup_bytes = fm.extra_arguments * 8;
-        appendln(format("add rsp, {}", cleanup_bytes));
+        emit(Mnemonic::Add, AsmArg::gpr(Register::Rsp), AsmArg::immediate(cleanup_bytes));
         fm.extra_arguments = 0;
     }
 }
 
 void CodeGen::emit_label(Instruction& inst) {
-    auto addr = inst.dst.value();
-    decrease_depth();
-    appendln(format("{}:", addr));
-    increase_depth();
+    auto addr = inst.dst;
+    label(addr.as_str());
 }
 
 void CodeGen::emit_jmp(Instruction& inst) {
     auto& label_op = inst.parts.front();
-    appendln(format("jmp {}", label_op->as_str()));    
+    emit(Mnemonic::Jmp, AsmArg::label(label_op.as_str()));
 }
 
 void CodeGen::emit_jmp_false(Instruction& inst) {
     auto& condition_op = inst.parts.at(0);
     auto& addr_op = inst.parts.at(1);
 
-    load_operand(condition_op, "rax", gain_symbol(condition_op));
-    appendln("cmp rax, 0");
-    appendln(format("je {}", addr_op->as_str()));
+    if (auto placed = stack.register_of(condition_op)) {
+        emit(Mnemonic::Cmp, AsmArg::gpr(placed.value()), AsmArg::immediate(0));
+    } else {
+        load_operand(condition_op, Register::Rax);
+        emit(Mnemonic::Cmp, AsmArg::gpr(Register::Rax), AsmArg::immediate(0));
+    }
+    emit(Mnemonic::Je, AsmArg::label(addr_op.as_str()));
 }
 
 void CodeGen::emit_instruction(IrFn& func, Instruction& inst) {
@@ -208,6 +226,11 @@ void CodeGen::emit_instruction(IrFn& func, Instruction& inst) {
             emit_assign(inst);
             break;
         }
+        case OpCode::Copy:
+        {
+            emit_copy(inst);
+            break;
+        }
         case OpCode::Push: 
         {
             emit_push(inst);
@@ -320,45 +343,97 @@ void CodeGen::emit_instruction(IrFn& func, Instruction& inst) {
 
 void CodeGen::emit_function(IrFn& func) {
     ASSERT(
-        func.insts.front().match_code(OpCode::Label), 
+        !func.blocks.empty() && func.blocks.front().label().has_value(), 
         "function must begin with a label."
     );
+    ASSERT(!func.in_ssa, format("[codegen::err] '{}' must be taken out of SSA form first.", func.name.str()));
     stack.enter_func(func.name);
 
-    appendln(format("\n; FUNC {} START_IMPL", func.name));
-    appendln(format("{}:", func.name));
-    increase_depth();
-    appendln("push rbp");
-    appendln("mov rbp, rsp");
+    Allocation allocation;
+    if (level >= OptLevel::O3) {
+        allocation = regalloc::graph_coloring(func);
+    } else if (level == OptLevel::O2) {
+        allocation = regalloc::linear_scan(func);
+    } else {
+        allocation = regalloc::stack_only(func);
+    }
+    AsmStackFrame& frame = stack.get_current();
+    for (const auto& [value, reg] : allocation.registers) {
+        frame.place(value, reg, TEMP_SIZE);
+    }
 
-    if (func.space_occupied > 0) {
-        appendln(format("sub rsp, {}", align_to(func.space_occupied, 16)));
+    // Callee-saved registers the body writes keep the caller's values in the topmost slots.
+    std::vector<std::pair<Register, size_t>> saved;
+    for (Register reg : allocation.saved) {
+        saved.emplace_back(reg, frame.reserve(TEMP_SIZE));
     }
 
+    // Temporaries and scalar locals left in memory take the slots the allocator shared out between them.
+    std::vector<size_t> slots(allocation.slot_count);
+    for (auto& offset : slots) {
+        offset = frame.reserve(TEMP_SIZE);
+    }
+    for (const auto& [value, slot] : allocation.slots) {
+        frame.place_in_slot(value, slots[slot], TEMP_SIZE);
+    }
+
+    // The body goes first, the frame is only known once every slot is allocated.
+    std::stringstream body;
+    Encoder body_code{ std::string(func.name.str()) };
+    raw_program.swap(body);
+    std::swap(code, body_code);
+    increase_depth();
     appendln("");
-    for (size_t i = 1; i < func.insts.size(); ++i) {
-        emit_instruction(func, func.insts[i]);
+    for (auto& block : func.blocks) {
+        for (auto& inst : block.insts) {
+            // The function label is emitted with the prologue.
+            if (&inst == &func.blocks.front().insts.front()) continue;
+            emit_instruction(func, inst);
+        }
+    }
+    decrease_depth();
+    raw_program.swap(body);
+    std::swap(code, body_code);
+
+    appendln(format("\n; FUNC {} START_IMPL", func.name.str()));
+    label(func.name.str());
+    increase_depth();
+    emit(Mnemonic::Push, AsmArg::gpr(Register::Rbp));
+    emit(Mnemonic::Mov, AsmArg::gpr(Register::Rbp), AsmArg::gpr(Register::Rsp));
+
+    if (size_t frame = stack.stack_size(); frame > 0) {
+        emit(Mnemonic::Sub, AsmArg::gpr(Register::Rsp), AsmArg::immediate(align_to(frame, 16)));
     }
+    for (const auto& [reg, offset] : saved) {
+        emit(Mnemonic::Mov, frame_slot(offset, 8), AsmArg::gpr(reg));
+    }
+    raw_program << body.str();
+    code.append(std::move(body_code));
 
     decrease_depth();
     appendln("");
-    appendln(format(".end_{}:", func.name));
+    label(format(".end_{}", func.name.str()));
     increase_depth();
-    appendln("mov rsp, rbp");
-    appendln("pop rbp");
-    appendln("ret");
+    for (const auto& [reg, offset] : saved) {
+        emit(Mnemonic::Mov, AsmArg::gpr(reg), frame_slot(offset, 8));
+    }
+    emit(Mnemonic::Mov, AsmArg::gpr(Register::Rsp), AsmArg::gpr(Register::Rbp));
+    emit(Mnemonic::Pop, AsmArg::gpr(Register::Rbp));
+    emit(Mnemonic::Ret);
 
     decrease_depth();
-    appendln(format("; FUNC {} END_IMPL", func.name));
+    appendln(format("; FUNC {} END_IMPL", func.name.str()));
 
     stack.exit_func();
 }
 
 void CodeGen::emit_header(IrProgram& program) {
     appendln("global _start");
+    code.global("_start");
     appendln("; #[extern(linkage)]");
     for (const auto& builtin : BUILTINS) {
         appendln(format("extern {}", builtin.ident));
+        code.global(builtin.ident);
     }
     appendln("");
 }
@@ -368,18 +443,43 @@ void CodeGen::emit_data_section(IrProgram&) {
     appendln("");
 }
 
-void CodeGen::emit_text_section(IrProgram& program) {
+void CodeGen::emit_text_section(IrProgram& program, WorkerPool& pool) {
     appendln("section .text");
-    appendln("_start:");
+    label("_start");
     increase_depth();
-    appendln("call main");
-    appendln("mov rax, 60 ; emit syscall: exit");
-    appendln("mov rdi, 0 ; exit code of 0 (success)");
-    appendln("syscall");
+    emit(Mnemonic::Call, AsmArg::label("main"));
+    // exit(0)
+    emit(Mnemonic::Mov, AsmArg::gpr(Register::Rax), AsmArg::immediate(60));
+    emit(Mnemonic::Mov, AsmArg::gpr(Register::Rdi), AsmArg::immediate(0));
+    emit(Mnemonic::Syscall);
     decrease_depth();
 
-    for (auto& fn : program.lowered_program) {
-        emit_function(fn);
-        argument_position = 0;
+    // Every function gets a generator and a buffer of its own,
+    // the buffers are joined in source order so the output matches a serial run.
+    struct Emitted {
+        std::string text;
+        Encoder code;
+        std::string logs;
+    };
+    auto& functions = program.lowered_program;
+    std::vector<Emitted> emitted(functions.size());
+
+    pool.run_checked(functions.size(), [&](size_t index, size_t) {
+        CodeGen generator;
+        generator.level = level;
+        generator.as_text = as_text;
+        generator.set_abi_registers();
+        generator.emit_function(functions[index]);
+        emitted[index] = Emitted{ 
+            generator.raw_program.str(), 
+            std::move(generator.code), 
+            std::move(generator.pending_logs) 
+        };
+    });
+
+    for (auto& fn : emitted) {
+        raw_program << fn.text;
+        code.append(std::move(fn.code));
+        std::fputs(fn.logs.c_str(), stdout);
     }
 }
\ No newline at end of file
@@ -3,266 +3,260 @@
 
 
 void CodeGen::emit_add(Instruction& inst) {
-    auto sym = inst.dst.value();
+    auto sym = inst.dst;
     stack.allocate(sym, TEMP_SIZE);
 
     auto& lhs = inst.parts.at(0);
     auto& rhs = inst.parts.at(1);
 
     // loads both sides.
-    load_operand(lhs, "rax", gain_symbol(lhs)); 
-    load_operand(rhs, "rbx", gain_symbol(rhs));
+    load_operand(lhs, Register::Rax); 
+    load_operand(rhs, Register::R11);
 
-    appendln("add rax, rbx");
-    appendln(format("mov qword [rbp - {}], rax", stack.offset(sym)));
+    emit(Mnemonic::Add, AsmArg::gpr(Register::Rax), AsmArg::gpr(Register::R11));
+    store_operand(sym, Register::Rax);
     appendln("");
 }
 
 void CodeGen::emit_sub(Instruction& inst) {
-    auto sym = inst.dst.value();
+    auto sym = inst.dst;
     stack.allocate(sym, TEMP_SIZE);
 
     auto& lhs = inst.parts.at(0);
     auto& rhs = inst.parts.at(1);
 
     // load both sides.
-    load_operand(lhs, "rax", gain_symbol(lhs)); 
-    load_operand(rhs, "rbx", gain_symbol(rhs));
+    load_operand(lhs, Register::Rax); 
+    load_operand(rhs, Register::R11);
 
-    appendln("sub rax, rbx");
-    appendln(format("mov qword [rbp - {}], rax", stack.offset(sym)));
+    emit(Mnemonic::Sub, AsmArg::gpr(Register::Rax), AsmArg::gpr(Register::R11));
+    store_operand(sym, Register::Rax);
     appendln("");
 }
 
 void CodeGen::emit_mul(Instruction& inst) {
-    auto sym = inst.dst.value();
+    auto sym = inst.dst;
     stack.allocate(sym, TEMP_SIZE);
 
     auto& lhs = inst.parts.at(0);
     auto& rhs = inst.parts.at(1);
 
     // load both sides.
-    load_operand(lhs, "rax", gain_symbol(lhs)); 
-    load_operand(rhs, "rbx", gain_symbol(rhs));
+    load_operand(lhs, Register::Rax); 
+    load_operand(rhs, Register::R11);
 
-    appendln("xor rdx, rdx");
-    appendln("imul rbx");
-    appendln(format("mov qword [rbp - {}], rax", stack.offset(sym)));
+    emit(Mnemonic::Xor, AsmArg::gpr(Register::Rdx), AsmArg::gpr(Register::Rdx));
+    emit(Mnemonic::Imul, AsmArg::gpr(Register::R11));
+    store_operand(sym, Register::Rax);
     appendln("");
 }
 
 void CodeGen::emit_div(Instruction& inst) {
-    auto sym = inst.dst.value();
+    auto sym = inst.dst;
     stack.allocate(sym, TEMP_SIZE);
 
     auto& lhs = inst.parts.at(0);
     auto& rhs = inst.parts.at(1);
 
     // load both sides.
-    load_operand(lhs, "rax", gain_symbol(lhs)); 
-    load_operand(rhs, "rbx", gain_symbol(rhs));
+    load_operand(lhs, Register::Rax); 
+    load_operand(rhs, Register::R11);
 
     appendln("; sign-extend rax. ");
-    appendln("cqo");
-    appendln("idiv rbx");
-    appendln(format("mov qword [rbp - {}], rax", stack.offset(sym)));
+    emit(Mnemonic::Cqo);
+    emit(Mnemonic::Idiv, AsmArg::gpr(Register::R11));
+    store_operand(sym, Register::Rax);
     appendln("");
 }
 
 void CodeGen::emit_mod(Instruction& inst) {
-    auto sym = inst.dst.value();
+    auto sym = inst.dst;
     stack.allocate(sym, TEMP_SIZE);
 
     auto& lhs = inst.parts.at(0);
     auto& rhs = inst.parts.at(1);
 
     // load both sides.
-    load_operand(lhs, "rax", gain_symbol(lhs)); 
-    load_operand(rhs, "rbx", gain_symbol(rhs));
+    load_operand(lhs, Register::Rax); 
+    load_operand(rhs, Register::R11);
     
     appendln("; sign-extend rax. ");
-    appendln("cqo");
-    appendln("idiv rbx");
-    appendln(format("mov qword [rbp - {}], rdx", stack.offset(sym)));
+    emit(Mnemonic::Cqo);
+    emit(Mnemonic::Idiv, AsmArg::gpr(Register::R11));
+    store_operand(sym, Register::Rdx);
     appendln("");
 }
 
 void CodeGen::emit_bitand(Instruction& inst) {
-    auto sym = inst.dst.value();
+    auto sym = inst.dst;
     stack.allocate(sym, TEMP_SIZE);
 
     auto& lhs = inst.parts.at(0);
     auto& rhs = inst.parts.at(1);
 
     // load both sides.
-    load_operand(lhs, "rax", gain_symbol(lhs)); 
-    load_operand(rhs, "rbx", gain_symbol(rhs));
+    load_operand(lhs, Register::Rax); 
+    load_operand(rhs, Register::R11);
 
-    appendln("and rax, rbx");
-    appendln(format("mov qword [rbp - {}], rax", stack.offset(sym)));
+    emit(Mnemonic::And, AsmArg::gpr(Register::Rax), AsmArg::gpr(Register::R11));
+    store_operand(sym, Register::Rax);
     appendln("");
 }
 
 void CodeGen::emit_bitor(Instruction& inst) {
-    auto sym = inst.dst.value();
+    auto sym = inst.dst;
     stack.allocate(sym, TEMP_SIZE);
 
     auto& lhs = inst.parts.at(0);
     auto& rhs = inst.parts.at(1);
 
     // load both sides.
-    load_operand(lhs, "rax", gain_symbol(lhs)); 
-    load_operand(rhs, "rbx", gain_symbol(rhs));
+    load_operand(lhs, Register::Rax); 
+    load_operand(rhs, Register::R11);
 
-    appendln("or rax, rbx");
-    appendln(format("mov qword [rbp - {}], rax", stack.offset(sym)));
+    emit(Mnemonic::Or, AsmArg::gpr(Register::Rax), AsmArg::gpr(Register::R11));
+    store_operand(sym, Register::Rax);
     appendln("");
 }
 
 void CodeGen::emit_bitxor(Instruction& inst) {
-    auto sym = inst.dst.value();
+    auto sym = inst.dst;
     stack.allocate(sym, TEMP_SIZE);
 
     auto& lhs = inst.parts.at(0);
     auto& rhs = inst.parts.at(1);
 
     // load both sides.
-    load_operand(lhs, "rax", gain_symbol(lhs)); 
-    load_operand(rhs, "rbx", gain_symbol(rhs));
+    load_operand(lhs, Register::Rax); 
+    load_operand(rhs, Register::R11);
 
-    appendln("xor rax, rbx");
-    appendln(format("mov qword [rbp - {}], rax", stack.offset(sym)));
+    emit(Mnemonic::Xor, AsmArg::gpr(Register::Rax), AsmArg::gpr(Register::R11));
+    store_operand(sym, Register::Rax);
     appendln("");
 }
 
 void CodeGen::emit_neg(Instruction& inst) {
-    auto sym = inst.dst.value();
+    auto sym = inst.dst;
     auto& lhs = inst.parts.at(0);
     stack.allocate(sym, TEMP_SIZE);
     
-    load_operand(lhs, "rax", gain_symbol(lhs)); 
-    appendln("neg rax");
-    appendln(format("mov qword [rbp - {}], rax", stack.offset(sym)));
+    load_operand(lhs, Register::Rax); 
+    emit(Mnemonic::Neg, AsmArg::gpr(Register::Rax));
+    store_operand(sym, Register::Rax);
     appendln("");
 }
 
 void CodeGen::emit_bitnot(Instruction& inst) {
-    auto sym = inst.dst.value();
+    auto sym = inst.dst;
     auto& lhs = inst.parts.at(0);
     stack.allocate(sym, TEMP_SIZE);
     
-    load_operand(lhs, "rax", gain_symbol(lhs)); 
-    appendln("not rax");
-    appendln(format("mov qword [rbp - {}], rax", stack.offset(sym)));
+    load_operand(lhs, Register::Rax); 
+    emit(Mnemonic::Not, AsmArg::gpr(Register::Rax));
+    store_operand(sym, Register::Rax);
     appendln("");
 }
 
 void CodeGen::emit_cmp(Instruction& inst) {
-    auto sym = inst.dst.value();
+    auto sym = inst.dst;
     stack.allocate(sym, TEMP_SIZE);
 
     auto& lhs = inst.parts.at(0);
     auto& rhs = inst.parts.at(1);
 
     // loads both sides.
-    load_operand(lhs, "rax", gain_symbol(lhs)); 
-    load_operand(rhs, "rbx", gain_symbol(rhs));
+    load_operand(lhs, Register::Rax); 
+    load_operand(rhs, Register::R11);
 
-    String set;
+    Mnemonic set;
     switch (inst.op)
     {
-        case OpCode::Eq:    set = "sete";  break; 
-        case OpCode::NotEq: set = "setne"; break; 
-        case OpCode::Lt:    set = "setl";  break; 
-        case OpCode::Le:    set = "setle"; break; 
-        case OpCode::Gt:    set = "setg";  break; 
-        case OpCode::Ge:    set = "setge"; break; 
+        case OpCode::Eq:    set = Mnemonic::Sete;  break; 
+        case OpCode::NotEq: set = Mnemonic::Setne; break; 
+        case OpCode::Lt:    set = Mnemonic::Setl;  break; 
+        case OpCode::Le:    set = Mnemonic::Setle; break; 
+        case OpCode::Gt:    set = Mnemonic::Setg;  break; 
+        case OpCode::Ge:    set = Mnemonic::Setge; break; 
         default:
             UNREACHABLE();
     }
 
-    appendln("cmp rax, rbx");
-    appendln(format("{} al", set));
-    appendln("movzx rax, al");
-
-    size_t memsize = stack.memsize(sym);
-    String nasm = format(
-        "mov {} [rbp - {}], rax",
-        mem_ident_from_size(memsize),
-        stack.offset(sym)
-    );
-    appendln(std::move(nasm));
+    emit(Mnemonic::Cmp, AsmArg::gpr(Register::Rax), AsmArg::gpr(Register::R11));
+    emit(set, AsmArg::gpr(Register::Rax, 1));
+    emit(Mnemonic::Movzx, AsmArg::gpr(Register::Rax), AsmArg::gpr(Register::Rax, 1));
+
+    store_operand(sym, Register::Rax);
     appendln("");
 }
 
 void CodeGen::emit_shift(Instruction& inst) {
-    auto sym = inst.dst.value();
+    auto sym = inst.dst;
     stack.allocate(sym, TEMP_SIZE);
 
     auto& lhs = inst.parts.at(0);
     auto& rhs = inst.parts.at(1);
 
     // load both sides.
-    load_operand(lhs, "rax", gain_symbol(lhs)); 
-    load_operand(rhs, "rcx", gain_symbol(rhs));
+    load_operand(lhs, Register::Rax); 
+    load_operand(rhs, Register::Rcx);
 
-    String op;
+    Mnemonic op;
     switch(inst.op)
     {
-        case OpCode::Shl: op = "shl"; break;
-        case OpCode::Shr: op = "sar"; break;
+        case OpCode::Shl: op = Mnemonic::Shl; break;
+        case OpCode::Shr: op = Mnemonic::Sar; break;
         default:
             UNREACHABLE();
     }
 
-    appendln(format("{} rax, cl", op));
-    appendln(format("mov qword [rbp - {}], rax", stack.offset(sym)));
+    emit(op, AsmArg::gpr(Register::Rax), AsmArg::gpr(Register::Rcx, 1));
+    store_operand(sym, Register::Rax);
     appendln("");
 }
 
 void CodeGen::emit_logical_binary_op(Instruction& inst) {
-    auto sym = inst.dst.value();
+    auto sym = inst.dst;
     stack.allocate(sym, TEMP_SIZE);
 
     auto& lhs = inst.parts.at(0);
     auto& rhs = inst.parts.at(1);
 
-    load_operand(lhs, "rax", gain_symbol(lhs)); 
-    load_operand(rhs, "rbx", gain_symbol(rhs));
+    load_operand(lhs, Register::Rax); 
+    load_operand(rhs, Register::R11);
 
-    String op;
+    Mnemonic op;
     switch(inst.op)
     {
-        case OpCode::And: op = "and"; break;
-        case OpCode::Or:  op = "or";  break;
+        case OpCode::And: op = Mnemonic::And; break;
+        case OpCode::Or:  op = Mnemonic::Or;  break;
         default:
             UNREACHABLE();
     }
 
-    appendln("cmp rax, 0");
-    appendln("setne al");        // set al = 1 if rax != 0
-    appendln("movzx rax, al");   // zero-extend al to full rax
+    emit(Mnemonic::Cmp, AsmArg::gpr(Register::Rax), AsmArg::immediate(0));
+    emit(Mnemonic::Setne, AsmArg::gpr(Register::Rax, 1));        // set al = 1 if rax != 0
+    emit(Mnemonic::Movzx, AsmArg::gpr(Register::Rax), AsmArg::gpr(Register::Rax, 1));   // zero-extend al to full rax
 
-    appendln("cmp rbx, 0");
-    appendln("setne bl");
-    appendln("movzx rbx, bl");
+    emit(Mnemonic::Cmp, AsmArg::gpr(Register::R11), AsmArg::immediate(0));
+    emit(Mnemonic::Setne, AsmArg::gpr(Register::R11, 1));
+    emit(Mnemonic::Movzx, AsmArg::gpr(Register::R11), AsmArg::gpr(Register::R11, 1));
 
-    appendln(format("{} rax, rbx", op));
-    appendln(format("mov qword [rbp - {}], rax", stack.offset(sym)));
+    emit(op, AsmArg::gpr(Register::Rax), AsmArg::gpr(Register::R11));
+    store_operand(sym, Register::Rax);
     appendln("");
 }
 
 void CodeGen::emit_logical_not(Instruction& inst) {
-    auto sym = inst.dst.value();
+    auto sym = inst.dst;
     stack.allocate(sym, TEMP_SIZE);
 
     auto& operand = inst.parts.at(0);
-    load_operand(operand, "rax", gain_symbol(operand));
+    load_operand(operand, Register::Rax);
 
-    appendln("cmp rax, 0");
-    appendln("sete al");         // al = (rax == 0) ? 1 : 0
-    appendln("movzx rax, al");   // zero-extend al to full rax
+    emit(Mnemonic::Cmp, AsmArg::gpr(Register::Rax), AsmArg::immediate(0));
+    emit(Mnemonic::Sete, AsmArg::gpr(Register::Rax, 1));         // al = (rax == 0) ? 1 : 0
+    emit(Mnemonic::Movzx, AsmArg::gpr(Register::Rax), AsmArg::gpr(Register::Rax, 1));   // zero-extend al to full rax
 
-    appendln(format("mov qword [rbp - {}], rax", stack.offset(sym)));
+    store_operand(sym, Register::Rax);
     appendln("");
 }
\ No newline at end of file
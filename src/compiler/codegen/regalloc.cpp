@@ -0,0 +1,599 @@
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <queue>
+#include <unordered_set>
+
+#include "regalloc.hpp"
+#include "builtins.hpp"
+
+namespace {
+
+using RegMask = uint32_t;
+
+constexpr RegMask bit(Register reg) {
+    return RegMask{ 1 } << static_cast<int>(reg);
+}
+
+// Survive calls into Wombat functions, each saves the ones it writes.
+CONST Register CALLEE_SAVED[] = { Register::Rbx, Register::R12, Register::R13, Register::R14, Register::R15 };
+// Only survive up to the next call, tried first as they cost no save.
+CONST Register CALLER_SAVED[] = { Register::R10, Register::R8, Register::R9, Register::Rsi, Register::Rdi };
+// Filled by 'push' and read by 'pop' as the first arguments, 'rdx' and 'rcx' are scratch anyway.
+CONST RegMask ARGUMENTS = bit(Register::Rdi) | bit(Register::Rsi) | bit(Register::R8) | bit(Register::R9);
+
+RegMask mask_of(std::span<const Register> regs) {
+    RegMask mask = 0;
+    for (Register reg : regs) mask |= bit(reg);
+    return mask;
+}
+
+// The registers an instruction overwrites on its own, between reading its operands and writing its result.
+RegMask clobbered_by(const Instruction& inst) {
+    switch (inst.op) {
+        case OpCode::Call:
+        {
+            // 'std.asm' does not preserve 'rbx'.
+            bool into_std = find_builtin(inst.parts.front().as_str()).has_value();
+            return mask_of(CALLER_SAVED) | (into_std ? bit(Register::Rbx) : 0);
+        }
+        case OpCode::Push:
+        case OpCode::Pop:
+            return ARGUMENTS;
+        default:
+            return 0;
+    }
+}
+
+/// @brief `Clobbers`
+/// Positions where registers are overwritten behind the allocator's back, grouped by what they overwrite.
+struct Clobbers {
+    std::vector<std::pair<RegMask, std::vector<uint32_t>>> kinds;
+
+    explicit Clobbers(const IrFn& fn) {
+        size_t n = 0;
+        for (const auto& block : fn.blocks) {
+            for (const auto& inst : block.insts) {
+                uint32_t at = liveness::def_position(n++);
+                RegMask mask = clobbered_by(inst);
+                if (mask == 0) continue;
+
+                auto kind = std::ranges::find(kinds, mask, &std::pair<RegMask, std::vector<uint32_t>>::first);
+                if (kind == kinds.end()) {
+                    kind = kinds.insert(kinds.end(), { mask, {} });
+                }
+                kind->second.push_back(at);
+            }
+        }
+    }
+
+    // Is there a position strictly inside the interval? Its own ends are fine: operands are read
+    // before a call or 'push' clobbers anything, and results are written after.
+    static bool inside(const std::vector<uint32_t>& positions, const liveness::Interval& interval) {
+        auto it = std::upper_bound(positions.begin(), positions.end(), interval.start);
+        return it != positions.end() && *it < interval.end;
+    }
+
+    // The registers the interval may not use.
+    RegMask forbidden(const liveness::Interval& interval) const {
+        RegMask mask = 0;
+        for (const auto& [clobbered, positions] : kinds) {
+            if (inside(positions, interval)) mask |= clobbered;
+        }
+        return mask;
+    }
+};
+
+
+// Packs the values without a register into as few slots as are live at once, the same greedy pass
+// that colors an interval graph optimally. A slot is free again after the last read of its value.
+void share_slots(const std::vector<liveness::Interval>& intervals, const liveness::Info& info, Allocation& allocation) {
+    std::vector<liveness::Interval> memory;
+    for (const auto& interval : intervals) {
+        if (!allocation.registers.contains(info.values[interval.value])) memory.push_back(interval);
+    }
+    std::sort(memory.begin(), memory.end(), [](const auto& lhs, const auto& rhs) {
+        return lhs.start != rhs.start ? lhs.start < rhs.start : lhs.value < rhs.value;
+    });
+
+    using Busy = std::pair<uint32_t, uint32_t>;
+    std::priority_queue<Busy, std::vector<Busy>, std::greater<Busy>> busy;
+    std::priority_queue<uint32_t, std::vector<uint32_t>, std::greater<uint32_t>> free;
+
+    for (const auto& interval : memory) {
+        while (!busy.empty() && busy.top().first < interval.start) {
+            free.push(busy.top().second);
+            busy.pop();
+        }
+
+        uint32_t slot = allocation.slot_count;
+        if (free.empty()) {
+            allocation.slot_count++;
+        } else {
+            slot = free.top();
+            free.pop();
+        }
+        allocation.slots[info.values[interval.value]] = slot;
+        busy.emplace(interval.end, slot);
+    }
+}
+
+// Every register an allocator hands out, in the order they are tried.
+CONST Register ALLOCATABLE[] = {
+    Register::R10, Register::R8, Register::R9, Register::Rsi, Register::Rdi,
+    Register::Rbx, Register::R12, Register::R13, Register::R14, Register::R15
+};
+CONST uint32_t K = std::size(ALLOCATABLE);
+
+/// @brief `Coloring`
+/// Iterated register coalescing, as George and Appel describe it.
+/// Nodes below `K` are the registers themselves, the rest are the values liveness tracks.
+/// A value that cannot be colored stays in memory, the emitters reach it through their scratch registers,
+/// so no code is rewritten and a single round is enough.
+struct Coloring {
+    enum class NodeState { Precolored, Initial, Simplify, Freeze, Spill, Spilled, Coalesced, Colored, Select };
+    enum class MoveState { Worklist, Active, Coalesced, Constrained, Frozen };
+
+    struct Move {
+        uint32_t dst;
+        uint32_t src;
+        MoveState state = MoveState::Worklist;
+    };
+
+    size_t nodes;
+    std::vector<NodeState> state;
+    std::vector<std::vector<uint32_t>> adj_list;
+    std::unordered_set<uint64_t> adj_set;
+    std::vector<uint32_t> degree;
+    std::vector<std::vector<uint32_t>> move_list;
+    std::vector<Move> moves;
+    std::vector<uint32_t> alias;
+    std::vector<uint32_t> color;
+    std::vector<double> cost;
+
+    // Entries are only valid while the node or move is still in the state of the list, stale ones are skipped.
+    std::vector<uint32_t> simplify_worklist;
+    std::vector<uint32_t> freeze_worklist;
+    std::vector<uint32_t> spill_worklist;
+    std::vector<uint32_t> worklist_moves;
+    std::vector<uint32_t> select_stack;
+
+    explicit Coloring(size_t values)
+        : nodes{K + values},
+          state(nodes, NodeState::Initial),
+          adj_list(nodes),
+          degree(nodes, 0),
+          move_list(nodes),
+          alias(nodes),
+          color(nodes, 0),
+          cost(nodes, 0) {
+        for (uint32_t reg = 0; reg < K; ++reg) {
+            state[reg] = NodeState::Precolored;
+            color[reg] = reg;
+            degree[reg] = std::numeric_limits<uint32_t>::max();
+        }
+        for (uint32_t node = 0; node < nodes; ++node) {
+            alias[node] = node;
+        }
+    }
+
+    static uint64_t edge(uint32_t u, uint32_t v) {
+        return (uint64_t{ std::min(u, v) } << 32) | std::max(u, v);
+    }
+
+    bool precolored(uint32_t node) const {
+        return state[node] == NodeState::Precolored;
+    }
+
+    bool interfere(uint32_t u, uint32_t v) const {
+        return adj_set.contains(edge(u, v));
+    }
+
+    void add_edge(uint32_t u, uint32_t v) {
+        if (u == v || !adj_set.insert(edge(u, v)).second) return;
+        for (auto [from, to] : { std::pair{ u, v }, std::pair{ v, u } }) {
+            if (precolored(from)) continue;
+            adj_list[from].push_back(to);
+            degree[from]++;
+        }
+    }
+
+    void add_move(uint32_t dst, uint32_t src) {
+        uint32_t index = static_cast<uint32_t>(moves.size());
+        moves.push_back(Move{ dst, src });
+        move_list[dst].push_back(index);
+        move_list[src].push_back(index);
+        worklist_moves.push_back(index);
+    }
+
+    // Neighbours still in the graph.
+    template<typename F>
+    void for_each_adjacent(uint32_t node, F&& fn) const {
+        for (uint32_t other : adj_list[node]) {
+            if (state[other] != NodeState::Select && state[other] != NodeState::Coalesced) fn(other);
+        }
+    }
+
+    template<typename F>
+    void for_each_node_move(uint32_t node, F&& fn) const {
+        for (uint32_t index : move_list[node]) {
+            MoveState move = moves[index].state;
+            if (move == MoveState::Active || move == MoveState::Worklist) fn(index);
+        }
+    }
+
+    bool move_related(uint32_t node) const {
+        bool related = false;
+        for_each_node_move(node, [&](uint32_t) { related = true; });
+        return related;
+    }
+
+    void push(uint32_t node, NodeState to) {
+        state[node] = to;
+        switch (to) {
+            case NodeState::Simplify: simplify_worklist.push_back(node); break;
+            case NodeState::Freeze:   freeze_worklist.push_back(node);   break;
+            case NodeState::Spill:    spill_worklist.push_back(node);    break;
+            case NodeState::Select:   select_stack.push_back(node);      break;
+            default: break;
+        }
+    }
+
+    // Next valid node of a worklist, if any.
+    Option<uint32_t> pop(std::vector<uint32_t>& worklist, NodeState expected) {
+        while (!worklist.empty()) {
+            uint32_t node = worklist.back();
+            worklist.pop_back();
+            if (state[node] == expected) return node;
+        }
+        return std::nullopt;
+    }
+
+    void make_worklists() {
+        for (uint32_t node = K; node < nodes; ++node) {
+            if (degree[node] >= K) {
+                push(node, NodeState::Spill);
+            } else if (move_related(node)) {
+                push(node, NodeState::Freeze);
+            } else {
+                push(node, NodeState::Simplify);
+            }
+        }
+    }
+
+    void enable_moves(uint32_t node) {
+        for_each_node_move(node, [&](uint32_t index) {
+            if (moves[index].state == MoveState::Active) {
+                moves[index].state = MoveState::Worklist;
+                worklist_moves.push_back(index);
+            }
+        });
+    }
+
+    void decrement_degree(uint32_t node) {
+        if (precolored(node)) return;
+
+        uint32_t before = degree[node]--;
+        if (before != K) return;
+
+        enable_moves(node);
+        for_each_adjacent(node, [&](uint32_t other) { enable_moves(other); });
+        if (state[node] == NodeState::Spill) {
+            push(node, move_related(node) ? NodeState::Freeze : NodeState::Simplify);
+        }
+    }
+
+    void simplify(uint32_t node) {
+        push(node, NodeState::Select);
+        for_each_adjacent(node, [&](uint32_t other) { decrement_degree(other); });
+    }
+
+    uint32_t get_alias(uint32_t node) const {
+        while (state[node] == NodeState::Coalesced) node = alias[node];
+        return node;
+    }
+
+    void add_worklist(uint32_t node) {
+        if (!precolored(node) && !move_related(node) && degree[node] < K && state[node] == NodeState::Freeze) {
+            push(node, NodeState::Simplify);
+        }
+    }
+
+    // George: merging into a register is safe when every neighbour of `node` is harmless to it.
+    bool ok(uint32_t node, uint32_t reg) const {
+        return degree[node] < K || precolored(node) || interfere(node, reg);
+    }
+
+    // Briggs: merging is safe when the result has fewer than K neighbours of significant degree.
+    bool conservative(uint32_t u, uint32_t v) const {
+        std::unordered_set<uint32_t> significant;
+        auto count = [&](uint32_t node) {
+            if (degree[node] >= K) significant.insert(node);
+        };
+        for_each_adjacent(u, count);
+        for_each_adjacent(v, count);
+        return significant.size() < K;
+    }
+
+    void combine(uint32_t u, uint32_t v) {
+        state[v] = NodeState::Coalesced;
+        alias[v] = u;
+        move_list[u].insert(move_list[u].end(), move_list[v].begin(), move_list[v].end());
+        cost[u] += cost[v];
+        enable_moves(v);
+
+        for_each_adjacent(v, [&](uint32_t other) {
+            add_edge(other, u);
+            decrement_degree(other);
+        });
+        if (degree[u] >= K && state[u] == NodeState::Freeze) {
+            push(u, NodeState::Spill);
+        }
+    }
+
+    void coalesce(uint32_t index) {
+        Move& move = moves[index];
+        uint32_t x = get_alias(move.dst), y = get_alias(move.src);
+        auto [u, v] = precolored(y) ? std::pair{ y, x } : std::pair{ x, y };
+
+        if (u == v) {
+            move.state = MoveState::Coalesced;
+            add_worklist(u);
+            return;
+        }
+        if (precolored(v) || interfere(u, v)) {
+            move.state = MoveState::Constrained;
+            add_worklist(u);
+            add_worklist(v);
+            return;
+        }
+
+        bool safe = false;
+        if (precolored(u)) {
+            safe = true;
+            for_each_adjacent(v, [&](uint32_t other) { safe = safe && ok(other, u); });
+        } else {
+            safe = conservative(u, v);
+        }
+
+        if (safe) {
+            move.state = MoveState::Coalesced;
+            combine(u, v);
+            add_worklist(u);
+        } else {
+            move.state = MoveState::Active;
+        }
+    }
+
+    void freeze_moves(uint32_t node) {
+        for_each_node_move(node, [&](uint32_t index) {
+            Move& move = moves[index];
+            uint32_t other = get_alias(move.src) == get_alias(node) ? get_alias(move.dst) : get_alias(move.src);
+            move.state = MoveState::Frozen;
+
+            if (state[other] == NodeState::Freeze && !move_related(other) && degree[other] < K) {
+                push(other, NodeState::Simplify);
+            }
+        });
+    }
+
+    // The cheapest node to keep in memory: fewest weighted uses for the neighbours it frees.
+    void select_spill() {
+        Option<uint32_t> best;
+        for (uint32_t node : spill_worklist) {
+            if (state[node] != NodeState::Spill) continue;
+            if (!best || cost[node] / degree[node] < cost[best.value()] / degree[best.value()]) best = node;
+        }
+        std::erase(spill_worklist, best.value());
+        push(best.value(), NodeState::Simplify);
+        freeze_moves(best.value());
+    }
+
+    bool has_moves() {
+        while (!worklist_moves.empty() && moves[worklist_moves.back()].state != MoveState::Worklist) {
+            worklist_moves.pop_back();
+        }
+        return !worklist_moves.empty();
+    }
+
+    void run() {
+        make_worklists();
+        while (true) {
+            if (auto node = pop(simplify_worklist, NodeState::Simplify)) {
+                simplify(node.value());
+            } else if (has_moves()) {
+                uint32_t index = worklist_moves.back();
+                worklist_moves.pop_back();
+                coalesce(index);
+            } else if (auto node = pop(freeze_worklist, NodeState::Freeze)) {
+                push(node.value(), NodeState::Simplify);
+                freeze_moves(node.value());
+            } else if (std::ranges::any_of(spill_worklist, [&](uint32_t node) { return state[node] == NodeState::Spill; })) {
+                select_spill();
+            } else {
+                break;
+            }
+        }
+        assign_colors();
+    }
+
+    void assign_colors() {
+        while (!select_stack.empty()) {
+            uint32_t node = select_stack.back();
+            select_stack.pop_back();
+
+            std::vector<bool> taken(K, false);
+            for (uint32_t other : adj_list[node]) {
+                uint32_t colored = get_alias(other);
+                if (state[colored] == NodeState::Colored || precolored(colored)) taken[color[colored]] = true;
+            }
+
+            auto free = std::ranges::find(taken, false);
+            if (free == taken.end()) {
+                state[node] = NodeState::Spilled;
+            } else {
+                state[node] = NodeState::Colored;
+                color[node] = static_cast<uint32_t>(free - taken.begin());
+            }
+        }
+    }
+
+    // The color of a value, through whatever it was coalesced into.
+    Option<Register> register_of(uint32_t node) const {
+        uint32_t colored = get_alias(node);
+        if (state[colored] != NodeState::Colored && !precolored(colored)) return std::nullopt;
+        return ALLOCATABLE[color[colored]];
+    }
+};
+
+// The copy an instruction performs between two values, if it is one.
+Option<std::pair<uint32_t, uint32_t>> as_move(const liveness::Info& info, const Instruction& inst) {
+    if (!inst.match_code(OpCode::Assign) && !inst.match_code(OpCode::Copy)) return std::nullopt;
+
+    auto dst = info.find(inst.dst);
+    auto src = info.find(inst.parts.front());
+    if (!dst || !src) return std::nullopt;
+    return std::pair{ dst.value(), src.value() };
+}
+
+} // namespace
+
+Allocation regalloc::linear_scan(const IrFn& fn) {
+    liveness::Info info = liveness::analyze(fn);
+    std::vector<liveness::Interval> intervals = liveness::intervals(fn, info);
+    Clobbers clobbers(fn);
+
+    std::sort(intervals.begin(), intervals.end(), [](const auto& lhs, const auto& rhs) {
+        return lhs.start != rhs.start ? lhs.start < rhs.start : lhs.value < rhs.value;
+    });
+
+    struct Active {
+        liveness::Interval interval;
+        Register reg;
+    };
+    std::vector<Active> active;
+    Allocation allocation;
+    RegMask free = mask_of(CALLEE_SAVED) | mask_of(CALLER_SAVED);
+    RegMask written = 0;
+
+    auto assign = [&](const liveness::Interval& interval, Register reg) {
+        allocation.registers[info.values[interval.value]] = reg;
+        active.push_back(Active{ interval, reg });
+        free &= ~bit(reg);
+        written |= bit(reg);
+    };
+
+    for (const auto& current : intervals) {
+        // A register is free again once its interval ended, a result may land where the last read was.
+        std::erase_if(active, [&](const Active& other) {
+            bool expired = other.interval.end < current.start;
+            if (expired) free |= bit(other.reg);
+            return expired;
+        });
+
+        RegMask allowed = ~clobbers.forbidden(current);
+        auto first_free = [&](std::span<const Register> regs) -> Option<Register> {
+            for (Register reg : regs) {
+                if (allowed & free & bit(reg)) return reg;
+            }
+            return std::nullopt;
+        };
+
+        Option<Register> reg = first_free(CALLER_SAVED);
+        if (!reg) {
+            reg = first_free(CALLEE_SAVED);
+        }
+        if (reg) {
+            assign(current, reg.value());
+            continue;
+        }
+
+        // Out of registers, the interval reaching furthest gives its own up if `current` can take it.
+        auto victim = active.end();
+        for (auto it = active.begin(); it != active.end(); ++it) {
+            if ((allowed & bit(it->reg)) == 0) continue;
+            if (victim == active.end() || it->interval.end > victim->interval.end) victim = it;
+        }
+
+        allocation.spilled++;
+        if (victim != active.end() && victim->interval.end > current.end) {
+            Register taken = victim->reg;
+            allocation.registers.erase(info.values[victim->interval.value]);
+            active.erase(victim);
+            free |= bit(taken);
+            assign(current, taken);
+        }
+    }
+
+    for (Register reg : CALLEE_SAVED) {
+        if (written & bit(reg)) allocation.saved.push_back(reg);
+    }
+    share_slots(intervals, info, allocation);
+    return allocation;
+}
+
+Allocation regalloc::graph_coloring(const IrFn& fn) {
+    liveness::Info info = liveness::analyze(fn);
+    Coloring graph(info.values.size());
+    auto node = [](uint32_t value) { return K + value; };
+
+    // Backwards through each block from what is live out of it.
+    for (const auto& block : fn.blocks) {
+        liveness::Bits live = info.live_out[block.id];
+        double weight = std::pow(10.0, static_cast<double>(std::min<size_t>(block.loop_depth, 8)));
+
+        for (auto inst = block.insts.rbegin(); inst != block.insts.rend(); ++inst) {
+            Option<uint32_t> def = liveness::defined(info, *inst);
+
+            // A copy does not make its ends interfere, they may share a register.
+            if (auto move = as_move(info, *inst)) {
+                live.reset(move->second);
+                graph.add_move(node(move->first), node(move->second));
+            }
+
+            if (def) {
+                live.reset(def.value());
+                live.for_each([&](size_t value) { graph.add_edge(node(def.value()), node(value)); });
+                graph.cost[node(def.value())] += weight;
+            }
+
+            // Values live across the instruction cannot sit in what it overwrites.
+            if (RegMask clobbered = clobbered_by(*inst)) {
+                for (uint32_t reg = 0; reg < K; ++reg) {
+                    if ((clobbered & bit(ALLOCATABLE[reg])) == 0) continue;
+                    live.for_each([&](size_t value) { graph.add_edge(reg, node(value)); });
+                }
+            }
+
+            liveness::for_each_use(info, *inst, [&](uint32_t value) {
+                live.set(value);
+                graph.cost[node(value)] += weight;
+            });
+        }
+    }
+
+    graph.run();
+
+    Allocation allocation;
+    RegMask written = 0;
+    for (uint32_t value = 0; value < info.values.size(); ++value) {
+        if (auto reg = graph.register_of(node(value))) {
+            allocation.registers[info.values[value]] = reg.value();
+            written |= bit(reg.value());
+        } else {
+            allocation.spilled++;
+        }
+    }
+    for (Register reg : CALLEE_SAVED) {
+        if (written & bit(reg)) allocation.saved.push_back(reg);
+    }
+    share_slots(liveness::intervals(fn, info), info, allocation);
+    return allocation;
+}
+
+Allocation regalloc::stack_only(const IrFn& fn) {
+    liveness::Info info = liveness::analyze(fn);
+    Allocation allocation;
+    share_slots(liveness::intervals(fn, info), info, allocation);
+    return allocation;
+}
@@ -0,0 +1,46 @@
+#ifndef REGALLOC_HPP_
+#define REGALLOC_HPP_
+
+#include "asm.hpp"
+#include "liveness.hpp"
+
+/// @brief `Allocation`
+/// Where the register allocator put the values of a function.
+/// Values without a register, and everything liveness does not track, live in `AsmStackFrame` slots.
+struct Allocation {
+    std::unordered_map<Operand, Register> registers;
+    // Callee-saved registers the function writes, in the order they are saved.
+    std::vector<Register> saved;
+    // Values that wanted a register but were left in memory.
+    size_t spilled = 0;
+    // The 8-byte slot of every other value liveness tracks, values never live at once share one.
+    std::unordered_map<Operand, uint32_t> slots;
+    uint32_t slot_count = 0;
+};
+
+/// @brief `regalloc`
+/// Register allocators over the live intervals of a function that left SSA form.
+/// `rax`, `r11`, `rcx` and `rdx` are never handed out, the emitters use them as scratch.
+/// Whatever does not get a register is packed into stack slots by the same intervals,
+/// so a frame holds as many of them as are ever live at once.
+namespace regalloc {
+
+// Linear scan, as Poletto and Sarkar describe it. Intervals are visited by their start and take
+// any register free for their whole length, when none is the interval ending last is spilled.
+// Intervals crossing a call only get the callee-saved `rbx`, `r12`-`r15`, and `rbx` not even those
+// when the call goes into `std.asm`, which does not preserve it.
+Allocation linear_scan(const IrFn& fn);
+
+// Iterated register coalescing, Chaitin and Briggs' graph coloring as George and Appel refine it.
+// Values interfere when one is defined where the other is live, and interfere with the registers
+// clobbered while they are live. Copies from 'assign' and 'copy' are coalesced when that keeps the
+// graph colorable, and the values left in memory are the ones with the fewest uses per neighbour,
+// each use weighing ten times more per loop it is nested in. Slower than `linear_scan`, better code.
+Allocation graph_coloring(const IrFn& fn);
+
+// No registers, every value lives in a slot. Used below `-O2`.
+Allocation stack_only(const IrFn& fn);
+
+} // namespace regalloc
+
+#endif // REGALLOC_HPP_
@@ -1,73 +1,51 @@
-#include <string>
-#include <vector>
-#include <memory>
-#include <sstream>
-#include <cctype>
-#include <stdexcept>
-#include <algorithm>
-#include <regex>
-
-#include "sym.hpp"
-
-SharedPtr<Type> parse_type(const std::string& raw_type) {
-    std::string trimmed = raw_type;
-    trimmed.erase(std::remove_if(trimmed.begin(), trimmed.end(), ::isspace), trimmed.end());
-
-    if (trimmed.starts_with("ptr<") && trimmed.ends_with('>')) {
-        std::string inner = trimmed.substr(4, trimmed.size() - 5);
-        return std::make_shared<PointerType>(PointerType{parse_type(inner)});
+#include <mutex>
+
+#include "builtins.hpp"
+
+Option<size_t> find_builtin(std::string_view name) {
+    auto it = std::lower_bound(
+        BUILTINS_BY_NAME.begin(), 
+        BUILTINS_BY_NAME.end(), 
+        name, 
+        [](size_t index, std::string_view key) { return BUILTINS[index].ident < key; }
+    );
+    if (it != BUILTINS_BY_NAME.end() && BUILTINS[*it].ident == name) {
+        return *it;
     }
-
-    if (trimmed == "int") return std::make_shared<PrimitiveType>(PrimitiveType{Primitive::Int});
-    if (trimmed == "char") return std::make_shared<PrimitiveType>(PrimitiveType{Primitive::Char});
-    if (trimmed == "bool") return std::make_shared<PrimitiveType>(PrimitiveType{Primitive::Boolean});
-    if (trimmed == "free") return std::make_shared<PrimitiveType>(PrimitiveType{Primitive::Free});
-    return nullptr;
+    return std::nullopt;
 }
 
-Option<SymFunction> sig_to_sym(const std::string& wombat_sig) {
-    std::string input = wombat_sig;
-    input.erase(std::remove(input.begin(), input.end(), '\n'), input.end());
-
-    std::regex pattern(R"(fn\s+([a-zA-Z0-9_<>\s]+)\s+([a-zA-Z_][a-zA-Z0-9_]*)\((.*)\);)");
-    std::smatch match;
-    if (!std::regex_match(input, match, pattern)) {
-        return std::nullopt;
-    }
-
-    std::string return_type_str = match[1].str();
-    std::string function_name = match[2].str();
-    std::string param_list_str = match[3].str();
-
-    SharedPtr<Type> return_type = parse_type(return_type_str);
-    if (!return_type) {
-        return std::nullopt;
+static TypeRef builtin_type(const BuiltinType& type) {
+    TypeRef resolved = primitive_type(type.prim);
+    for (uint8_t depth = 0; depth < type.ptr_depth; ++depth) {
+        resolved = pointer_type(resolved);
     }
+    return resolved;
+}
 
+SymFunction builtin_to_sym(const Builtin& builtin) {
     std::vector<Declaration::Parameter> params;
-    std::stringstream ss(param_list_str);
-    std::string token;
-    while (std::getline(ss, token, ',')) {
-        std::string param = token;
-        std::string trimmed = std::regex_replace(param, std::regex("^ +| +$|( ) +"), "$1");
-        if (trimmed.empty()) continue;
-
-        std::regex param_regex(R"((mut\s+)?([a-zA-Z_][a-zA-Z0-9_]*)\s*:\s*([a-zA-Z0-9_<>\s]+))");
-        std::smatch param_match;
-        if (!std::regex_match(trimmed, param_match, param_regex)) {
-            return std::nullopt;
-        }
-
-        bool is_mut = param_match[1].matched;
-        std::string name = param_match[2].str();
-        std::string type_str = param_match[3].str();
+    params.reserve(builtin.params.size());
 
+    for (const BuiltinParam& param : builtin.params) {
         params.emplace_back(Declaration::Parameter(
-            is_mut ? Mutability::Mutable : Mutability::Immutable,
-            Identifier{name},
-            parse_type(type_str)
+            Mutability{param.mut},
+            Identifier{param.ident},
+            builtin_type(param.type)
         ));
     }
 
-    return SymFunction{std::move(params), std::move(return_type)};
-}
\ No newline at end of file
+    return SymFunction{std::move(params), builtin_type(builtin.ret_type)};
+}
+
+SharedPtr<SymFunction> builtin_symbol(size_t index) {
+    ASSERT(index < BUILTIN_COUNT, "builtin index out of range.");
+
+    static std::array<std::once_flag, BUILTIN_COUNT> built;
+    static std::array<SharedPtr<SymFunction>, BUILTIN_COUNT> symbols;
+
+    std::call_once(built[index], [index] {
+        symbols[index] = std::make_shared<SymFunction>(builtin_to_sym(BUILTINS[index]));
+    });
+    return symbols[index];
+}
@@ -1,25 +1,78 @@
 #ifndef BUILTIN_HPP_
 #define BUILTIN_HPP_
 
-#include <string>
-#include <vector>
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <span>
+#include <string_view>
 
-struct Builtin {
-    std::string ident;
-    std::string signature;
+#include "sym.hpp"
+
+// A builtin type: a primitive behind `ptr_depth` pointers.
+struct BuiltinType {
+    Primitive prim;
+    uint8_t ptr_depth = 0;
+};
 
-    Builtin(std::string&& f, std::string&& s) 
-        : ident{std::move(f)}, signature{std::move(s)} {}
+struct BuiltinParam {
+    std::string_view ident;
+    BuiltinType type;
+    Mutability mut = Mutability::Immutable;
+};
+
+/// @brief `Builtin`
+/// A function provided by the standard library, described entirely at compile time.
+/// Its `SymFunction` is only built the first time a program refers to it.
+struct Builtin {
+    std::string_view ident;
+    BuiltinType ret_type;
+    std::span<const BuiltinParam> params;
 };
 
-const std::vector<Builtin> BUILTINS = {
-    Builtin{"putchar",  "fn free putchar(_1: char);"},
-    Builtin{"putnum",   "fn free putnum(_1: int);"},
-    Builtin{"quit",     "fn free quit(_1: int);"},
-    Builtin{"readnum",  "fn int readnum();"},
-    Builtin{"readchar",  "fn char readchar();"}
+namespace builtin_params {
+    CONST BuiltinParam PUTCHAR[] = { {"_1", {Primitive::Char}} };
+    CONST BuiltinParam PUTNUM[]  = { {"_1", {Primitive::Int}} };
+    CONST BuiltinParam QUIT[]    = { {"_1", {Primitive::Int}} };
+} // namespace builtin_params
+
+// In the order the standard library is linked.
+CONST Builtin BUILTINS[] = {
+    Builtin{"putchar",  {Primitive::Free}, builtin_params::PUTCHAR},
+    Builtin{"putnum",   {Primitive::Free}, builtin_params::PUTNUM},
+    Builtin{"quit",     {Primitive::Free}, builtin_params::QUIT},
+    Builtin{"readnum",  {Primitive::Int},  {}},
+    Builtin{"readchar", {Primitive::Char}, {}}
 };
 
-Option<SymFunction> sig_to_sym(const std::string& wombat_sig);
+CONST size_t BUILTIN_COUNT = std::size(BUILTINS);
+
+// Indices into `BUILTINS` sorted by name, for binary search.
+CONST std::array<size_t, BUILTIN_COUNT> BUILTINS_BY_NAME = [] {
+    std::array<size_t, BUILTIN_COUNT> order{};
+    for (size_t i = 0; i < BUILTIN_COUNT; ++i) {
+        order[i] = i;
+    }
+    std::sort(order.begin(), order.end(), [](size_t lhs, size_t rhs) {
+        return BUILTINS[lhs].ident < BUILTINS[rhs].ident;
+    });
+    return order;
+}();
+
+static_assert(
+    std::adjacent_find(BUILTINS_BY_NAME.begin(), BUILTINS_BY_NAME.end(), [](size_t lhs, size_t rhs) {
+        return BUILTINS[lhs].ident == BUILTINS[rhs].ident;
+    }) == BUILTINS_BY_NAME.end(),
+    "builtin names must be unique."
+);
+
+// Index of the builtin called `name` in `BUILTINS`.
+Option<size_t> find_builtin(std::string_view name);
+
+// The symbol describing `builtin`, its types are interned.
+SymFunction builtin_to_sym(const Builtin& builtin);
+
+// The shared symbol of `BUILTINS[index]`, built on first use. Safe to call from any thread.
+SharedPtr<SymFunction> builtin_symbol(size_t index);
 
-#endif // BUILTIN_HPP_
\ No newline at end of file
+#endif // BUILTIN_HPP_
@@ -5,72 +5,117 @@
 
 #include "env.hpp"
 #include "compiler.hpp"
+#include "encoder.hpp"
+#include "elf.hpp"
 
 void Compiler::lex(const BuildConfig& config) {
     ASSERT(config.src.has_value(), "File validation bypassed — source path is missing.");
 
-    Lexer lexer(config.src.value());
-    ctxt.program_tokens = lexer.lex_source();
+    ctxt.lexer = std::make_unique<Lexer>(config.src.value());
 
     if (config.print_tokens) {
+        // Printing needs every token up front.
+        ctxt.program_tokens = ctxt.lexer->lex_source();
         ctxt.program_tokens.dump();
+        log_if_debug(format("Lexer completed using {} scanning kernels. Diagnostic tokens captured if any.", scan::isa()));
+        return;
     }
 
-    log_if_debug("Lexer completed. Diagnostic tokens captured if any.");
+    ctxt.lexer->open_and_populate_cursor();
+    log_if_debug(format("Lexer ready using {} scanning kernels, tokens are lexed while parsing.", scan::isa()));
 }
 
 void Compiler::parse(const BuildConfig& config) {
-    ASSERT(ctxt.program_tokens.has_next(), "Cannot parse an empty token stream.");
+    if (!ctxt.program_tokens.tokens.empty()) {
+        ASSERT(ctxt.program_tokens.has_next(), "Cannot parse an empty token stream.");
 
-    Parser parser(ctxt.program_tokens);
-    parser.parse(ctxt.program_ast);
+        Parser parser(ctxt.program_tokens, ctxt.ast_arena);
+        parser.parse(ctxt.program_ast);
+    } else {
+        Parser parser(*ctxt.lexer, ctxt.ast_arena);
+        parser.parse(ctxt.program_ast);
+    }
 
     if (config.print_ast) {
         PPVisitor pp_visitor(std::cout);
         ctxt.program_ast.traverse(pp_visitor);
     }
 
-    log_if_debug("Parser completed. AST ready.");
+    auto arena = ctxt.ast_arena.stats();
+    log_if_debug(format(
+        "Parser completed. AST ready, {} nodes in {} arena bytes ({} reserved).",
+        arena.objects, arena.used_bytes, arena.reserved_bytes
+    ));
 }
 
 void Compiler::sema_analyze(const BuildConfig& config) {
     ASSERT(!ctxt.program_ast.functions.empty(), "Semantic analysis attempted on empty AST.");
 
-    SemanticVisitor sema;
-    sema.include_builtins();
+    auto& functions = ctxt.program_ast.functions;
 
-    for (auto& fn : ctxt.program_ast.functions) {
-        fn->analyze(sema);
+    // Every signature is known before any body is analyzed, so bodies only read the globals.
+    SemanticVisitor globals;
+    for (auto& fn : functions) {
+        globals.declare(*fn);
     }
 
-    log_if_debug("Semantic analysis completed.");
+    // Bodies are analyzed in parallel, each on its own scope chain.
+    pool->run_checked(functions.size(), [&](size_t index, size_t) {
+        SemanticVisitor sema(&globals.table);
+        sema.visit(*functions[index]);
+    });
+
+    log_if_debug(format(
+        "Semantic analysis completed on {} workers, {} distinct types interned.", 
+        pool->size(), 
+        TypeContext::global().size()
+    ));
 }
 
 void Compiler::lower_into_ir(const BuildConfig& config) {
     auto ir = std::make_unique<IrProgram>();
-    ir->gen(ctxt.program_ast);
+    ir->gen(ctxt.program_ast, *pool);
+    auto stats = ir->optimize(static_cast<OptLevel>(config.opt_level), *pool);
 
     if (config.print_ir) {
-        ir->src = config.src.value();
+        ir->src = artifact_path(config.src.value()).string();
         ir->dump();
     }
 
     ctxt.ir_program = std::move(ir);
-    log_if_debug("Lowered into intermediate representation.");
+    log_if_debug(format("Lowered into intermediate representation, optimized at -O{}.", config.opt_level));
+    if (config.opt_level > 0) {
+        log_if_debug(format("Folded {} constant instructions and {} branches.", stats.folded, stats.branches));
+        log_if_debug(format("Removed {} unreachable blocks and {} dead instructions.", stats.blocks_removed, stats.insts_removed));
+    }
 }
 
 void Compiler::generate_asm_code(const BuildConfig& config) {
+    ctxt.ir_program->leave_ssa(*pool);
+
+    // Only '-S' needs the text, otherwise the machine code is encoded straight away.
     CodeGen generator;
-    generator.assemble(*ctxt.ir_program);
+    generator.assemble(*ctxt.ir_program, *pool, static_cast<OptLevel>(config.opt_level), config.compile_and_assemble);
     ctxt.backend = std::move(generator);
 
     log_if_debug("Assembly code generation completed.");
+
+    // Codegen is the last stage that interns names.
+    auto stats = Interner::global().stats();
+    log_if_debug(format(
+        "Interned {} symbols ({} bytes) over {} lookups, {} bytes of duplicate names saved.",
+        stats.symbols,
+        stats.stored_bytes,
+        stats.lookups,
+        stats.bytes_saved
+    ));
 }
 
 void Compiler::compile_target(const BuildConfig& config) {
     ASSERT(config.src.has_value(), "No source file specified to compile.");
 
     verb = config.verb;
+    pool = std::make_unique<WorkerPool>(config.jobs > 0 ? config.jobs : WorkerPool::hardware_workers());
 
     lex(config);
     parse(config);
@@ -82,7 +127,7 @@ void Compiler::compile_target(const BuildConfig& config) {
 }
 
 Path Compiler::build_bin_dir(const BuildConfig& config) {
-    Path sourcePath(config.src.value());
+    Path sourcePath = artifact_path(config.src.value());
     Path binPath = sourcePath.parent_path() / BIN;
     fs::create_directories(binPath);
     return binPath;
@@ -99,54 +144,68 @@ std::pair<Path, std::ofstream> Compiler::create_asm_file(const Path& bin_dir, co
 
 void Compiler::build_project(const BuildConfig& config) {
     Path bin_dir = build_bin_dir(config);
-    auto [asm_file_path, asm_file] = create_asm_file(bin_dir, config.src.value());
+    auto [asm_file_path, asm_file] = create_asm_file(bin_dir, artifact_path(config.src.value()).string());
+
+    // '-S' only writes the assembly text.
+    if (config.compile_and_assemble) {
+        asm_file.open(asm_file_path);
+        ASSERT(asm_file.is_open(), "Failed to open assembly file for writing.");
 
-    asm_file.open(asm_file_path);
-    ASSERT(asm_file.is_open(), "Failed to open assembly file for writing.");
+        asm_file << ctxt.backend.get_raw_program();
+        asm_file.close();
+        log_if_verbose(format("Wrote assembly: {}", asm_file_path.string()));
+        return;
+    }
 
-    asm_file << ctxt.backend.get_raw_program();
-    asm_file.close();
+    std::vector<uint8_t> object = assemble_target();
 
     Path out_path = asm_file_path;
     out_path.replace_extension(OUT_EXTENSION);
 
     Path std_lib_path = fs::canonical(Path(__FILE__).parent_path().parent_path().parent_path() / "std" / "std.asm");
-    Path std_object_file = build_std_lib(std_lib_path);
-    Path executable_path = build_target_into_executable(std_object_file, asm_file_path, out_path);
+    std::vector<uint8_t> std_object = build_std_lib(std_lib_path);
+    Path executable_path = build_target_into_executable(std_object, object, out_path);
 
     if (config.run) {
         execute(executable_path);
     }
 }
 
-Path Compiler::build_std_lib(const Path& std_path) {
-    Path object_file = std_path;
-    object_file.replace_extension(".o");
+std::vector<uint8_t> Compiler::assemble_target() {
+    const ObjectCode& object = ctxt.backend.get_object_code();
+    log_if_debug(format(
+        "Encoded {} bytes of machine code, {} calls are left for the linker.",
+        object.text.size(),
+        object.relocations.size()
+    ));
+    return elf::relocatable(object);
+}
 
-    String cmd = format("nasm -f elf64 -o {} {}", object_file.string(), std_path.string());
-    log_if_verbose(format("Building stdlib: {}", cmd));
-    ASSERT(system(cmd.c_str()) == 0, format("[linker::err] Failed to assemble standard library: {}", cmd));
+std::vector<uint8_t> Compiler::build_std_lib(const Path& std_path) {
+    std::ifstream std_file(std_path);
+    ASSERT(std_file.is_open(), format("[linker::err] Failed to open standard library: {}", std_path.string()));
+    std::string source{ std::istreambuf_iterator<char>(std_file), std::istreambuf_iterator<char>() };
 
-    return object_file;
+    log_if_verbose(format("Building stdlib: {}", std_path.string()));
+    return elf::relocatable(Encoder().assemble(source));
 }
 
 Path Compiler::build_target_into_executable(
-    const Path& std_object_file, 
-    const Path& asm_file_path, 
+    const std::vector<uint8_t>& std_object, 
+    const std::vector<uint8_t>& object, 
     const Path& out_path
 ) {
-    Path objFile = asm_file_path;
-    objFile.replace_extension(".o");
+    log_if_verbose(format("Linking executable: {}", out_path.string()));
+    std::vector<uint8_t> executable = elf::link({ object, std_object });
 
-    String asmCmd = format("nasm -f elf64 -o {} {}", objFile.string(), asm_file_path.string());
-    log_if_verbose(format("Assembling program: {}", asmCmd));
-    ASSERT(system(asmCmd.c_str()) == 0, format("[linker::err] Failed to assemble target: {}", asmCmd));
+    std::ofstream out(out_path, std::ios::binary | std::ios::trunc);
+    ASSERT(out.is_open(), format("[linker::err] Failed to open executable for writing: {}", out_path.string()));
 
-    String linkCmd = format("ld -o {} {} {}", out_path.string(), objFile.string(), std_object_file.string());
-    log_if_verbose(format("Linking executable: {}", linkCmd));
-    ASSERT(system(linkCmd.c_str()) == 0, format("[linker::err] Linking failed: {}", linkCmd));
+    out.write(reinterpret_cast<const char*>(executable.data()), static_cast<std::streamsize>(executable.size()));
+    out.close();
+    ASSERT(out.good(), format("[linker::err] Failed to write executable: {}", out_path.string()));
 
-    fs::remove(objFile);
+    fs::permissions(out_path, fs::perms::owner_exec | fs::perms::group_exec | fs::perms::others_exec, fs::perm_options::add);
     return out_path;
 }
 
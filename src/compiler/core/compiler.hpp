@@ -4,22 +4,29 @@
 #include <filesystem>
 #include <fstream>
 #include "alias.hpp"
+#include "arena.hpp"
 #include "builder.hpp"
 #include "lex.hpp"
 #include "parser.hpp"
 #include "ast.hpp"
+#include "sema_visitor.hpp"
 #include "ir.hpp"
 #include "file.hpp"
 #include "gen.hpp"
 #include "diag.hpp"
+#include "pool.hpp"
 
 struct Context {
+    // Tokens are only stored when they have to be printed, otherwise the parser pulls them from the lexer.
+    Ptr<Lexer> lexer;
     LazyTokenStream program_tokens;
+    // Owns the memory of every AST node, so it must outlive `program_ast`.
+    Arena ast_arena;
     AST program_ast;
     Ptr<IrProgram> ir_program;
     CodeGen backend;
 
-    Context() : program_tokens(), program_ast(), ir_program(), backend() {}
+    Context() : lexer(), program_tokens(), ast_arena(), program_ast(), ir_program(), backend() {}
     ~Context() = default;
 };
 
@@ -28,10 +35,12 @@ public:
     Context ctxt;
     // CodeGen backend;
     Diagnostics diagnostics;
+    // Runs the per-function work of the stages that are parallel.
+    Ptr<WorkerPool> pool;
 
     static CONST int MAX_DIAG_CAPACITY = 10;
 
-    Compiler() : ctxt(), diagnostics(Compiler::MAX_DIAG_CAPACITY) {}
+    Compiler() : ctxt(), diagnostics(Compiler::MAX_DIAG_CAPACITY), pool() {}
     
     void compile_target(const BuildConfig& config);
     
@@ -49,10 +58,13 @@ private:
     void add_diagnostic(const Diagnostic& diag);
     void execute(Path& exe);
 
-    // Links the .asm file into an object file.
-    Path build_std_lib(const Path& std_path);
+    // Encodes `std.asm` in process into a relocatable ELF object, no 'nasm' involved.
+    std::vector<uint8_t> build_std_lib(const Path& std_path);
     Path build_bin_dir(const BuildConfig& config);
-    Path build_target_into_executable(const Path& std_object_file, const Path& asm_path, const Path& out_exe_path);
+    // Links the program with the standard library in process, no 'ld' involved.
+    Path build_target_into_executable(const std::vector<uint8_t>& std_object, const std::vector<uint8_t>& object, const Path& out_exe_path);
+    // The machine code of the program as a relocatable ELF object.
+    std::vector<uint8_t> assemble_target();
     std::pair<Path, std::ofstream> create_asm_file(const Path& bin_dir, const String& src);
 
     void log_if_debug(std::string&& info) {
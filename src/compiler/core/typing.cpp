@@ -15,4 +15,42 @@ Option<Primitive> maybe_primitive(const std::string& str) {
     if(str.compare("bool") == 0) return Primitive::Boolean;
     if(str.compare("free") == 0) return Primitive::Free;
     return std::nullopt;
-}
\ No newline at end of file
+}
+TypeContext::TypeContext() {
+    // Indexed by `Primitive`.
+    for (auto prim : { Primitive::Free, Primitive::Int, Primitive::Float, Primitive::Char, Primitive::Boolean }) {
+        m_primitives.emplace_back(new PrimitiveType(prim));
+    }
+}
+
+TypeContext& TypeContext::global() {
+    static TypeContext context;
+    return context;
+}
+
+template<typename T, typename... Args>
+TypeRef TypeContext::intern(Key key, Args&&... args) {
+    std::lock_guard lock(m_mutex);
+    if (auto it = m_derived.find(key); it != m_derived.end()) {
+        return it->second.get();
+    }
+    Ptr<Type> type{ new T(std::forward<Args>(args)...) };
+    TypeRef interned = type.get();
+    m_derived.emplace(key, std::move(type));
+    return interned;
+}
+
+TypeRef TypeContext::pointer_to(TypeRef underlying) {
+    ASSERT(underlying != nullptr, "cannot point to a missing type.");
+    return intern<PointerType>(Key{TypeFamily::Pointer, underlying, 0}, underlying);
+}
+
+TypeRef TypeContext::array_of(size_t size, TypeRef underlying) {
+    ASSERT(underlying != nullptr, "cannot build an array of a missing type.");
+    return intern<ArrayType>(Key{TypeFamily::Array, underlying, size}, size, underlying);
+}
+
+TypeRef TypeContext::slice_of(TypeRef underlying) {
+    ASSERT(underlying != nullptr, "cannot build a slice of a missing type.");
+    return intern<Slice>(Key{TypeFamily::Slice, underlying, 0}, underlying);
+}
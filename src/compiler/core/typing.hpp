@@ -4,6 +4,9 @@
 #include <stddef.h>
 #include <string>
 #include <format>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
 
 #include "alias.hpp"
 #include "common.hpp"
@@ -67,6 +70,11 @@ struct TypeHash {
     }
 };
 
+struct Type;
+
+// Types are interned by `TypeContext`, so two types are equal if and only if they are the same object.
+using TypeRef = const Type*;
+
 struct Type {
     TypeFamily fam;
     size_t ptr_level = 0;
@@ -79,25 +87,39 @@ struct Type {
     static CONST size_t FREE_SIZE   = 0;
 
     virtual ~Type() = default;
-    Type(TypeFamily family) : fam(family), ptr_level{0} {}
 
-    inline bool is_prim() { return fam == TypeFamily::Primitive; }
-    inline bool is_ptr() { return fam == TypeFamily::Pointer; }
-    inline bool is_arr() { return fam == TypeFamily::Array; }
+    Type(const Type&) = delete;
+    Type& operator=(const Type&) = delete;
+
+    inline bool is_prim() const { return fam == TypeFamily::Primitive; }
+    inline bool is_ptr() const { return fam == TypeFamily::Pointer; }
+    inline bool is_arr() const { return fam == TypeFamily::Array; }
 
     virtual std::string as_str() const = 0;
-    virtual TypeHash hash() const = 0;
-    virtual size_t wsizeof() const = 0;
+
+    // Both are computed once, when the type is interned.
+    inline TypeHash hash() const { return m_hash; }
+    inline size_t wsizeof() const { return m_size; }
+
+protected:
+    Type(TypeFamily family, TypeHash hash, size_t size) 
+        : fam(family), ptr_level{0}, m_hash{hash}, m_size{size} {}
+
+    static size_t hash_combine(size_t h, size_t value) {
+        return h * 31 + value;
+    }
+
+private:
+    TypeHash m_hash;
+    size_t m_size;
 };
 
-struct PrimitiveType : virtual public Type {
+struct PrimitiveType : public Type {
     Primitive type;
 
     ~PrimitiveType() override = default;
-    PrimitiveType(Primitive&& type)
-        : Type(TypeFamily::Primitive), type{std::move(type)} {}
 
-    inline bool cmp(Primitive&& prim) {
+    inline bool cmp(Primitive prim) const {
         return type == prim;
     }
 
@@ -114,14 +136,18 @@ struct PrimitiveType : virtual public Type {
         }
     }
 
-    TypeHash hash() const override {
-        size_t h = 17;
-        h = h * 31 + static_cast<size_t>(fam);
-        h = h * 31 + static_cast<size_t>(type);
-        return TypeHash{h};
-    }
+private:
+    friend class TypeContext;
+
+    PrimitiveType(Primitive type)
+        : Type(
+            TypeFamily::Primitive, 
+            hash_combine(hash_combine(17, static_cast<size_t>(TypeFamily::Primitive)), static_cast<size_t>(type)),
+            size_of(type)
+          ), 
+          type{type} {}
 
-    size_t wsizeof() const override {
+    static size_t size_of(Primitive type) {
         switch(type)
         {
             case Primitive::Int:     return Type::INT_SIZE;
@@ -131,75 +157,139 @@ struct PrimitiveType : virtual public Type {
             case Primitive::Free:    return Type::FREE_SIZE;
             default: return 0;
         }
-    } 
+    }
 };
 
-struct PointerType : virtual public Type {
-    SharedPtr<Type> underlying;
+struct PointerType : public Type {
+    TypeRef underlying;
 
     ~PointerType() override = default;
-    PointerType(SharedPtr<Type> type)
-        : Type(TypeFamily::Pointer), underlying(std::move(type)) {}
 
     std::string as_str() const override {
         return std::format("ptr<{}>", underlying->as_str());
     }
 
-    TypeHash hash() const override {
-        size_t h = 17;
-        h = h * 31 + static_cast<size_t>(fam);
-        h = h * 31 + underlying->hash().hash;
-        return TypeHash{h};
-    }
+private:
+    friend class TypeContext;
 
-    size_t wsizeof() const override {
-        return Type::PTR_SIZE;
-    } 
+    PointerType(TypeRef type)
+        : Type(
+            TypeFamily::Pointer, 
+            hash_combine(hash_combine(17, static_cast<size_t>(TypeFamily::Pointer)), type->hash().hash),
+            Type::PTR_SIZE
+          ), 
+          underlying(type) {}
 };
 
-struct ArrayType : virtual public Type {
+struct ArrayType : public Type {
     size_t size;
-    SharedPtr<Type> underlying;
+    TypeRef underlying;
 
     ~ArrayType() override = default;
-    ArrayType(size_t&& size, SharedPtr<Type>&& type)
-        : Type(TypeFamily::Array), size(std::move(size)), underlying(std::move(type)) {}
     
     std::string as_str() const override {
         return std::format("[{}]{}", size, underlying->as_str());
     }
 
-    TypeHash hash() const override {
-        size_t h = 17;
-        h = h * 31 + static_cast<size_t>(fam);
-        h = h * 31 + std::hash<size_t>{}(size);
-        h = h * 31 + underlying->hash().hash;
-        return TypeHash{h};
-    }
-
-    size_t wsizeof() const override {
-        return size * underlying->wsizeof();
-    } 
+private:
+    friend class TypeContext;
+
+    ArrayType(size_t size, TypeRef type)
+        : Type(
+            TypeFamily::Array,
+            hash_combine(
+                hash_combine(hash_combine(17, static_cast<size_t>(TypeFamily::Array)), std::hash<size_t>{}(size)),
+                type->hash().hash
+            ),
+            size * type->wsizeof()
+          ), 
+          size(size), 
+          underlying(type) {}
 };
 
-struct Slice : virtual public Type {
-    SharedPtr<Type> underlying;
+struct Slice : public Type {
+    TypeRef underlying;
 
     ~Slice() override = default;
-    Slice(SharedPtr<Type>&& type)
-        : Type(TypeFamily::Slice), underlying(std::move(type)) {}
     
     std::string as_str() const override {
         return std::format("slice<{}>", underlying->as_str());
     }
 
-    TypeHash hash() const override {
-        size_t h = 17;
-        h = h * 31 + static_cast<size_t>(fam);
-        h = h * 31 + underlying->hash().hash;
-        return TypeHash{h};
+private:
+    friend class TypeContext;
+
+    // A slice is a pointer and a length.
+    Slice(TypeRef type)
+        : Type(
+            TypeFamily::Slice,
+            hash_combine(hash_combine(17, static_cast<size_t>(TypeFamily::Slice)), type->hash().hash),
+            Type::PTR_SIZE + Type::INT_SIZE
+          ), 
+          underlying(type) {}
+};
+
+/// @brief `TypeContext`
+/// Owns every type the compiler refers to, each distinct type is created exactly once.
+/// Types are immutable and live for the lifetime of the program, so comparing types is comparing pointers
+/// and `hash`/`wsizeof` are plain loads.
+/// Interning derived types is serialized on a mutex, so the context is shared freely between sema workers.
+class TypeContext {
+public:
+    TypeContext(const TypeContext&) = delete;
+    TypeContext& operator=(const TypeContext&) = delete;
+
+    // The context shared by every stage of the compiler.
+    static TypeContext& global();
+
+    TypeRef primitive(Primitive prim) const {
+        return m_primitives[static_cast<size_t>(prim)].get();
+    }
+
+    TypeRef pointer_to(TypeRef underlying);
+    TypeRef array_of(size_t size, TypeRef underlying);
+    TypeRef slice_of(TypeRef underlying);
+
+    // Distinct types interned so far.
+    size_t size() const {
+        std::lock_guard lock(m_mutex);
+        return m_primitives.size() + m_derived.size();
     }
+
+private:
+    // Derived types are identified by their family, what they are made of, and an array size.
+    struct Key {
+        TypeFamily fam;
+        TypeRef underlying;
+        size_t size;
+
+        bool operator==(const Key& other) const = default;
+    };
+
+    struct KeyHash {
+        size_t operator()(const Key& key) const noexcept {
+            size_t h = std::hash<TypeRef>{}(key.underlying);
+            h = h * 31 + static_cast<size_t>(key.fam);
+            return h * 31 + key.size;
+        }
+    };
+
+    std::vector<Ptr<PrimitiveType>> m_primitives;
+    std::unordered_map<Key, Ptr<Type>, KeyHash> m_derived;
+    mutable std::mutex m_mutex;
+
+    TypeContext();
+
+    template<typename T, typename... Args>
+    TypeRef intern(Key key, Args&&... args);
 };
 
+inline TypeRef primitive_type(Primitive prim) {
+    return TypeContext::global().primitive(prim);
+}
+
+inline TypeRef pointer_type(TypeRef underlying) {
+    return TypeContext::global().pointer_to(underlying);
+}
 
 #endif // TYPING_HPP_
\ No newline at end of file
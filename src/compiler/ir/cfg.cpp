@@ -0,0 +1,314 @@
+#include <unordered_map>
+
+#include "cfg.hpp"
+
+void cfg::build(IrFn& fn, std::vector<Instruction>&& insts) {
+    ASSERT(
+        !insts.empty() && insts.front().match_code(OpCode::Label), 
+        "function must begin with a label."
+    );
+
+    fn.blocks.clear();
+    // Whether the last block was closed by a terminator, the next instruction opens a new one.
+    bool closed = true;
+
+    for (auto& inst : insts) {
+        bool label = inst.match_code(OpCode::Label);
+
+        // A label opens a block unless the current one is still empty.
+        if (closed || (label && !fn.blocks.back().insts.empty())) {
+            fn.blocks.emplace_back(static_cast<BlockId>(fn.blocks.size()));
+        }
+
+        closed = is_terminator(inst.op);
+        fn.blocks.back().insts.push_back(std::move(inst));
+    }
+
+    link(fn);
+    analyze(fn);
+}
+
+// Phi arguments are matched to predecessors by position, so they follow their edge through a relink.
+// `renumbered` maps the ids blocks had before the relink to their new ones.
+static void reorder_phi_args(
+    BasicBlock& block, 
+    const std::vector<BlockId>& old_preds, 
+    const std::unordered_map<BlockId, BlockId>& renumbered
+) {
+    std::vector<size_t> from(block.preds.size());
+    for (size_t index = 0; index < block.preds.size(); ++index) {
+        auto it = std::find_if(old_preds.begin(), old_preds.end(), [&](BlockId old) {
+            auto found = renumbered.find(old);
+            return found != renumbered.end() && found->second == block.preds[index];
+        });
+        ASSERT(it != old_preds.end(), "[cfg::err] a new edge leads into a block with phis.");
+        from[index] = static_cast<size_t>(it - old_preds.begin());
+    }
+
+    for (auto& phi : block.phis) {
+        std::vector<Operand> args;
+        args.reserve(from.size());
+        for (size_t index : from) {
+            args.push_back(phi.args[index]);
+        }
+        phi.args = std::move(args);
+    }
+}
+
+void cfg::link(IrFn& fn) {
+    bool has_phis = std::any_of(fn.blocks.begin(), fn.blocks.end(), [](const BasicBlock& block) {
+        return !block.phis.empty();
+    });
+    std::unordered_map<BlockId, BlockId> renumbered;
+    std::vector<std::vector<BlockId>> old_preds;
+
+    std::unordered_map<SymId, BlockId> by_label;
+    for (size_t index = 0; index < fn.blocks.size(); ++index) {
+        auto& block = fn.blocks[index];
+        if (has_phis) {
+            if (block.id != NO_BLOCK) renumbered.emplace(block.id, static_cast<BlockId>(index));
+            old_preds.push_back(std::move(block.preds));
+        }
+
+        block.id = static_cast<BlockId>(index);
+        block.preds.clear();
+        block.succs.clear();
+
+        if (auto label = block.label()) {
+            by_label.emplace(label.value(), block.id);
+        }
+    }
+
+    auto target_of = [&](const Operand& label) {
+        auto it = by_label.find(label.sym);
+        ASSERT(it != by_label.end(), format("[cfg::err] jump to an unknown label '{}'", label.as_str()));
+        return it->second;
+    };
+
+    auto add_edge = [&](BasicBlock& from, BlockId to) {
+        if (std::find(from.succs.begin(), from.succs.end(), to) == from.succs.end()) {
+            from.succs.push_back(to);
+            fn.blocks[to].preds.push_back(from.id);
+        }
+    };
+
+    for (auto& block : fn.blocks) {
+        BlockId next = block.id + 1 < fn.blocks.size() ? block.id + 1 : NO_BLOCK;
+        const Instruction* term = block.terminator();
+
+        if (term == nullptr) {
+            // Falling off the last block returns from the function.
+            if (next != NO_BLOCK) add_edge(block, next);
+            continue;
+        }
+
+        switch (term->op) {
+            case OpCode::Jmp:
+                add_edge(block, target_of(term->parts.front()));
+                break;
+            case OpCode::JmpFalse:
+            case OpCode::JmpTrue:
+                add_edge(block, target_of(term->parts.at(1)));
+                if (next != NO_BLOCK) add_edge(block, next);
+                break;
+            // Returns leave the function.
+            default:
+                break;
+        }
+    }
+
+    if (has_phis) {
+        for (auto& block : fn.blocks) {
+            if (!block.phis.empty()) reorder_phi_args(block, old_preds[block.id], renumbered);
+        }
+    }
+}
+
+std::vector<BlockId> cfg::reverse_postorder(const IrFn& fn) {
+    std::vector<BlockId> order;
+    if (fn.blocks.empty()) {
+        return order;
+    }
+
+    // Iterative DFS, each frame is a block and the index of the next successor to visit.
+    std::vector<bool> seen(fn.blocks.size(), false);
+    std::vector<std::pair<BlockId, size_t>> frames{ { 0, 0 } };
+    seen[0] = true;
+
+    while (!frames.empty()) {
+        auto& [block, next] = frames.back();
+        const auto& succs = fn.blocks[block].succs;
+
+        if (next < succs.size()) {
+            BlockId succ = succs[next++];
+            if (!seen[succ]) {
+                seen[succ] = true;
+                frames.push_back({ succ, 0 });
+            }
+        } else {
+            order.push_back(block);
+            frames.pop_back();
+        }
+    }
+
+    std::reverse(order.begin(), order.end());
+    return order;
+}
+
+bool cfg::dominates(const IrFn& fn, BlockId a, BlockId b) {
+    const BlockId entry = 0;
+    // Only the entry has no dominator among the reachable blocks.
+    if (b != entry && fn.blocks[b].idom == NO_BLOCK) {
+        return false;
+    }
+    while (b != a && b != entry) {
+        b = fn.blocks[b].idom;
+    }
+    return b == a;
+}
+
+std::vector<std::vector<BlockId>> cfg::dominance_frontiers(const IrFn& fn) {
+    std::vector<std::vector<BlockId>> frontiers(fn.blocks.size());
+    auto reachable = [&](BlockId block) {
+        return block == 0 || fn.blocks[block].idom != NO_BLOCK;
+    };
+
+    // Only joins are in a frontier, walk up from each predecessor until the join's immediate dominator.
+    for (const auto& join : fn.blocks) {
+        if (join.preds.size() < 2 || !reachable(join.id)) continue;
+
+        for (BlockId pred : join.preds) {
+            if (!reachable(pred)) continue;
+
+            for (BlockId runner = pred; runner != join.idom && runner != NO_BLOCK; runner = fn.blocks[runner].idom) {
+                auto& frontier = frontiers[runner];
+                if (frontier.empty() || frontier.back() != join.id) {
+                    frontier.push_back(join.id);
+                }
+            }
+        }
+    }
+    return frontiers;
+}
+
+// Cooper, Harvey and Kennedy, "A Simple, Fast Dominance Algorithm".
+static void compute_dominators(IrFn& fn, const std::vector<BlockId>& rpo) {
+    std::vector<size_t> order(fn.blocks.size(), std::numeric_limits<size_t>::max());
+    for (size_t index = 0; index < rpo.size(); ++index) {
+        order[rpo[index]] = index;
+    }
+
+    std::vector<BlockId> idom(fn.blocks.size(), NO_BLOCK);
+    idom[rpo.front()] = rpo.front();
+
+    auto intersect = [&](BlockId a, BlockId b) {
+        while (a != b) {
+            while (order[a] > order[b]) a = idom[a];
+            while (order[b] > order[a]) b = idom[b];
+        }
+        return a;
+    };
+
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (size_t index = 1; index < rpo.size(); ++index) {
+            BlockId block = rpo[index];
+            BlockId candidate = NO_BLOCK;
+
+            for (BlockId pred : fn.blocks[block].preds) {
+                if (idom[pred] == NO_BLOCK) continue;
+                candidate = candidate == NO_BLOCK ? pred : intersect(pred, candidate);
+            }
+            if (idom[block] != candidate) {
+                idom[block] = candidate;
+                changed = true;
+            }
+        }
+    }
+
+    for (auto& block : fn.blocks) {
+        block.idom = block.id == rpo.front() ? NO_BLOCK : idom[block.id];
+        block.dom_children.clear();
+    }
+    for (BlockId block : rpo) {
+        if (BlockId parent = fn.blocks[block].idom; parent != NO_BLOCK) {
+            fn.blocks[parent].dom_children.push_back(block);
+        }
+    }
+}
+
+// A back edge goes into a block that dominates its source, the loop is every block reaching the source
+// without passing through the header. Back edges into the same header make a single loop.
+static void find_loops(IrFn& fn, const std::vector<BlockId>& rpo) {
+    fn.loops.clear();
+    std::unordered_map<BlockId, size_t> by_header;
+
+    for (BlockId header : rpo) {
+        for (BlockId latch : fn.blocks[header].preds) {
+            if (!cfg::dominates(fn, header, latch)) continue;
+
+            auto [it, inserted] = by_header.emplace(header, fn.loops.size());
+            if (inserted) {
+                fn.loops.push_back(Loop{ header, { header } });
+            }
+            Loop& loop = fn.loops[it->second];
+
+            std::vector<BlockId> work;
+            auto add = [&](BlockId block) {
+                if (std::find(loop.blocks.begin(), loop.blocks.end(), block) == loop.blocks.end()) {
+                    loop.blocks.push_back(block);
+                    work.push_back(block);
+                }
+            };
+
+            add(latch);
+            while (!work.empty()) {
+                BlockId block = work.back();
+                work.pop_back();
+                for (BlockId pred : fn.blocks[block].preds) {
+                    if (fn.blocks[pred].idom != NO_BLOCK || pred == rpo.front()) add(pred);
+                }
+            }
+        }
+    }
+
+    for (auto& loop : fn.loops) {
+        std::sort(loop.blocks.begin(), loop.blocks.end());
+    }
+
+    // Headers are visited in reverse postorder, so an enclosing loop always comes first,
+    // and the innermost enclosing loop is the last one containing the header.
+    for (size_t index = 0; index < fn.loops.size(); ++index) {
+        Loop& loop = fn.loops[index];
+        for (size_t outer = index; outer-- > 0;) {
+            if (fn.loops[outer].contains(loop.header)) {
+                loop.parent = outer;
+                loop.depth = fn.loops[outer].depth + 1;
+                break;
+            }
+        }
+    }
+
+    for (auto& block : fn.blocks) {
+        block.loop = NO_LOOP;
+        block.loop_depth = 0;
+    }
+    for (size_t index = 0; index < fn.loops.size(); ++index) {
+        for (BlockId block : fn.loops[index].blocks) {
+            // Later loops are nested deeper.
+            fn.blocks[block].loop = index;
+            fn.blocks[block].loop_depth = fn.loops[index].depth;
+        }
+    }
+}
+
+void cfg::analyze(IrFn& fn) {
+    if (fn.blocks.empty()) {
+        return;
+    }
+
+    std::vector<BlockId> rpo = reverse_postorder(fn);
+    compute_dominators(fn, rpo);
+    find_loops(fn, rpo);
+}
@@ -0,0 +1,35 @@
+#ifndef CFG_HPP_
+#define CFG_HPP_
+
+#include <vector>
+#include "structs.hpp"
+
+/// @brief `cfg`
+/// Builds and analyzes the control-flow graph of an `IrFn`.
+/// Passes that add or remove blocks, or change where a block jumps, call `link` and then `analyze` again.
+namespace cfg {
+
+// Splits the lowered instructions of a function into basic blocks, links and analyzes them.
+void build(IrFn& fn, std::vector<Instruction>&& insts);
+
+// Recomputes predecessor and successor edges from the labels and terminators of the blocks.
+// Block ids are reassigned to match the layout order, blocks added since the last link use `NO_BLOCK`.
+// Phi arguments follow their edge, and are dropped with it.
+void link(IrFn& fn);
+
+// Dominator tree and loop nesting of the blocks, from the current edges.
+void analyze(IrFn& fn);
+
+// Blocks reachable from the entry, in reverse postorder.
+std::vector<BlockId> reverse_postorder(const IrFn& fn);
+
+// For each block, the blocks where its dominance ends: those it does not strictly dominate,
+// but dominates a predecessor of. Empty for unreachable blocks.
+std::vector<std::vector<BlockId>> dominance_frontiers(const IrFn& fn);
+
+// Does `a` dominate `b`? Every block dominates itself, unreachable blocks dominate nothing.
+bool dominates(const IrFn& fn, BlockId a, BlockId b);
+
+} // namespace cfg
+
+#endif // CFG_HPP_
@@ -0,0 +1,122 @@
+#include <unordered_map>
+#include <unordered_set>
+
+#include "cfg.hpp"
+#include "opt.hpp"
+
+namespace {
+
+// Does the instruction do nothing but define its temporary? Divisions may trap, so they only qualify
+// when the divisor is a constant that cannot make 'idiv' fault.
+bool is_pure(const Instruction& inst) {
+    if (!inst.dst.is(OpKind::Temp)) {
+        return false;
+    }
+
+    switch (inst.op) {
+        case OpCode::Call:
+            return false;
+        case OpCode::Div:
+        case OpCode::FlooredDiv:
+        case OpCode::Mod:
+        {
+            const Operand& divisor = inst.parts.at(1);
+            return divisor.is(OpKind::Lit) && divisor.imm != 0 && divisor.imm != -1;
+        }
+        default:
+            return true;
+    }
+}
+
+void remove_unreachable(IrFn& fn, opt::Stats& stats) {
+    size_t before = fn.blocks.size();
+    std::erase_if(fn.blocks, [&](const BasicBlock& block) {
+        bool unreachable = block.id != 0 && block.idom == NO_BLOCK;
+        if (unreachable) {
+            stats.insts_removed += block.insts.size() + block.phis.size();
+        }
+        return unreachable;
+    });
+
+    if (fn.blocks.size() != before) {
+        stats.blocks_removed += before - fn.blocks.size();
+        cfg::link(fn);
+        cfg::analyze(fn);
+    }
+}
+
+// Mark and sweep: whatever has an effect is live, and so is every temporary a live instruction reads.
+// Returns whether anything was removed, which may leave another local unread.
+bool sweep(IrFn& fn, opt::Stats& stats) {
+    // Locals read anywhere, by value or through their address.
+    std::unordered_set<SymId> read;
+    for (const auto& block : fn.blocks) {
+        for (const auto& inst : block.insts) {
+            if (!inst.reads_parts()) continue;
+            for (const auto& op : inst.parts) {
+                if (op.is(OpKind::Sym) || op.is(OpKind::Addr)) read.insert(op.sym);
+            }
+        }
+    }
+
+    auto dead_local = [&](const Instruction& inst) {
+        bool declares = inst.match_code(OpCode::Alloc) || inst.match_code(OpCode::Assign);
+        return declares && inst.dst.is(OpKind::Sym) && !read.contains(inst.dst.sym);
+    };
+
+    // What each pure instruction and phi reads, by the temporary it defines.
+    std::unordered_map<uint32_t, std::vector<Operand>> inputs;
+    std::unordered_set<uint32_t> live;
+    std::vector<uint32_t> work;
+
+    auto use = [&](const Operand& op) {
+        if (op.is(OpKind::Temp) && live.insert(op.temp).second) {
+            work.push_back(op.temp);
+        }
+    };
+
+    for (const auto& block : fn.blocks) {
+        for (const auto& phi : block.phis) {
+            inputs.emplace(phi.dst.temp, phi.args);
+        }
+        for (const auto& inst : block.insts) {
+            if (is_pure(inst)) {
+                inputs.emplace(inst.dst.temp, std::vector<Operand>(inst.parts.begin(), inst.parts.end()));
+            } else if (!dead_local(inst) && inst.reads_parts()) {
+                for (const auto& op : inst.parts) use(op);
+            }
+        }
+    }
+
+    while (!work.empty()) {
+        uint32_t temp = work.back();
+        work.pop_back();
+        if (auto it = inputs.find(temp); it != inputs.end()) {
+            for (const auto& op : it->second) use(op);
+        }
+    }
+
+    size_t removed = 0;
+    for (auto& block : fn.blocks) {
+        removed += std::erase_if(block.phis, [&](const Phi& phi) { return !live.contains(phi.dst.temp); });
+        removed += std::erase_if(block.insts, [&](const Instruction& inst) {
+            return dead_local(inst) || (is_pure(inst) && !live.contains(inst.dst.temp));
+        });
+
+        for (auto& inst : block.insts) {
+            if (inst.match_code(OpCode::Call) && inst.dst.is(OpKind::Temp) && !live.contains(inst.dst.temp)) {
+                inst.dst = Operand{};
+            }
+        }
+    }
+
+    stats.insts_removed += removed;
+    return removed > 0;
+}
+
+} // namespace
+
+void opt::eliminate_dead_code(IrFn& fn, Stats& stats) {
+    remove_unreachable(fn, stats);
+    while (sweep(fn, stats)) {}
+}
@@ -0,0 +1,307 @@
+#include <limits>
+#include <unordered_map>
+
+#include "cfg.hpp"
+#include "opt.hpp"
+
+namespace {
+
+// Floats keep their bits in the immediate, the emitted code never computes on them.
+bool is_constant(const Operand& op) {
+    return op.is(OpKind::Lit) && op.lit != LiteralKind::Float;
+}
+
+bool is_comparison(OpCode op) {
+    switch (op) {
+        case OpCode::Eq:
+        case OpCode::NotEq:
+        case OpCode::Lt:
+        case OpCode::Le:
+        case OpCode::Gt:
+        case OpCode::Ge:
+        case OpCode::And:
+        case OpCode::Or:
+        case OpCode::Not:
+            return true;
+        default:
+            return false;
+    }
+}
+
+// What `gen_math.cpp` leaves in rax, e.g 'idiv' truncates and shifts only look at 'cl & 63'.
+// Divisions that would trap are left for the program to run into.
+Option<int64_t> evaluate(OpCode op, int64_t lhs, int64_t rhs) {
+    // Wrapping arithmetic, as the machine does it.
+    uint64_t a = static_cast<uint64_t>(lhs), b = static_cast<uint64_t>(rhs);
+
+    switch (op) {
+        case OpCode::Add:    return static_cast<int64_t>(a + b);
+        case OpCode::Sub:    return static_cast<int64_t>(a - b);
+        case OpCode::Mul:    return static_cast<int64_t>(a * b);
+        case OpCode::Div:
+        case OpCode::Mod:
+        {
+            if (rhs == 0 || (lhs == std::numeric_limits<int64_t>::min() && rhs == -1)) {
+                return std::nullopt;
+            }
+            return op == OpCode::Div ? lhs / rhs : lhs % rhs;
+        }
+        case OpCode::BitAnd: return lhs & rhs;
+        case OpCode::BitOr:  return lhs | rhs;
+        case OpCode::BitXor: return lhs ^ rhs;
+        case OpCode::Shl:    return static_cast<int64_t>(a << (b & 63));
+        case OpCode::Shr:    return lhs >> (b & 63);
+        case OpCode::Eq:     return lhs == rhs;
+        case OpCode::NotEq:  return lhs != rhs;
+        case OpCode::Lt:     return lhs < rhs;
+        case OpCode::Le:     return lhs <= rhs;
+        case OpCode::Gt:     return lhs > rhs;
+        case OpCode::Ge:     return lhs >= rhs;
+        case OpCode::And:    return (lhs != 0) && (rhs != 0);
+        case OpCode::Or:     return (lhs != 0) || (rhs != 0);
+        default:
+            return std::nullopt;
+    }
+}
+
+Option<int64_t> evaluate(OpCode op, int64_t value) {
+    switch (op) {
+        case OpCode::Neg:    return static_cast<int64_t>(0 - static_cast<uint64_t>(value));
+        case OpCode::BitNot: return ~value;
+        case OpCode::Not:    return value == 0;
+        case OpCode::Copy:   return value;
+        default:
+            return std::nullopt;
+    }
+}
+
+/// @brief `Folding`
+/// The values found so far for temporaries and locals, every reader is rewritten to use them.
+struct Folding {
+    IrFn& fn;
+    opt::Stats& stats;
+    std::unordered_map<uint32_t, Operand> temps{};
+    std::unordered_map<SymId, Operand> locals{};
+
+    bool reachable(BlockId block) const {
+        return block == 0 || fn.blocks[block].idom != NO_BLOCK;
+    }
+
+    Operand substitute(Operand op) const {
+        while (op.is(OpKind::Temp)) {
+            auto it = temps.find(op.temp);
+            if (it == temps.end()) break;
+            op = it->second;
+        }
+        if (op.is(OpKind::Sym)) {
+            if (auto it = locals.find(op.sym); it != locals.end()) {
+                return it->second;
+            }
+        }
+        return op;
+    }
+
+    void substitute(Instruction& inst) const {
+        if (!inst.reads_parts()) return;
+        for (auto& op : inst.parts) {
+            op = substitute(op);
+        }
+    }
+
+    Option<Operand> fold(const Instruction& inst) const {
+        if (!inst.dst.is(OpKind::Temp) || inst.parts.empty()) {
+            return std::nullopt;
+        }
+        for (const auto& op : inst.parts) {
+            if (!is_constant(op)) return std::nullopt;
+        }
+
+        const Operand& lhs = inst.parts.front();
+        Option<int64_t> value = inst.parts.size() == 2
+            ? evaluate(inst.op, lhs.imm, inst.parts.at(1).imm)
+            : evaluate(inst.op, lhs.imm);
+        if (!value) {
+            return std::nullopt;
+        }
+        return Operand::literal(value.value(), is_comparison(inst.op) ? LiteralKind::Bool : lhs.lit);
+    }
+
+    // A phi is the value all of its executable edges agree on, if they do.
+    Option<Operand> fold(const BasicBlock& block, const Phi& phi) const {
+        Option<Operand> same;
+        for (size_t index = 0; index < phi.args.size(); ++index) {
+            if (!reachable(block.preds[index])) continue;
+
+            Operand arg = substitute(phi.args[index]);
+            if (arg == phi.dst || (same && arg == same.value())) continue;
+            if (same) return std::nullopt;
+            same = arg;
+        }
+        return same;
+    }
+
+    // Defining instructions come before their readers in reverse postorder, one sweep folds whole expressions.
+    bool evaluate_blocks() {
+        bool changed = false;
+        for (BlockId id : cfg::reverse_postorder(fn)) {
+            BasicBlock& block = fn.blocks[id];
+
+            std::erase_if(block.phis, [&](const Phi& phi) {
+                auto value = fold(block, phi);
+                if (value) {
+                    temps.emplace(phi.dst.temp, value.value());
+                    stats.folded++;
+                    changed = true;
+                }
+                return value.has_value();
+            });
+
+            size_t kept = 0;
+            for (auto& inst : block.insts) {
+                substitute(inst);
+                if (auto value = fold(inst)) {
+                    temps.emplace(inst.dst.temp, value.value());
+                    stats.folded++;
+                    changed = true;
+                    continue;
+                }
+                block.insts[kept++] = inst;
+            }
+            block.insts.erase(block.insts.begin() + kept, block.insts.end());
+        }
+        return changed;
+    }
+
+    // Locals left in memory that are assigned a constant once, before anything reads them.
+    // A 'let' binding is exactly that, the readers get the constant as a load from its slot would see it.
+    bool propagate_locals() {
+        struct Local {
+            size_t size = 0;
+            size_t assigns = 0;
+            bool eligible = true;
+            BlockId block = NO_BLOCK;
+            size_t index = 0;
+            Operand value{};
+        };
+        std::unordered_map<SymId, Local> found;
+
+        for (const auto& block : fn.blocks) {
+            for (size_t index = 0; index < block.insts.size(); ++index) {
+                const Instruction& inst = block.insts[index];
+                switch (inst.op) {
+                    case OpCode::Alloc:
+                        found[inst.dst.sym].size = inst.parts.front().imm;
+                        break;
+                    case OpCode::Pop:
+                        found[inst.dst.sym].eligible = false;
+                        break;
+                    case OpCode::Assign:
+                    {
+                        Local& local = found[inst.dst.sym];
+                        local.assigns++;
+                        local.block = block.id;
+                        local.index = index;
+                        local.value = inst.parts.front();
+                        break;
+                    }
+                    default:
+                        break;
+                }
+                for (const auto& op : inst.parts) {
+                    if (op.is(OpKind::Addr)) found[op.sym].eligible = false;
+                }
+            }
+        }
+
+        auto candidate = [&](const Operand& op) -> Local* {
+            if (!op.is(OpKind::Sym) || locals.contains(op.sym)) return nullptr;
+            auto it = found.find(op.sym);
+            if (it == found.end()) return nullptr;
+
+            Local& local = it->second;
+            bool constant = local.eligible && local.assigns == 1 && local.size > 0 && is_constant(local.value);
+            return constant ? &local : nullptr;
+        };
+
+        // Every read must come after the assignment, unreachable blocks never read anything.
+        for (const auto& block : fn.blocks) {
+            if (!reachable(block.id)) continue;
+            for (size_t index = 0; index < block.insts.size(); ++index) {
+                const Instruction& inst = block.insts[index];
+                if (!inst.reads_parts()) continue;
+
+                for (const auto& op : inst.parts) {
+                    Local* local = candidate(op);
+                    if (local == nullptr) continue;
+
+                    bool after = local->block == block.id ? index > local->index : cfg::dominates(fn, local->block, block.id);
+                    local->eligible = local->eligible && after;
+                }
+            }
+        }
+
+        bool changed = false;
+        for (auto& [name, local] : found) {
+            if (candidate(Operand::var(name)) == nullptr) continue;
+
+            int64_t value = local.value.imm;
+            if (local.size < sizeof(int64_t)) {
+                // Narrow slots are read back zero-extended.
+                value &= (int64_t{ 1 } << (local.size * 8)) - 1;
+            }
+            locals.emplace(name, Operand::literal(value, local.value.lit));
+            changed = true;
+        }
+        return changed;
+    }
+
+    void substitute_everywhere() {
+        for (auto& block : fn.blocks) {
+            for (auto& phi : block.phis) {
+                for (auto& arg : phi.args) {
+                    arg = substitute(arg);
+                }
+            }
+            for (auto& inst : block.insts) {
+                substitute(inst);
+            }
+        }
+    }
+
+    // A known condition either always jumps or never does.
+    bool fold_branches() {
+        bool changed = false;
+        for (auto& block : fn.blocks) {
+            const Instruction* term = block.terminator();
+            if (term == nullptr || !term->match_code(OpCode::JmpFalse) || !is_constant(term->parts.front())) continue;
+
+            Operand target = term->parts.at(1);
+            bool jumps = term->parts.front().imm == 0;
+            block.insts.pop_back();
+            if (jumps) {
+                block.insts.push_back(new_inst(OpCode::Jmp, Operand{}, { target }));
+            }
+            stats.branches++;
+            changed = true;
+        }
+        return changed;
+    }
+};
+
+} // namespace
+
+void opt::fold_constants(IrFn& fn, Stats& stats) {
+    Folding folding{ fn, stats };
+
+    for (bool changed = true; changed;) {
+        changed = folding.evaluate_blocks();
+        changed = folding.propagate_locals() || changed;
+        folding.substitute_everywhere();
+
+        if (folding.fold_branches()) {
+            cfg::link(fn);
+            cfg::analyze(fn);
+            changed = true;
+        }
+    }
+}
@@ -1,115 +1,109 @@
 #include "ir.hpp"
+#include "cfg.hpp"
+#include <bit>
+#include <charconv>
 #include <fstream>
 
 using LoweredBlock = IrProgram::LoweredBlock;
 
-void IrProgram::flatten_fn_call_from_stmt(LoweredBlock& block, Ptr<StmtNode>& fn_call) {
-    auto* call = dynamic_cast<FnCallNode*>(fn_call.get());
+void IrProgram::flatten_stmt(LoweredBlock& block, FnCallNode& call) {
 
     // Push all the arguments.
-    for(int cur = call->args.capacity() - 1; cur >= 0; --cur)
+    for(int cur = call.args.capacity() - 1; cur >= 0; --cur)
     {
-        auto& param = call->args.at(cur);
+        auto& param = call.args.at(cur);
 
         Instruction::Parts ops;
-        ops.push_back(flatten_expr(block, param));
+        ops.push_back(flatten_expr(block, *param));
 
-        block.push_back(new_inst(OpCode::Push, std::nullopt, std::move(ops)));
+        block.push_back(new_inst(OpCode::Push, Operand{}, std::move(ops)));
     }
 
     Instruction::Parts ops;
-    ops.push_back(new_var_op(call->ident.as_str()));
-    ops.push_back(new_lit_op(std::format("{}", call->args.capacity()), LiteralKind::Int));
+    ops.push_back(new_var_op(call.ident.id()));
+    ops.push_back(new_lit_op(call.args.capacity()));
 
     auto call_inst = new_inst(
         OpCode::Call, 
-        std::nullopt, 
+        Operand{}, 
         std::move(ops)
     );
     block.push_back(std::move(call_inst));
 }
 
-void IrProgram::flatten_ret_stmt(LoweredBlock& block, Ptr<StmtNode>& ret_stmt) {
-    auto* ret = dynamic_cast<ReturnNode*>(ret_stmt.get());
-
+void IrProgram::flatten_stmt(LoweredBlock& block, ReturnNode& ret) {
     Instruction::Parts ops;
-    if(ret->expr.get()) {
-        ops.push_back(flatten_expr(block, ret->expr));
-        cur_frame_size += ret->expr->sema_type->wsizeof();
+    if(ret.expr.get()) {
+        ops.push_back(flatten_expr(block, *ret.expr));
+        cur_frame_size += ret.expr->sema_type->wsizeof();
     }
 
-    ops.push_back(new_lbl_op(ret->fn.as_str()));
-    block.push_back(new_inst(OpCode::Ret, ret->fn.as_str(), std::move(ops)));
+    ops.push_back(new_lbl_op(ret.fn.id()));
+    block.push_back(new_inst(OpCode::Ret, new_lbl_op(ret.fn.id()), std::move(ops)));
 }
 
-void IrProgram::flatten_var_decl(LoweredBlock& block, Ptr<StmtNode>& var_decl) {
-    auto* var = dynamic_cast<VarDeclarationNode*>(var_decl.get());
-
+void IrProgram::flatten_stmt(LoweredBlock& block, VarDeclarationNode& var) {
     Instruction::Parts ops;
-    ops.push_back(new_lit_op(format("{}", var->info.type->wsizeof()), LiteralKind::Int));
+    ops.push_back(new_lit_op(var.info.type->wsizeof()));
 
     auto alloc = new_inst(
         OpCode::Alloc,
-        var->info.ident.as_str(),
+        new_var_op(var.info.ident.id()),
         std::move(ops)
     );
 
-    cur_frame_size += var->info.type->wsizeof();
+    cur_frame_size += var.info.type->wsizeof();
     block.push_back(std::move(alloc));
 
-    if(var->initialized()) {
+    if(var.initialized()) {
         Instruction::Parts ops;
-        ops.push_back(flatten_expr(block, var->init));
+        ops.push_back(flatten_expr(block, *var.init));
 
         block.push_back(new_inst(
             OpCode::Assign,
-            var->info.ident.as_str(),
+            new_var_op(var.info.ident.id()),
             std::move(ops)
         ));
     }
 }
 
-void IrProgram::flatten_assign(LoweredBlock& ctx, Ptr<StmtNode>& assign) {
-    auto* var = dynamic_cast<AssignmentNode*>(assign.get());
-
+void IrProgram::flatten_stmt(LoweredBlock& ctx, AssignmentNode& var) {
     Instruction::Parts ops;
-    ops.push_back(flatten_expr(ctx, var->rvalue));
+    ops.push_back(flatten_expr(ctx, *var.rvalue));
 
     ctx.push_back(new_inst(
         OpCode::Assign,
-        var->lvalue.as_str(),
+        new_var_op(var.lvalue.id()),
         std::move(ops)
     ));
 }
 
-void IrProgram::flatten_deref_assign(LoweredBlock& ctx, Ptr<StmtNode>& assign) {
-    auto* deref = dynamic_cast<DerefAssignmentNode*>(assign.get());
-
-    Ptr<Operand> address = flatten_expr_into_addr(ctx, deref->lvalue);
-    Ptr<Operand> value = flatten_expr(ctx, deref->rvalue);
+void IrProgram::flatten_stmt(LoweredBlock& ctx, DerefAssignmentNode& deref) {
+    Operand address = flatten_expr_into_addr(ctx, *deref.lvalue);
+    Operand value = flatten_expr(ctx, *deref.rvalue);
 
     Instruction::Parts ops;
-    ops.push_back(std::move(address));
-    ops.push_back(std::move(value));
+    ops.push_back(address);
+    ops.push_back(value);
 
     ctx.push_back(new_inst(
         OpCode::Store,
-        std::nullopt,
+        Operand{},
         std::move(ops)
     ));
 }
 
-void IrProgram::flatten_only_if(LoweredBlock& ctx, Ptr<Operand>& op, Ptr<BlockNode>& if_block) {
+void IrProgram::flatten_only_if(LoweredBlock& ctx, Operand op, BlockNode& if_block) {
     push_branch();
-    String after = gen_branch_label("after");
+    SymId after = gen_branch_label("after");
 
     Instruction::Parts false_jump_ops;
-    false_jump_ops.push_back(std::move(op));
+    false_jump_ops.push_back(op);
     false_jump_ops.push_back(new_lbl_op(after));
 
     ctx.push_back(new_inst(
         OpCode::JmpFalse, 
-        std::nullopt, 
+        Operand{}, 
         std::move(false_jump_ops)
     ));
 
@@ -119,28 +113,28 @@ void IrProgram::flatten_only_if(LoweredBlock& ctx, Ptr<Operand>& op, Ptr<BlockNo
 
     ctx.push_back(new_inst(
         OpCode::Label,
-        std::move(after),
+        new_lbl_op(after),
         {}
     ));
 }
 
 void IrProgram::flatten_if_and_else(
     LoweredBlock& ctx, 
-    Ptr<Operand>& op, 
-    Ptr<BlockNode>& if_block,
-    Ptr<BlockNode>& else_block
+    Operand op, 
+    BlockNode& if_block,
+    BlockNode& else_block
 ) {
     push_branch();
-    String else_label = gen_branch_label("else"), end_label = gen_branch_label("end");
+    SymId else_label = gen_branch_label("else"), end_label = gen_branch_label("end");
 
     // JmpFalse to else_label if condition fails
     Instruction::Parts cond_jump_ops;
-    cond_jump_ops.push_back(std::move(op));
+    cond_jump_ops.push_back(op);
     cond_jump_ops.push_back(new_lbl_op(else_label));
 
     ctx.push_back(new_inst(
         OpCode::JmpFalse,
-        std::nullopt,
+        Operand{},
         std::move(cond_jump_ops)
     ));
 
@@ -154,12 +148,12 @@ void IrProgram::flatten_if_and_else(
 
     ctx.push_back(new_inst(
         OpCode::Jmp,
-        std::nullopt,
+        Operand{},
         std::move(end_jump_ops)
     ));
     ctx.push_back(new_inst(
         OpCode::Label,
-        std::move(else_label),
+        new_lbl_op(else_label),
         {}
     ));
 
@@ -169,47 +163,45 @@ void IrProgram::flatten_if_and_else(
 
     ctx.push_back(new_inst(
         OpCode::Label,
-        std::move(end_label),
+        new_lbl_op(end_label),
         {}
     ));
 }
 
-void IrProgram::flatten_branch(LoweredBlock& ctx, Ptr<StmtNode>& stmt) {
-    auto* branch = dynamic_cast<IfNode*>(stmt.get());
-    auto op = flatten_expr(ctx, branch->condition);
+void IrProgram::flatten_stmt(LoweredBlock& ctx, IfNode& branch) {
+    auto op = flatten_expr(ctx, *branch.condition);
 
-    if(branch->else_block == nullptr) {
-        flatten_only_if(ctx, op, branch->if_block);
+    if(branch.else_block == nullptr) {
+        flatten_only_if(ctx, op, *branch.if_block);
     } else {
-        flatten_if_and_else(ctx, op, branch->if_block, branch->else_block);
+        flatten_if_and_else(ctx, op, *branch.if_block, *branch.else_block);
     }
 }
 
-void IrProgram::flatten_loop_stmt(LoweredBlock& ctx, Ptr<StmtNode>& stmt) {
-    auto* loop = dynamic_cast<LoopNode*>(stmt.get());
-
+void IrProgram::flatten_stmt(LoweredBlock& ctx, LoopNode& loop) {
     push_loop();
     auto loop_labels = loop_stack.back();
 
     // Emit the start label
-    ctx.push_back(new_inst(OpCode::Label, loop_labels.cnt, {}));
+    ctx.push_back(new_inst(OpCode::Label, new_lbl_op(loop_labels.cnt), {}));
 
     // Flatten the loop block body
-    for (auto& inst : flatten_block(loop->body)) {
+    for (auto& inst : flatten_block(*loop.body)) {
         ctx.push_back(std::move(inst));
     }
 
     // Jump back to start of loop
     Instruction::Parts ops;
     ops.push_back(new_lbl_op(loop_labels.cnt));
-    ctx.push_back(new_inst(OpCode::Jmp, std::nullopt, std::move(ops)));
+    ctx.push_back(new_inst(OpCode::Jmp, Operand{}, std::move(ops)));
 
     // Emit the end label (where `break` jumps to)
-    ctx.push_back(new_inst(OpCode::Label, loop_labels.brk, {}));
+    ctx.push_back(new_inst(OpCode::Label, new_lbl_op(loop_labels.brk), {}));
     pop_loop();
 }
 
-void IrProgram::flatten_brk_stmt(LoweredBlock& ctx, Ptr<StmtNode>& break_stmt) {
+void IrProgram::flatten_stmt(LoweredBlock& ctx, BreakNode& brk) {
+
     if(loop_stack.empty()) {
         ASSERT(false, "cannot break out a nonexistent loop.");
     } else {
@@ -217,59 +209,52 @@ void IrProgram::flatten_brk_stmt(LoweredBlock& ctx, Ptr<StmtNode>& break_stmt) {
         ops.push_back(new_lbl_op(loop_stack.back().brk));
         ctx.push_back(new_inst(
             OpCode::Jmp,
-            std::nullopt,
+            Operand{},
             std::move(ops)
         ));
     }
 }
 
-LoweredBlock IrProgram::flatten_block(Ptr<BlockNode>& block) {
+LoweredBlock IrProgram::flatten_block(BlockNode& block) {
     LoweredBlock body;
-    body.reserve(block->children.capacity());
+    body.reserve(block.children.capacity());
 
-    for(auto& child : block->children)
-    {
-        switch(child->id) 
-        {
-            case NodeId::VarDecl: flatten_var_decl(body, child);          break;
-            case NodeId::Assign: flatten_assign(body, child);             break;
-            case NodeId::DerefAssign: flatten_deref_assign(body, child);  break;
-            case NodeId::If: flatten_branch(body, child);                 break;
-            case NodeId::FnCall: flatten_fn_call_from_stmt(body, child);  break;
-            case NodeId::Return: flatten_ret_stmt(body, child);           break;
-            case NodeId::Loop: flatten_loop_stmt(body, child);            break;
-            case NodeId::Break: flatten_brk_stmt(body, child);            break;
-            default: {
-                ASSERT(
-                    false,
-                    format("cannot generate ir code from {}", child->id_str())
-                );
-            }
-        }
+    for(auto& child : block.children) {
+        visit_node(*child, [&](auto& stmt) { flatten_stmt(body, stmt); });
     }
 
     return std::move(body);
 }
 
-Ptr<Operand> IrProgram::flatten_lit_expr(Ptr<ExprNode>& expr) {
-    auto* lit = dynamic_cast<LiteralNode*>(expr.get());
-
-    String buff{""};
-    switch(lit->kind) {
+Operand IrProgram::flatten_expr(LoweredBlock& ctx, LiteralNode& lit) {
+    int64_t value = 0;
+    switch(lit.kind) {
         case LiteralKind::Int:
+        {
+            auto [end, ec] = std::from_chars(lit.str.data(), lit.str.data() + lit.str.size(), value);
+            ASSERT(
+                ec == std::errc{} && end == lit.str.data() + lit.str.size(), 
+                format("integer literal '{}' does not fit in 64 bits", lit.str)
+            );
+            break;
+        }
         case LiteralKind::Float:
         {
-            buff = std::move(lit->str);
+            // Kept bit for bit, floats are carried through the immediate.
+            double real = 0;
+            auto [end, ec] = std::from_chars(lit.str.data(), lit.str.data() + lit.str.size(), real);
+            ASSERT(ec == std::errc{}, format("invalid float literal: '{}'", lit.str));
+            value = std::bit_cast<int64_t>(real);
             break;
         }
         case LiteralKind::Char:
         {   
             char inner;
-            if(lit->str.size() == 1) {
+            if(lit.str.size() == 1) {
                 // simple char like 'a'
-                inner = lit->str[0];
-            } else if(lit->str.size() == 2 && lit->str[0] == '\\') {
-                switch (lit->str[1]) {
+                inner = lit.str[0];
+            } else if(lit.str.size() == 2 && lit.str[0] == '\\') {
+                switch (lit.str[1]) {
                     case 'n': inner = '\n'; break;
                     case 't': inner = '\t'; break;
                     case 'r': inner = '\r'; break;
@@ -278,44 +263,42 @@ Ptr<Operand> IrProgram::flatten_lit_expr(Ptr<ExprNode>& expr) {
                     case '\'': inner = '\''; break;
                     case '\"': inner = '\"'; break;
                     default:
-                        ASSERT(false, format("unsupported escape sequence '\\{}'", lit->str[1]));
+                        ASSERT(false, format("unsupported escape sequence '\\{}'", lit.str[1]));
                 }
             } else {
-                ASSERT(false, format("invalid char literal format: '{}'", lit->str));
+                ASSERT(false, format("invalid char literal format: '{}'", lit.str));
             }
 
-            buff = std::to_string(static_cast<int>(inner));
+            value = static_cast<int>(inner);
             break;
         }
         case LiteralKind::Bool: 
         {
-            if(lit->str.compare("false") == 0) {
-                buff = "0";
+            if(lit.str.compare("false") == 0) {
+                value = 0;
             }
-            else if(lit->str.compare("true") == 0) {
-                buff = "1";
+            else if(lit.str.compare("true") == 0) {
+                value = 1;
             }
             else 
                 UNREACHABLE();
             break;
         }
         default: 
-            ASSERT(false, format("unreachable literal kind {}", lit_kind_str(lit->kind)));
+            ASSERT(false, format("unreachable literal kind {}", lit_kind_str(lit.kind)));
     }
 
-    auto operand = new_lit_op(std::move(buff), std::move(lit->kind));
-    return std::move(operand);
+    return new_lit_op(value, lit.kind);
 }
 
-Ptr<Operand> IrProgram::flatten_bin_expr(LoweredBlock& ctx, Ptr<ExprNode>& expr) {
-    auto* bin = dynamic_cast<BinOpNode*>(expr.get());
-    auto lhs = flatten_expr(ctx, bin->lhs);
-    auto rhs = flatten_expr(ctx, bin->rhs);
+Operand IrProgram::flatten_expr(LoweredBlock& ctx, BinOpNode& bin) {
+    auto lhs = flatten_expr(ctx, *bin.lhs);
+    auto rhs = flatten_expr(ctx, *bin.rhs);
 
-    cur_frame_size += bin->sema_type->wsizeof();
+    cur_frame_size += bin.sema_type->wsizeof();
 
     // A temporary to hold the result.
-    Ptr<TempOp> temp = new_tmp_op(push_temp());
+    Operand temp = new_tmp_op(push_temp());
 
     Instruction::Parts ops;
     ops.push_back(std::move(lhs));
@@ -323,159 +306,178 @@ Ptr<Operand> IrProgram::flatten_bin_expr(LoweredBlock& ctx, Ptr<ExprNode>& expr)
 
     // Push a new instruction into the current block.
     auto inst = new_inst(
-        ir_op_from_bin(bin->op),
-        temp->as_str(),
+        ir_op_from_bin(bin.op),
+        temp,
         std::move(ops)
     );
     ctx.push_back(std::move(inst));
 
-    return std::move(temp);
+    return temp;
 }
 
-Ptr<Operand> IrProgram::flatten_un_expr(LoweredBlock& ctx, Ptr<ExprNode>& expr) {
-    auto* un = dynamic_cast<UnaryOpNode*>(expr.get());
-
+Operand IrProgram::flatten_expr(LoweredBlock& ctx, UnaryOpNode& un) {
     // Handle special unary operations.
-    if(un->op == UnOpKind::AddrOf) {
-        ASSERT(un->lhs->id == NodeId::Term, "unreachable case: address of non-terminal node.");
-        auto* term = dynamic_cast<VarTerminalNode*>(un->lhs.get());
-        return new_addr_op(term->ident.as_str());
+    if(un.op == UnOpKind::AddrOf) {
+        ASSERT(un.lhs->id == NodeId::Term, "unreachable case: address of non-terminal node.");
+        auto& term = static_cast<VarTerminalNode&>(*un.lhs);
+        return new_addr_op(term.ident.id());
     }
 
-    auto lhs = flatten_expr(ctx, un->lhs);
-    cur_frame_size += un->sema_type->wsizeof();
+    auto lhs = flatten_expr(ctx, *un.lhs);
+    cur_frame_size += un.sema_type->wsizeof();
 
     // A temporary to hold the result.
-    Ptr<TempOp> temp = new_tmp_op(push_temp());
+    Operand temp = new_tmp_op(push_temp());
 
     Instruction::Parts ops;
     ops.push_back(std::move(lhs));
 
     // Push a new instruction into the current block.
     auto inst = new_inst(
-        ir_op_from_un(un->op),
-        temp->as_str(),
+        ir_op_from_un(un.op),
+        temp,
         std::move(ops)
     );
     ctx.push_back(std::move(inst));
 
-    return std::move(temp);
+    return temp;
 }
 
-Ptr<Operand> IrProgram::flatten_fn_call_from_expr(LoweredBlock& ctx, Ptr<ExprNode>& expr) {
-    auto* call = dynamic_cast<FnCallNode*>(expr.get());
-
+Operand IrProgram::flatten_expr(LoweredBlock& ctx, FnCallNode& call) {
     // Push all the arguments.
-    for(auto it = call->args.rbegin(); it != call->args.rend(); ++it)
+    for(auto it = call.args.rbegin(); it != call.args.rend(); ++it)
     {
         Instruction::Parts ops;
-        ops.push_back(flatten_expr(ctx, *it));
+        ops.push_back(flatten_expr(ctx, **it));
 
-        ctx.push_back(new_inst(OpCode::Push, std::nullopt, std::move(ops)));
+        ctx.push_back(new_inst(OpCode::Push, Operand{}, std::move(ops)));
         cur_frame_size += (*it)->sema_type->wsizeof();
     }
     
     // Increase the needed stack space by the size of the return value.
-    cur_frame_size += call->sema_type->wsizeof();
+    cur_frame_size += call.sema_type->wsizeof();
 
     Instruction::Parts ops;
-    ops.push_back(new_var_op(call->ident.as_str()));
-    ops.push_back(new_lit_op(format("{}", call->args.capacity()), LiteralKind::Int));
+    ops.push_back(new_var_op(call.ident.id()));
+    ops.push_back(new_lit_op(call.args.capacity()));
 
     // Create a temp to call the value of the call.
-    Ptr<TempOp> temp = new_tmp_op(push_temp());
+    Operand temp = new_tmp_op(push_temp());
 
     auto call_inst = new_inst(
         OpCode::Call, 
-        temp->as_str(), 
+        temp,
         std::move(ops)
     );
     ctx.push_back(std::move(call_inst));
 
-    return std::move(temp);
+    return temp;
 }
 
-Ptr<Operand> IrProgram::flatten_terminal(LoweredBlock& ctx, Ptr<ExprNode>& expr) {
-    auto* term = dynamic_cast<VarTerminalNode*>(expr.get());
-    auto operand = new_var_op(std::move(term->ident.as_str()));
-    return std::move(operand);
+Operand IrProgram::flatten_expr(LoweredBlock& ctx, VarTerminalNode& term) {
+    return new_var_op(term.ident.id());
 }
 
-Ptr<Operand> IrProgram::flatten_expr_into_addr(LoweredBlock& ctx, Ptr<ExprNode>& expr) {
-    switch(expr->id)
+Operand IrProgram::flatten_expr_into_addr(LoweredBlock& ctx, ExprNode& expr) {
+    switch(expr.id)
     {
         case NodeId::Term:
         {
-            auto* var = dynamic_cast<VarTerminalNode*>(expr.get());
-            return new_addr_op(var->ident.as_str());
+            auto& var = static_cast<VarTerminalNode&>(expr);
+            return new_addr_op(var.ident.id());
         }
         case NodeId::Un: 
         {
-            auto* un = dynamic_cast<UnaryOpNode*>(expr.get());
-            if(un->op == UnOpKind::AddrOf) {
-                return flatten_expr(ctx, un->lhs);
-            } else if(un->op == UnOpKind::Dereference) {
-                return flatten_expr(ctx, un->lhs);
+            auto& un = static_cast<UnaryOpNode&>(expr);
+            if(un.op == UnOpKind::AddrOf) {
+                return flatten_expr(ctx, *un.lhs);
+            } else if(un.op == UnOpKind::Dereference) {
+                return flatten_expr(ctx, *un.lhs);
             } else {
-                ASSERT(false, format("unary operation '{}' is not addressable", un_op_str(un->op)));
+                ASSERT(false, format("unary operation '{}' is not addressable", un_op_str(un.op)));
             }
             break;
         }
         default:
-            ASSERT(false, format("cannot flatten '{}' expression into address.", expr->id_str()));
+            ASSERT(false, format("cannot flatten '{}' expression into address.", expr.id_str()));
     }
 }
 
-Ptr<Operand> IrProgram::flatten_expr(LoweredBlock& ctx, Ptr<ExprNode>& expr) {
-    switch(expr->id) 
-    {
-        case NodeId::Lit: return flatten_lit_expr(expr);
-        case NodeId::Bin: return flatten_bin_expr(ctx, expr);
-        case NodeId::Un: return flatten_un_expr(ctx, expr);
-        case NodeId::Term: return flatten_terminal(ctx, expr);
-        case NodeId::FnCall: return flatten_fn_call_from_expr(ctx, expr);
-        default: 
-        {
-            ASSERT(
-                false,
-                format("cannot generate IR code from {}", expr->id_str())
-            );
-            return nullptr;
-        }
-    }
+Operand IrProgram::flatten_expr(LoweredBlock& ctx, ExprNode& expr) {
+    return visit_node(expr, [&](auto& node) { return flatten_expr(ctx, node); });
 }
 
-IrFn IrProgram::flatten_function(Ptr<FnNode>& fn) {
+IrFn IrProgram::flatten_function(FnNode& fn) {
     IrFn flattened {
-        fn->header->name.as_str()
+        fn.header->name.id()
     };
+    LoweredBlock insts;
 
     // Push a label function definition.
-    flattened.push_inst(new_inst(OpCode::Label, flattened.name, {}));
+    insts.push_back(new_inst(OpCode::Label, new_lbl_op(flattened.name), {}));
 
     // Push all the parameters.
-    auto& params = fn->header->params;
+    auto& params = fn.header->params;
     for(auto it = params.rbegin(); it != params.rend(); ++it) {
         Instruction::Parts ops;
-        ops.push_back(new_lit_op(format("{}", (*it).type->wsizeof()), LiteralKind::Int));
-        flattened.push_inst(new_inst(OpCode::Pop, (*it).ident.as_str(), std::move(ops)));
+        ops.push_back(new_lit_op((*it).type->wsizeof()));
+        insts.push_back(new_inst(OpCode::Pop, new_var_op((*it).ident.id()), std::move(ops)));
     }
 
     // Push all remaining instructions.
-    for(auto& inst : flatten_block(fn->body)) {
-        flattened.push_inst(std::move(inst));
+    for(auto& inst : flatten_block(*fn.body)) {
+        insts.push_back(std::move(inst));
     }
 
+    cfg::build(flattened, std::move(insts));
     flattened.space_occupied = cur_frame_size;
+    flattened.temp_count = temp_counter;
     return flattened;
 };
 
-void IrProgram::gen(AST& ast) {
-    lowered_program.reserve(ast.functions.capacity());
-    for(auto& fn : ast.functions) {
-        lowered_program.push_back(flatten_function(fn));
-        cur_frame_size = 0;
+void IrProgram::gen(AST& ast, WorkerPool& pool) {
+    auto& functions = ast.functions;
+
+    lowered_program.clear();
+    lowered_program.reserve(functions.size());
+    for(auto& fn : functions) {
+        lowered_program.emplace_back(fn->header->name.id());
+    }
+
+    // A fresh lowering state per function keeps the numbering of temporaries and labels
+    // independent of which worker lowered what.
+    pool.run_checked(functions.size(), [&](size_t index, size_t) {
+        IrProgram lowering;
+        lowered_program[index] = lowering.flatten_function(*functions[index]);
+    });
+}
+
+opt::Stats IrProgram::optimize(OptLevel level, WorkerPool& pool) {
+    opt::Stats total;
+    if (level == OptLevel::O0) {
+        return total;
     }
+
+    std::vector<opt::Stats> stats(lowered_program.size());
+    pool.run_checked(lowered_program.size(), [&](size_t index, size_t) {
+        IrFn& fn = lowered_program[index];
+        opt::construct_ssa(fn);
+        opt::fold_constants(fn, stats[index]);
+        opt::eliminate_dead_code(fn, stats[index]);
+    });
+
+    for (const auto& fn : stats) {
+        total += fn;
+    }
+    return total;
+}
+
+void IrProgram::leave_ssa(WorkerPool& pool) {
+    pool.run_checked(lowered_program.size(), [&](size_t index, size_t) {
+        if (lowered_program[index].in_ssa) {
+            opt::destruct_ssa(lowered_program[index]);
+        }
+    });
 }
 
 void IrProgram::dump() {
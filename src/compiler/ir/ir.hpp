@@ -2,9 +2,12 @@
 #define IR_HPP_
 
 #include "ast.hpp"
+#include "visit.hpp"
 #include "alias.hpp"
 #include "typing.hpp"
 #include "structs.hpp"
+#include "opt.hpp"
+#include "pool.hpp"
 #include <filesystem>
 
 namespace fs = std::filesystem;
@@ -19,7 +22,7 @@ public:
     // Total function bodies.
     LoweredProgram lowered_program;
     // How many stack bytes does the function need?.
-    // Resets to 0 after every function.
+    // Only used while lowering, every function is lowered by an `IrProgram` of its own.
     size_t cur_frame_size;
 
     IrProgram() : src{std::nullopt}, lowered_program{}, cur_frame_size{0} {}
@@ -34,47 +37,66 @@ public:
     // Writes a textual structure of the 'IR' into a file.
     void dump();
 
-    // Generate an 'IR' from an ast.
-    void gen(AST& ast);
+    // Generate an 'IR' from an ast, functions are lowered in parallel on `pool`.
+    void gen(AST& ast, WorkerPool& pool);
+
+    // Runs the passes of `level` over every function, in parallel on `pool`.
+    opt::Stats optimize(OptLevel level, WorkerPool& pool);
+
+    // Takes the functions left in SSA form out of it, codegen does not know about phis.
+    void leave_ssa(WorkerPool& pool);
 
 private:
     struct LoopCtx {
-        String brk;
-        String cnt;
+        SymId brk;
+        SymId cnt;
     };
     using LoopStack = std::vector<LoopCtx>;
 
+    // Temporaries and branch labels are numbered per function.
     LoopStack loop_stack;
-    size_t temp_counter = 0;
+    uint32_t temp_counter = 0;
     size_t branch_counter = 0;
     
     static CONST int TEMP_SIZE = 8;
     static CONST char EXT[11] = ".wombat.il";
     
     // Compound types.
-    IrFn flatten_function(Ptr<FnNode>& fn);
-    LoweredBlock flatten_block(Ptr<BlockNode>& ctx);
+    IrFn flatten_function(FnNode& fn);
+    LoweredBlock flatten_block(BlockNode& block);
 
     // expression flattening.
-    Ptr<Operand> flatten_expr(LoweredBlock& ctx, Ptr<ExprNode>& expr);
-    Ptr<Operand> flatten_expr_into_addr(LoweredBlock& ctx, Ptr<ExprNode>& expr);
-    Ptr<Operand> flatten_lit_expr(Ptr<ExprNode>& expr);
-    Ptr<Operand> flatten_bin_expr(LoweredBlock& ctx, Ptr<ExprNode>& expr);
-    Ptr<Operand> flatten_un_expr(LoweredBlock& ctx, Ptr<ExprNode>& expr);
-    Ptr<Operand> flatten_terminal(LoweredBlock& ctx, Ptr<ExprNode>& expr);
-    Ptr<Operand> flatten_fn_call_from_expr(LoweredBlock& ctx, Ptr<ExprNode>& fn_call);
+    // `flatten_expr(ctx, ExprNode&)` picks the concrete overload with `visit_node`.
+    Operand flatten_expr(LoweredBlock& ctx, ExprNode& expr);
+    Operand flatten_expr(LoweredBlock& ctx, LiteralNode& lit);
+    Operand flatten_expr(LoweredBlock& ctx, BinOpNode& bin);
+    Operand flatten_expr(LoweredBlock& ctx, UnaryOpNode& un);
+    Operand flatten_expr(LoweredBlock& ctx, VarTerminalNode& term);
+    Operand flatten_expr(LoweredBlock& ctx, FnCallNode& call);
+    Operand flatten_expr_into_addr(LoweredBlock& ctx, ExprNode& expr);
+
+    template<typename NodeT>
+    Operand flatten_expr(LoweredBlock& ctx, NodeT& node) {
+        ASSERT(false, format("cannot generate IR code from {}", node.id_str()));
+        return Operand{};
+    }
 
     // statement flattening.
-    void flatten_fn_call_from_stmt(LoweredBlock& ctx, Ptr<StmtNode>& fn_call);
-    void flatten_var_decl(LoweredBlock& ctx, Ptr<StmtNode>& var_decl);
-    void flatten_assign(LoweredBlock& ctx, Ptr<StmtNode>& assign);
-    void flatten_deref_assign(LoweredBlock& ctx, Ptr<StmtNode>& deref);
-    void flatten_ret_stmt(LoweredBlock& ctx, Ptr<StmtNode>& ret_stmt);
-    void flatten_loop_stmt(LoweredBlock& ctx, Ptr<StmtNode>& loop_stmt);
-    void flatten_brk_stmt(LoweredBlock& ctx, Ptr<StmtNode>& break_stmt);
-    void flatten_branch(LoweredBlock& ctx, Ptr<StmtNode>& if_stmt);
-    void flatten_only_if(LoweredBlock& ctx, Ptr<Operand>& op, Ptr<BlockNode>& if_block);
-    void flatten_if_and_else(LoweredBlock& ctx, Ptr<Operand>& op, Ptr<BlockNode>& if_block, Ptr<BlockNode>& else_block);
+    void flatten_stmt(LoweredBlock& ctx, FnCallNode& call);
+    void flatten_stmt(LoweredBlock& ctx, VarDeclarationNode& var);
+    void flatten_stmt(LoweredBlock& ctx, AssignmentNode& assign);
+    void flatten_stmt(LoweredBlock& ctx, DerefAssignmentNode& deref);
+    void flatten_stmt(LoweredBlock& ctx, ReturnNode& ret);
+    void flatten_stmt(LoweredBlock& ctx, LoopNode& loop);
+    void flatten_stmt(LoweredBlock& ctx, BreakNode& brk);
+    void flatten_stmt(LoweredBlock& ctx, IfNode& branch);
+    void flatten_only_if(LoweredBlock& ctx, Operand op, BlockNode& if_block);
+    void flatten_if_and_else(LoweredBlock& ctx, Operand op, BlockNode& if_block, BlockNode& else_block);
+
+    template<typename NodeT>
+    void flatten_stmt(LoweredBlock& ctx, NodeT& node) {
+        ASSERT(false, format("cannot generate ir code from {}", node.id_str()));
+    }
 
     // Dev wants to create a `.wombat.il` file.
     bool dumpable() {
@@ -128,28 +150,28 @@ private:
         }
     }
 
-    inline String gen_branch_label(String&& ty) {
-        return std::format(".br_{}{}", ty, branch_counter);
+    inline SymId gen_branch_label(String&& ty) {
+        return intern(std::format(".br_{}{}", ty, branch_counter));
     }
 
-    inline Ptr<LitOp> new_lit_op(String&& value, LiteralKind&& kind) {
-        return mk_ptr(LitOp{ std::move(value), std::move(kind) });
+    inline Operand new_lit_op(int64_t value, LiteralKind kind = LiteralKind::Int) {
+        return Operand::literal(value, kind);
     }
 
-    inline Ptr<VarOp> new_var_op(String&& name) {
-        return mk_ptr(VarOp{ std::move(name) });
+    inline Operand new_var_op(SymId name) {
+        return Operand::var(name);
     }
 
-    inline Ptr<TempOp> new_tmp_op(size_t&& id) {
-        return mk_ptr(TempOp{ std::move(id) });
+    inline Operand new_tmp_op(uint32_t id) {
+        return Operand::temporary(id);
     }
 
-    inline Ptr<LabelOp> new_lbl_op(String ident) {
-        return mk_ptr(LabelOp{ std::move(ident) });
+    inline Operand new_lbl_op(SymId ident) {
+        return Operand::label(ident);
     }
 
-    inline Ptr<AddrOp> new_addr_op(String&& addr) {
-        return mk_ptr(AddrOp{ std::move(addr) });
+    inline Operand new_addr_op(SymId addr) {
+        return Operand::addr(addr);
     }
 
     inline void push_loop() {
@@ -161,7 +183,7 @@ private:
         loop_stack.pop_back();
     }
 
-    inline size_t push_temp() {
+    inline uint32_t push_temp() {
         return temp_counter++;
     }
 
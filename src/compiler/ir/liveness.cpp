@@ -0,0 +1,137 @@
+#include <limits>
+#include <unordered_set>
+
+#include "liveness.hpp"
+
+namespace {
+
+// Temporaries, and the 8-byte locals and parameters that are only ever used by value, in order of appearance.
+void collect_values(const IrFn& fn, liveness::Info& info) {
+    std::unordered_set<SymId> addressed;
+    for (const auto& block : fn.blocks) {
+        for (const auto& inst : block.insts) {
+            for (const auto& op : inst.parts) {
+                if (op.is(OpKind::Addr)) addressed.insert(op.sym);
+            }
+        }
+    }
+
+    auto track = [&](const Operand& op) {
+        if (info.index.emplace(op, static_cast<uint32_t>(info.values.size())).second) {
+            info.values.push_back(op);
+        }
+    };
+
+    for (const auto& block : fn.blocks) {
+        for (const auto& inst : block.insts) {
+            bool declares = inst.match_code(OpCode::Alloc) || inst.match_code(OpCode::Pop);
+            if (declares && inst.parts.front().imm == 8 && !addressed.contains(inst.dst.sym)) {
+                track(inst.dst);
+            } else if (inst.dst.is(OpKind::Temp)) {
+                track(inst.dst);
+            }
+
+            if (!inst.reads_parts()) continue;
+            for (const auto& op : inst.parts) {
+                if (op.is(OpKind::Temp)) track(op);
+            }
+        }
+    }
+}
+
+} // namespace
+
+Option<uint32_t> liveness::defined(const Info& info, const Instruction& inst) {
+    if (inst.match_code(OpCode::Alloc)) {
+        return std::nullopt;
+    }
+    return info.find(inst.dst);
+}
+
+liveness::Info liveness::analyze(const IrFn& fn) {
+    ASSERT(!fn.in_ssa, "liveness is computed after leaving SSA form.");
+
+    Info info;
+    collect_values(fn, info);
+
+    size_t count = info.values.size();
+    std::vector<Bits> uses(fn.blocks.size(), Bits(count));
+    std::vector<Bits> defs(fn.blocks.size(), Bits(count));
+    info.live_in.assign(fn.blocks.size(), Bits(count));
+    info.live_out.assign(fn.blocks.size(), Bits(count));
+
+    // Values read before being defined in the block, and values defined in it.
+    for (const auto& block : fn.blocks) {
+        for (const auto& inst : block.insts) {
+            for_each_use(info, inst, [&](uint32_t value) {
+                if (!defs[block.id].test(value)) uses[block.id].set(value);
+            });
+            if (auto value = defined(info, inst)) {
+                defs[block.id].set(value.value());
+            }
+        }
+    }
+
+    // Backwards over the layout until nothing changes, loops take a few rounds.
+    for (bool changed = true; changed;) {
+        changed = false;
+        for (size_t index = fn.blocks.size(); index-- > 0;) {
+            const BasicBlock& block = fn.blocks[index];
+
+            Bits out(count);
+            for (BlockId succ : block.succs) {
+                out.merge(info.live_in[succ]);
+            }
+
+            Bits in = uses[index];
+            out.for_each([&](size_t value) {
+                if (!defs[index].test(value)) in.set(value);
+            });
+
+            if (in != info.live_in[index] || out != info.live_out[index]) {
+                info.live_in[index] = std::move(in);
+                info.live_out[index] = std::move(out);
+                changed = true;
+            }
+        }
+    }
+    return info;
+}
+
+std::vector<liveness::Interval> liveness::intervals(const IrFn& fn, const Info& info) {
+    constexpr uint32_t NONE = std::numeric_limits<uint32_t>::max();
+
+    std::vector<Interval> found(info.values.size());
+    for (uint32_t value = 0; value < found.size(); ++value) {
+        found[value] = Interval{ value, NONE, 0 };
+    }
+
+    auto extend = [&](uint32_t value, uint32_t position) {
+        Interval& interval = found[value];
+        interval.start = std::min(interval.start, position);
+        interval.end = std::max(interval.end, position);
+    };
+
+    size_t n = 0;
+    for (const auto& block : fn.blocks) {
+        if (block.insts.empty()) continue;
+
+        size_t first = n;
+        for (const auto& inst : block.insts) {
+            for_each_use(info, inst, [&](uint32_t value) { extend(value, use_position(n)); });
+            if (auto value = defined(info, inst)) {
+                extend(value.value(), def_position(n));
+            }
+            n++;
+        }
+
+        info.live_in[block.id].for_each([&](size_t value) { extend(value, use_position(first)); });
+        info.live_out[block.id].for_each([&](size_t value) { extend(value, def_position(n - 1)); });
+    }
+
+    // A value that is never written nor read still needs somewhere to be, e.g an unused parameter.
+    for (auto& interval : found) {
+        if (interval.start == NONE) interval.start = 0;
+    }
+    return found;
+}
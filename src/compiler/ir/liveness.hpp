@@ -0,0 +1,110 @@
+#ifndef LIVENESS_HPP_
+#define LIVENESS_HPP_
+
+#include <bit>
+#include <unordered_map>
+#include <vector>
+#include "structs.hpp"
+
+/// @brief `liveness`
+/// Which values of an `IrFn` are live where, for the register allocators.
+/// A value is a temporary, or an 8-byte local or parameter whose address is never taken,
+/// anything else stays in memory and is not tracked.
+namespace liveness {
+
+/// @brief `Bits`
+/// A fixed-size set of value indices.
+class Bits {
+public:
+    Bits() = default;
+    explicit Bits(size_t size) : words((size + 63) / 64, 0) {}
+
+    bool test(size_t index) const {
+        return (words[index / 64] >> (index % 64)) & 1;
+    }
+
+    void set(size_t index) {
+        words[index / 64] |= uint64_t{ 1 } << (index % 64);
+    }
+
+    void reset(size_t index) {
+        words[index / 64] &= ~(uint64_t{ 1 } << (index % 64));
+    }
+
+    // Adds every index of `other`, returns whether any was new.
+    bool merge(const Bits& other) {
+        bool changed = false;
+        for (size_t i = 0; i < words.size(); ++i) {
+            uint64_t merged = words[i] | other.words[i];
+            changed = changed || merged != words[i];
+            words[i] = merged;
+        }
+        return changed;
+    }
+
+    template<typename F>
+    void for_each(F&& fn) const {
+        for (size_t i = 0; i < words.size(); ++i) {
+            for (uint64_t word = words[i]; word != 0; word &= word - 1) {
+                fn(i * 64 + std::countr_zero(word));
+            }
+        }
+    }
+
+    bool operator==(const Bits& other) const = default;
+
+private:
+    std::vector<uint64_t> words;
+};
+
+/// @brief `Info`
+/// The tracked values of a function and the ones live on entry to and exit from each block.
+struct Info {
+    std::vector<Operand> values;
+    std::unordered_map<Operand, uint32_t> index;
+    std::vector<Bits> live_in;
+    std::vector<Bits> live_out;
+
+    // Index of `op` if it is a tracked value.
+    Option<uint32_t> find(const Operand& op) const {
+        auto it = index.find(op);
+        if (it == index.end()) return std::nullopt;
+        return it->second;
+    }
+};
+
+/// @brief `Interval`
+/// The positions from the first definition of a value to its last use, holes included.
+/// Instruction `n` of the function, counting over the blocks in layout order, reads its operands
+/// at position `2n` and defines its destination at `2n + 1`.
+struct Interval {
+    uint32_t value;
+    uint32_t start;
+    uint32_t end;
+};
+
+// Position of the instruction at `n`, by when it reads and when it writes.
+inline uint32_t use_position(size_t n) { return static_cast<uint32_t>(2 * n); }
+inline uint32_t def_position(size_t n) { return static_cast<uint32_t>(2 * n + 1); }
+
+// The value an instruction defines: its destination, unless it is the 'alloc' of a local.
+Option<uint32_t> defined(const Info& info, const Instruction& inst);
+
+// Calls `fn` on the index of every value the instruction reads.
+template<typename F>
+void for_each_use(const Info& info, const Instruction& inst, F&& fn) {
+    if (!inst.reads_parts()) return;
+    for (const auto& op : inst.parts) {
+        if (auto value = info.find(op)) fn(value.value());
+    }
+}
+
+// Values of `fn` and the sets live into and out of its blocks, `fn` must not be in SSA form.
+Info analyze(const IrFn& fn);
+
+// One interval per value of `info`, in value order.
+std::vector<Interval> intervals(const IrFn& fn, const Info& info);
+
+} // namespace liveness
+
+#endif // LIVENESS_HPP_
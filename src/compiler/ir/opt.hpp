@@ -0,0 +1,66 @@
+#ifndef OPT_HPP_
+#define OPT_HPP_
+
+#include "structs.hpp"
+
+/// @brief `OptLevel`
+/// How hard the compiler works on the IR before handing it to codegen, picked with `-O<N>`.
+enum class OptLevel: int {
+    // Functions are emitted as they were lowered.
+    O0,
+    // Scalar locals are promoted into SSA values, constants are folded and dead code is removed.
+    O1,
+    // As `O1`, and codegen keeps values in registers, allocated by linear scan.
+    O2,
+    // As `O2`, with registers allocated by graph coloring instead.
+    O3
+};
+
+/// @brief `opt`
+/// Passes over a single `IrFn`, they never look at other functions so they run on any worker.
+namespace opt {
+
+/// @brief `Stats`
+/// What the passes changed, summed over every function for the `-v1` log.
+struct Stats {
+    // Instructions and phis replaced by the value they always compute.
+    size_t folded = 0;
+    // Conditional jumps taken out on a known condition.
+    size_t branches = 0;
+    // Blocks no path from the entry reaches.
+    size_t blocks_removed = 0;
+    // Instructions and phis removed, the ones in unreachable blocks included.
+    size_t insts_removed = 0;
+
+    Stats& operator+=(const Stats& other) {
+        folded += other.folded;
+        branches += other.branches;
+        blocks_removed += other.blocks_removed;
+        insts_removed += other.insts_removed;
+        return *this;
+    }
+};
+
+// Promotes every 8-byte local and parameter whose address is never taken into SSA values,
+// placing phis on the iterated dominance frontier of its assignments.
+// Its `alloc` and assignments disappear, reads use the value reaching them.
+void construct_ssa(IrFn& fn);
+
+// Replaces the phis of `fn` with copies on the edges into their block, splitting critical edges,
+// so every temporary is defined by a single instruction again.
+void destruct_ssa(IrFn& fn);
+
+// Folds arithmetic, bitwise, shift, comparison and logical instructions on constants into literals,
+// computing exactly what the emitted code would. Temporaries, phis agreeing on a value and locals assigned
+// a constant only once are propagated into their readers, and 'jmp_false' on a known condition becomes
+// an unconditional jump or falls through. Repeats until nothing changes.
+void fold_constants(IrFn& fn, Stats& stats);
+
+// Removes unreachable blocks, instructions computing a temporary nobody reads, phis nobody reads,
+// and locals that are never read along with their 'alloc' and every assignment to them.
+// Calls whose result is unused keep running, but no longer store it.
+void eliminate_dead_code(IrFn& fn, Stats& stats);
+
+} // namespace opt
+
+#endif // OPT_HPP_
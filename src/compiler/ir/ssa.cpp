@@ -0,0 +1,505 @@
+#include <span>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "cfg.hpp"
+#include "opt.hpp"
+
+namespace {
+
+// Narrower locals stay in memory, every store into them truncates the value.
+CONST size_t PROMOTED_SIZE = 8;
+CONST size_t TEMP_SIZE = 8;
+
+// The value of a promoted variable read before it was ever assigned.
+Operand undefined() {
+    return Operand::literal(0);
+}
+
+/// @brief `Promotion`
+/// The variables of a function turned into SSA values, and the values they hold while renaming.
+struct Promotion {
+    std::unordered_map<SymId, size_t> index;
+    std::vector<SymId> vars;
+    // Blocks assigning each variable.
+    std::vector<std::vector<BlockId>> defs;
+    // Read by some block before that block assigns it, the only variables phis are placed for.
+    std::vector<bool> crosses_blocks;
+    // Reaching value of each variable, the innermost dominating definition on top.
+    std::vector<std::vector<Operand>> stacks;
+
+    Option<size_t> find(const Operand& op) const {
+        if (!op.is(OpKind::Sym)) {
+            return std::nullopt;
+        }
+        if (auto it = index.find(op.sym); it != index.end()) {
+            return it->second;
+        }
+        return std::nullopt;
+    }
+
+    Operand current(size_t var) const {
+        return stacks[var].empty() ? undefined() : stacks[var].back();
+    }
+};
+
+Promotion find_promotable(const IrFn& fn) {
+    std::unordered_map<SymId, bool> candidates;
+    for (const auto& block : fn.blocks) {
+        for (const auto& inst : block.insts) {
+            if (inst.match_code(OpCode::Alloc) || inst.match_code(OpCode::Pop)) {
+                bool scalar = inst.parts.front().imm == PROMOTED_SIZE;
+                auto [it, inserted] = candidates.emplace(inst.dst.sym, scalar);
+                it->second = it->second && scalar;
+            }
+            for (const auto& op : inst.parts) {
+                if (op.is(OpKind::Addr)) {
+                    candidates[op.sym] = false;
+                }
+            }
+        }
+    }
+
+    // Walk the blocks again so variables are numbered in the order they are first declared.
+    Promotion promotion;
+    for (const auto& block : fn.blocks) {
+        for (const auto& inst : block.insts) {
+            bool declares = inst.match_code(OpCode::Alloc) || inst.match_code(OpCode::Pop);
+            if (!declares || !candidates[inst.dst.sym] || promotion.index.contains(inst.dst.sym)) continue;
+
+            promotion.index.emplace(inst.dst.sym, promotion.vars.size());
+            promotion.vars.push_back(inst.dst.sym);
+        }
+    }
+
+    size_t count = promotion.vars.size();
+    promotion.defs.resize(count);
+    promotion.crosses_blocks.resize(count, false);
+    promotion.stacks.resize(count);
+
+    std::vector<BlockId> defined_in(count, NO_BLOCK);
+    for (const auto& block : fn.blocks) {
+        for (const auto& inst : block.insts) {
+            if (inst.reads_parts()) {
+                for (const auto& op : inst.parts) {
+                    auto var = promotion.find(op);
+                    if (var && defined_in[var.value()] != block.id) {
+                        promotion.crosses_blocks[var.value()] = true;
+                    }
+                }
+            }
+
+            bool defines = inst.match_code(OpCode::Assign) || inst.match_code(OpCode::Pop);
+            if (auto var = promotion.find(inst.dst); var && defines && defined_in[var.value()] != block.id) {
+                defined_in[var.value()] = block.id;
+                promotion.defs[var.value()].push_back(block.id);
+            }
+        }
+    }
+    return promotion;
+}
+
+// Cytron et al. placement: a variable assigned in a block needs a phi on the block's dominance frontier,
+// and every phi is an assignment of its own.
+void place_phis(IrFn& fn, const Promotion& promotion) {
+    auto frontiers = cfg::dominance_frontiers(fn);
+    // The last variable given a phi in, or queued for, each block.
+    CONST size_t NONE = std::numeric_limits<size_t>::max();
+    std::vector<size_t> has_phi(fn.blocks.size(), NONE), queued(fn.blocks.size(), NONE);
+
+    for (size_t var = 0; var < promotion.vars.size(); ++var) {
+        if (!promotion.crosses_blocks[var]) continue;
+
+        std::vector<BlockId> work = promotion.defs[var];
+        for (BlockId block : work) {
+            queued[block] = var;
+        }
+
+        while (!work.empty()) {
+            BlockId block = work.back();
+            work.pop_back();
+
+            for (BlockId join : frontiers[block]) {
+                if (has_phi[join] == var) continue;
+                has_phi[join] = var;
+
+                auto& target = fn.blocks[join];
+                target.phis.push_back(Phi{ fn.new_temp(), promotion.vars[var], std::vector<Operand>(target.preds.size(), undefined()) });
+
+                if (queued[join] != var) {
+                    queued[join] = var;
+                    work.push_back(join);
+                }
+            }
+        }
+    }
+}
+
+// Rewrites one block in terms of the reaching values, pushing the values it defines onto `pushed`.
+void rename_block(IrFn& fn, BasicBlock& block, Promotion& promotion, std::vector<size_t>& pushed) {
+    auto define = [&](size_t var, Operand value) {
+        promotion.stacks[var].push_back(value);
+        pushed.push_back(var);
+    };
+
+    for (auto& phi : block.phis) {
+        define(promotion.index.at(phi.var), phi.dst);
+    }
+
+    std::vector<Instruction> renamed;
+    renamed.reserve(block.insts.size());
+
+    for (auto& inst : block.insts) {
+        if (inst.reads_parts()) {
+            for (auto& op : inst.parts) {
+                if (auto var = promotion.find(op)) {
+                    op = promotion.current(var.value());
+                }
+            }
+        }
+
+        auto var = promotion.find(inst.dst);
+        if (!var) {
+            renamed.push_back(inst);
+            continue;
+        }
+
+        switch (inst.op) {
+            case OpCode::Alloc:
+                break;
+            case OpCode::Assign:
+            {
+                Operand value = inst.parts.front();
+                // A variable left in memory may change before this value is read, so take a copy.
+                // Promoted variables still read by name are parameters, which are never written again.
+                if (value.is(OpKind::Sym) && !promotion.find(value)) {
+                    Operand copy = fn.new_temp();
+                    renamed.push_back(new_inst(OpCode::Copy, copy, { value }));
+                    value = copy;
+                }
+                define(var.value(), value);
+                break;
+            }
+            case OpCode::Pop:
+            {
+                // Parameters keep their slot, it holds the value they were passed.
+                define(var.value(), inst.dst);
+                renamed.push_back(inst);
+                break;
+            }
+            default:
+                ASSERT(false, format("[ssa::err] unexpected definition of '{}' by {}", inst.dst.as_str(), inst.op_as_str()));
+        }
+    }
+    block.insts = std::move(renamed);
+
+    for (BlockId succ : block.succs) {
+        auto& target = fn.blocks[succ];
+        size_t from = target.pred_index(block.id);
+        for (auto& phi : target.phis) {
+            phi.args[from] = promotion.current(promotion.index.at(phi.var));
+        }
+    }
+}
+
+void rename(IrFn& fn, Promotion& promotion) {
+    std::vector<size_t> pushed;
+
+    auto unwind = [&](size_t mark) {
+        while (pushed.size() > mark) {
+            promotion.stacks[pushed.back()].pop_back();
+            pushed.pop_back();
+        }
+    };
+
+    // Preorder over the dominator tree, each block sees the values of the blocks dominating it.
+    // A frame is a block and, once entered, how many values were pushed before it.
+    std::vector<std::pair<BlockId, Option<size_t>>> frames{ { 0, std::nullopt } };
+    std::vector<bool> visited(fn.blocks.size(), false);
+
+    while (!frames.empty()) {
+        auto [block, mark] = frames.back();
+        frames.pop_back();
+
+        if (mark) {
+            unwind(mark.value());
+            continue;
+        }
+
+        visited[block] = true;
+        frames.push_back({ block, pushed.size() });
+        rename_block(fn, fn.blocks[block], promotion, pushed);
+
+        const auto& children = fn.blocks[block].dom_children;
+        for (auto it = children.rbegin(); it != children.rend(); ++it) {
+            frames.push_back({ *it, std::nullopt });
+        }
+    }
+
+    // Unreachable blocks never run, whatever they read is undefined.
+    for (auto& block : fn.blocks) {
+        if (visited[block.id]) continue;
+        rename_block(fn, block, promotion, pushed);
+        unwind(0);
+    }
+}
+
+// Follows temporaries replaced by the value they always hold.
+Operand resolve(const std::unordered_map<uint32_t, Operand>& replaced, Operand op) {
+    while (op.is(OpKind::Temp)) {
+        auto it = replaced.find(op.temp);
+        if (it == replaced.end()) break;
+        op = it->second;
+    }
+    return op;
+}
+
+// Drops phis merging a single value, and phis nothing ends up reading.
+void prune_phis(IrFn& fn) {
+    std::unordered_map<uint32_t, Operand> replaced;
+
+    for (bool changed = true; changed;) {
+        changed = false;
+        for (auto& block : fn.blocks) {
+            std::erase_if(block.phis, [&](Phi& phi) {
+                Option<Operand> same;
+                for (auto& arg : phi.args) {
+                    arg = resolve(replaced, arg);
+                    if (arg == phi.dst || (same && arg == same.value())) continue;
+                    if (same) return false;
+                    same = arg;
+                }
+                replaced.emplace(phi.dst.temp, same.value_or(undefined()));
+                changed = true;
+                return true;
+            });
+        }
+    }
+
+    std::unordered_map<uint32_t, Phi*> phis;
+    for (auto& block : fn.blocks) {
+        for (auto& phi : block.phis) {
+            phis.emplace(phi.dst.temp, &phi);
+        }
+    }
+
+    std::unordered_set<uint32_t> live;
+    std::vector<Phi*> work;
+    auto use = [&](const Operand& op) {
+        if (!op.is(OpKind::Temp)) return;
+        if (auto it = phis.find(op.temp); it != phis.end() && live.insert(op.temp).second) {
+            work.push_back(it->second);
+        }
+    };
+
+    for (auto& block : fn.blocks) {
+        for (auto& inst : block.insts) {
+            if (!inst.reads_parts()) continue;
+            for (auto& op : inst.parts) {
+                op = resolve(replaced, op);
+                use(op);
+            }
+        }
+    }
+    while (!work.empty()) {
+        Phi* phi = work.back();
+        work.pop_back();
+        for (const auto& arg : phi->args) {
+            use(arg);
+        }
+    }
+
+    for (auto& block : fn.blocks) {
+        std::erase_if(block.phis, [&](const Phi& phi) { return !live.contains(phi.dst.temp); });
+    }
+}
+
+// Bytes codegen hands out: the size of every declared variable and a slot per temporary.
+size_t frame_bytes(const IrFn& fn) {
+    size_t bytes = 0;
+    for (const auto& block : fn.blocks) {
+        for (const auto& inst : block.insts) {
+            if (inst.match_code(OpCode::Alloc) || inst.match_code(OpCode::Pop)) {
+                bytes += inst.parts.front().imm;
+            } else if (inst.dst.is(OpKind::Temp)) {
+                bytes += TEMP_SIZE;
+            }
+        }
+    }
+    return bytes;
+}
+
+using Copies = std::vector<std::pair<Operand, Operand>>;
+
+// The copies of an edge happen at once, so a destination is only written once no other copy reads it.
+// What is left are cycles, one of them is broken by saving a destination in a temporary first.
+void sequentialize(IrFn& fn, Copies copies, std::vector<Instruction>& out) {
+    std::erase_if(copies, [](const auto& copy) { return copy.first == copy.second; });
+
+    while (!copies.empty()) {
+        auto ready = std::find_if(copies.begin(), copies.end(), [&](const auto& copy) {
+            return std::none_of(copies.begin(), copies.end(), [&](const auto& other) {
+                return other.second == copy.first;
+            });
+        });
+
+        if (ready != copies.end()) {
+            out.push_back(new_inst(OpCode::Assign, ready->first, { ready->second }));
+            copies.erase(ready);
+            continue;
+        }
+
+        Operand saved = fn.new_temp(), overwritten = copies.front().first;
+        out.push_back(new_inst(OpCode::Copy, saved, { overwritten }));
+        for (auto& copy : copies) {
+            if (copy.second == overwritten) copy.second = saved;
+        }
+    }
+}
+
+// Puts `copies` before the terminator of `block`, or at its end when it falls through.
+void append_before_terminator(BasicBlock& block, std::vector<Instruction>&& copies) {
+    auto at = block.terminator() != nullptr ? block.insts.end() - 1 : block.insts.end();
+    block.insts.insert(at, std::make_move_iterator(copies.begin()), std::make_move_iterator(copies.end()));
+}
+
+} // namespace
+
+void opt::construct_ssa(IrFn& fn) {
+    ASSERT(!fn.in_ssa, format("[ssa::err] '{}' is already in SSA form.", fn.name.str()));
+    fn.in_ssa = true;
+
+    Promotion promotion = find_promotable(fn);
+    if (promotion.vars.empty()) {
+        return;
+    }
+
+    place_phis(fn, promotion);
+    rename(fn, promotion);
+    prune_phis(fn);
+}
+
+void opt::destruct_ssa(IrFn& fn) {
+    ASSERT(fn.in_ssa, format("[ssa::err] '{}' is not in SSA form.", fn.name.str()));
+    fn.in_ssa = false;
+
+    // Each phi becomes a variable, written on every edge into its block.
+    std::unordered_map<uint32_t, Operand> slots;
+    std::vector<Instruction> allocs;
+    for (auto& block : fn.blocks) {
+        for (auto& phi : block.phis) {
+            Operand slot = Operand::var(intern(std::format("{}.{}", phi.var.str(), phi.dst.temp)));
+            slots.emplace(phi.dst.temp, slot);
+            allocs.push_back(new_inst(OpCode::Alloc, slot, { Operand::literal(PROMOTED_SIZE) }));
+        }
+    }
+
+    if (!slots.empty()) {
+        // Copies for the edge `from -> to`, in terms of the phi variables.
+        auto edge_copies = [&](BlockId from, const BasicBlock& to) {
+            Copies copies;
+            size_t index = to.pred_index(from);
+            for (const auto& phi : to.phis) {
+                copies.push_back({ slots.at(phi.dst.temp), resolve(slots, phi.args[index]) });
+            }
+            std::vector<Instruction> out;
+            sequentialize(fn, std::move(copies), out);
+            return out;
+        };
+
+        size_t splits = 0;
+        auto split_label = [&]() {
+            return Operand::label(intern(std::format(".ssa_edge{}", splits++)));
+        };
+
+        // Blocks are edited in place first, every edge reads the phis of its target before anything moves.
+        std::vector<Option<BasicBlock>> after(fn.blocks.size());
+        std::vector<BasicBlock> tail;
+
+        for (size_t index = 0; index < fn.blocks.size(); ++index) {
+            BasicBlock& block = fn.blocks[index];
+            const Instruction* term = block.terminator();
+            bool branches = term != nullptr && (term->op == OpCode::JmpFalse || term->op == OpCode::JmpTrue);
+
+            if (!branches) {
+                // A single successor, the copies can run in the block itself.
+                for (BlockId succ : block.succs) {
+                    if (!fn.blocks[succ].phis.empty()) {
+                        append_before_terminator(block, edge_copies(block.id, fn.blocks[succ]));
+                    }
+                }
+                continue;
+            }
+
+            // Both edges of a branch are critical, the copies go into a block of their own.
+            BlockId next = index + 1 < fn.blocks.size() ? static_cast<BlockId>(index + 1) : NO_BLOCK;
+            Operand& target = block.insts.back().parts.at(1);
+            BlockId taken = NO_BLOCK;
+            for (BlockId succ : block.succs) {
+                if (fn.blocks[succ].label() == Option<SymId>{ target.sym }) taken = succ;
+            }
+
+            auto new_block = [&](BlockId to) {
+                BasicBlock split(NO_BLOCK);
+                split.insts.push_back(new_inst(OpCode::Label, split_label(), {}));
+                append_before_terminator(split, edge_copies(block.id, fn.blocks[to]));
+                return split;
+            };
+
+            if (next != NO_BLOCK && !fn.blocks[next].phis.empty()) {
+                // Falls into `next`, and so does the branch when both go there.
+                after[index] = new_block(next);
+                if (taken == next) {
+                    target = after[index]->insts.front().dst;
+                }
+            }
+            if (taken != NO_BLOCK && taken != next && !fn.blocks[taken].phis.empty()) {
+                BasicBlock split = new_block(taken);
+                split.insts.push_back(new_inst(OpCode::Jmp, Operand{}, { target }));
+                target = split.insts.front().dst;
+                tail.push_back(std::move(split));
+            }
+        }
+
+        std::vector<BasicBlock> laid_out;
+        laid_out.reserve(fn.blocks.size() + tail.size());
+        for (size_t index = 0; index < fn.blocks.size(); ++index) {
+            laid_out.push_back(std::move(fn.blocks[index]));
+            if (after[index]) {
+                laid_out.push_back(std::move(after[index].value()));
+            }
+        }
+
+        if (!tail.empty()) {
+            // The last block may fall off the end of the function, which must not run into the split blocks.
+            BasicBlock& last = laid_out.back();
+            if (last.terminator() == nullptr) {
+                Operand end = Operand::label(fn.name);
+                last.insts.push_back(new_inst(OpCode::Ret, end, { end }));
+            }
+            for (auto& split : tail) {
+                laid_out.push_back(std::move(split));
+            }
+        }
+
+        fn.blocks = std::move(laid_out);
+        for (auto& block : fn.blocks) {
+            block.phis.clear();
+            for (auto& inst : block.insts) {
+                if (!inst.reads_parts()) continue;
+                for (auto& op : inst.parts) {
+                    op = resolve(slots, op);
+                }
+            }
+        }
+
+        // Declared right after the function label.
+        auto& entry = fn.blocks.front().insts;
+        entry.insert(entry.begin() + 1, std::make_move_iterator(allocs.begin()), std::make_move_iterator(allocs.end()));
+
+        cfg::link(fn);
+        cfg::analyze(fn);
+    }
+
+    fn.space_occupied = frame_bytes(fn);
+}
@@ -1,10 +1,55 @@
 #include "structs.hpp"
+#include <bit>
 #include <span>
 #include <sstream>
 
+String Operand::as_str() const {
+    switch(kind) {
+        case OpKind::Lit:
+            if (lit == LiteralKind::Float) {
+                return std::format("{}", std::bit_cast<double>(imm));
+            }
+            return std::to_string(imm);
+        case OpKind::Sym:   return sym.as_str();
+        case OpKind::Temp:  return std::format("%t{}", temp);
+        case OpKind::Addr:  return std::format("&{}", sym.str());
+        case OpKind::Label: return sym.as_str();
+        default:
+            return "_";
+    }
+}
+
+// E.g '#[bb2: preds(bb1, bb4) succs(bb3) idom(bb1) loop_depth(1)]'.
+static std::string describe_block(const BasicBlock& block) {
+    auto list = [](const std::vector<BlockId>& ids) {
+        std::string joined;
+        for (BlockId id : ids) {
+            joined += joined.empty() ? std::format("bb{}", id) : std::format(", bb{}", id);
+        }
+        return joined;
+    };
+    return std::format(
+        "#[bb{}: preds({}) succs({}) idom({}) loop_depth({})]",
+        block.id,
+        list(block.preds),
+        list(block.succs),
+        block.idom == NO_BLOCK ? "-" : std::format("bb{}", block.idom),
+        block.loop_depth
+    );
+}
+
+// E.g '%t4 = phi(i) [bb1: 0, bb3: %t7]'.
+static std::string describe_phi(const BasicBlock& block, const Phi& phi) {
+    std::string args;
+    for (size_t index = 0; index < phi.args.size(); ++index) {
+        args += std::format("{}bb{}: {}", index == 0 ? "" : ", ", block.preds[index], phi.args[index].as_str());
+    }
+    return std::format("{} = phi({}) [{}]", phi.dst.as_str(), phi.var.str(), args);
+}
+
 std::string IrFn::dump() {
     ASSERT(
-        insts.front().match_code(OpCode::Label),
+        !blocks.empty() && blocks.front().label().has_value(),
         "a ir function must be preambled with a 'label' instruction."
     );
 
@@ -17,163 +62,187 @@ std::string IrFn::dump() {
     auto inline_doc = [&stream, &depth](std::string&& line) -> void { stream << DOC << line << NEWLINE; };
     auto append = [&stream, &depth](std::string&& inst) -> void { stream << std::string(depth, TAB) << inst << NEWLINE; };
 
-    for(auto& inst : insts) {
-        switch(inst.op) 
-        {
-            case OpCode::Label: 
+    for(auto& block : blocks) {
+        // Blocks are described right under their label.
+        if(!block.label().has_value()) {
+            append(describe_block(block));
+        }
+
+        // Phis have no place in `insts`, they are printed under the description of their block.
+        auto phis = [&]() {
+            for(auto& phi : block.phis) {
+                append(describe_phi(block, phi));
+            }
+        };
+        if(!block.label().has_value()) {
+            phis();
+        }
+
+        for(auto& inst : block.insts) {
+            switch(inst.op) 
             {
-                if(fn_label(inst)) {
-                    append(format("@{}:", inst.dst.value()));
+                case OpCode::Label: 
+                {
+                    if(fn_label(inst)) {
+                        append(format("@{}:", inst.dst.as_str()));
+                    }
+                    else {
+                        decrease_depth();
+                        append(format("{}:", inst.dst.as_str()));
+                    }
+                    increase_depth();
+                    append(describe_block(block));
+                    phis();
+                    break;
                 }
-                else {
-                    decrease_depth();
-                    append(format("{}:", inst.dst.value()));
+                case OpCode::Alloc:
+                {
+                    ASSERT(inst.parts.size() == 1, "unexpected number of operands for alloc instruction.");
+                    auto alloc_bytes = inst.parts.front().as_str();
+                    append(format("#[stack_allocation({} bytes)]", alloc_bytes));
+                    append(format("alloc {}, {}", inst.dst.as_str(), alloc_bytes));
+                    break;
                 }
-                increase_depth();
-                break;
-            }
-            case OpCode::Alloc:
-            {
-                ASSERT(inst.parts.capacity() == 1, "unexpected number of operands for alloc instruction.");
-                auto alloc_bytes = inst.parts.front()->as_str();
-                append(format("#[stack_allocation({} bytes)]", alloc_bytes));
-                append(format("alloc {}, {}", inst.dst.value(), alloc_bytes));
-                break;
-            }
-            case OpCode::Store:
-            {
-                ASSERT(inst.parts.capacity() == 2, "unexpected number of operands for memset instruction.");
-                auto& op = inst.parts.at(0);
-                auto& value = inst.parts.at(1);
-                append(format("store({}) = {}", op->as_str(), value->as_str()));
-                break;
-            }
-            case OpCode::Dereference:
-            {
-                ASSERT(inst.parts.capacity() == 1, "unexpected number of operands for dereference instruction.");
-                auto& op = inst.parts.front();
-                append(format("{} = deref {}", inst.dst.value(), op->as_str()));
-                break;
-            }
-            case OpCode::Assign:
-            {
-                ASSERT(inst.parts.capacity() == 1, "unexpected number of operands for assign instruction.");
-                append(format("{} = {}", inst.dst.value(), inst.parts.front()->as_str()));
-                break;
-            }
-            case OpCode::Push:
-            {   
-                ASSERT(inst.parts.capacity() == 1, "unexpected number of operands for push instruction.");
-                auto& op = inst.parts.front();
-                append(format("push {}", op->as_str()));
-                break;
-            }
-            case OpCode::Pop: 
-            {
-                ASSERT(inst.parts.capacity() == 1, "unexpected number of operands for pop instruction.");
-                auto& op = inst.parts.front();
-                append(format("pop |{}, {} bytes|", inst.dst.value(), op->as_str()));
-                break;
-            }
-            case OpCode::Call: 
-            {   
-                ASSERT(inst.parts.capacity() == 2, "unexpected number of operands for call instruction.");
+                case OpCode::Store:
+                {
+                    ASSERT(inst.parts.size() == 2, "unexpected number of operands for memset instruction.");
+                    auto& op = inst.parts.at(0);
+                    auto& value = inst.parts.at(1);
+                    append(format("store({}) = {}", op.as_str(), value.as_str()));
+                    break;
+                }
+                case OpCode::Dereference:
+                {
+                    ASSERT(inst.parts.size() == 1, "unexpected number of operands for dereference instruction.");
+                    auto& op = inst.parts.front();
+                    append(format("{} = deref {}", inst.dst.as_str(), op.as_str()));
+                    break;
+                }
+                case OpCode::Copy:
+                {
+                    ASSERT(inst.parts.size() == 1, "unexpected number of operands for copy instruction.");
+                    append(format("{} = copy {}", inst.dst.as_str(), inst.parts.front().as_str()));
+                    break;
+                }
+                case OpCode::Assign:
+                {
+                    ASSERT(inst.parts.size() == 1, "unexpected number of operands for assign instruction.");
+                    append(format("{} = {}", inst.dst.as_str(), inst.parts.front().as_str()));
+                    break;
+                }
+                case OpCode::Push:
+                {   
+                    ASSERT(inst.parts.size() == 1, "unexpected number of operands for push instruction.");
+                    auto& op = inst.parts.front();
+                    append(format("push {}", op.as_str()));
+                    break;
+                }
+                case OpCode::Pop: 
+                {
+                    ASSERT(inst.parts.size() == 1, "unexpected number of operands for pop instruction.");
+                    auto& op = inst.parts.front();
+                    append(format("pop |{}, {} bytes|", inst.dst.as_str(), op.as_str()));
+                    break;
+                }
+                case OpCode::Call: 
+                {   
+                    ASSERT(inst.parts.size() == 2, "unexpected number of operands for call instruction.");
 
-                // Get the operand. (Represents the number of arguments.)
-                auto dst = inst.dst;
-                auto& fn = inst.parts.at(0);
-                auto& args = inst.parts.at(1);
+                    // Get the operand. (Represents the number of arguments.)
+                    auto& fn = inst.parts.at(0);
+                    auto& args = inst.parts.at(1);
 
-                if(dst.has_value()) {
-                    append(format("{} = call {}, {}", dst.value(), fn->as_str(), args->as_str()));
-                } else {
-                    append(format("_ = call {}, {}", fn->as_str(), args->as_str()));
-                }
+                    if(inst.has_dst()) {
+                        append(format("{} = call {}, {}", inst.dst.as_str(), fn.as_str(), args.as_str()));
+                    } else {
+                        append(format("_ = call {}, {}", fn.as_str(), args.as_str()));
+                    }
 
-                break;
-            }
-            case OpCode::Ret:
-            {   
-                ASSERT(inst.parts.capacity() <= 2, "unexpected number of operands for ret instruction.");
-                if(inst.parts.size() < 2) {
-                    auto& lbl_op = inst.parts.at(0);
-                    append(format("#[{}] ret; ", lbl_op->as_str()));
-                } else {
-                    auto& op = inst.parts.at(0);
-                    auto& lbl_op = inst.parts.at(1);
-                    append(format("#[{}] ret {}", lbl_op->as_str(), op->as_str()));
+                    break;
                 }
-                break;
-            }
-            case OpCode::Jmp:
-            {
-                ASSERT(inst.parts.capacity() == 1, "unexpected number of operands for jmp instruction.");
-                auto& label = inst.parts.front();
-                append(format("jmp {}", label->as_str()));
-                break;
-            }
-            case OpCode::JmpFalse:
-            {
-                ASSERT(inst.parts.capacity() == 2, "unexpected number of operands for jmpFalse instruction.");
-                auto& cond = inst.parts.at(0);
-                auto& label = inst.parts.at(1);
-                append(format("jmp_false {}, {}", cond->as_str(), label->as_str()));
-                break;
-            }
-            case OpCode::JmpTrue:
-            {
-                ASSERT(inst.parts.capacity() == 2, "unexpected number of operands for jmpTrue instruction.");
-                auto& cond = inst.parts.at(0);
-                auto& label = inst.parts.at(1);
-                append(format("jmp_true {}, {}", cond->as_str(), label->as_str()));
-                break;
-            }
-            case OpCode::Add:
-            case OpCode::Sub:
-            case OpCode::Mul:
-            case OpCode::Div:
-            case OpCode::Mod:
-            case OpCode::And:
-            case OpCode::Or:
-            case OpCode::Eq:
-            case OpCode::NotEq:
-            case OpCode::Le:
-            case OpCode::Lt:
-            case OpCode::Ge:
-            case OpCode::Gt:
-            case OpCode::BitAnd:
-            case OpCode::BitXor:
-            case OpCode::BitOr:
-            case OpCode::Shl:
-            case OpCode::Shr:
-            {   
-                ASSERT(
-                    inst.parts.capacity() == 2, 
-                    format("unexpected number of operands for {} instruction.", inst.op_as_str())
-                );
-                
-                String dst = inst.dst.value();
-                auto& lhs = inst.parts.at(0);
-                auto& rhs = inst.parts.at(1);
+                case OpCode::Ret:
+                {   
+                    ASSERT(inst.parts.size() <= 2, "unexpected number of operands for ret instruction.");
+                    if(inst.parts.size() < 2) {
+                        auto& lbl_op = inst.parts.at(0);
+                        append(format("#[{}] ret; ", lbl_op.as_str()));
+                    } else {
+                        auto& op = inst.parts.at(0);
+                        auto& lbl_op = inst.parts.at(1);
+                        append(format("#[{}] ret {}", lbl_op.as_str(), op.as_str()));
+                    }
+                    break;
+                }
+                case OpCode::Jmp:
+                {
+                    ASSERT(inst.parts.size() == 1, "unexpected number of operands for jmp instruction.");
+                    auto& label = inst.parts.front();
+                    append(format("jmp {}", label.as_str()));
+                    break;
+                }
+                case OpCode::JmpFalse:
+                {
+                    ASSERT(inst.parts.size() == 2, "unexpected number of operands for jmpFalse instruction.");
+                    auto& cond = inst.parts.at(0);
+                    auto& label = inst.parts.at(1);
+                    append(format("jmp_false {}, {}", cond.as_str(), label.as_str()));
+                    break;
+                }
+                case OpCode::JmpTrue:
+                {
+                    ASSERT(inst.parts.size() == 2, "unexpected number of operands for jmpTrue instruction.");
+                    auto& cond = inst.parts.at(0);
+                    auto& label = inst.parts.at(1);
+                    append(format("jmp_true {}, {}", cond.as_str(), label.as_str()));
+                    break;
+                }
+                case OpCode::Add:
+                case OpCode::Sub:
+                case OpCode::Mul:
+                case OpCode::Div:
+                case OpCode::Mod:
+                case OpCode::And:
+                case OpCode::Or:
+                case OpCode::Eq:
+                case OpCode::NotEq:
+                case OpCode::Le:
+                case OpCode::Lt:
+                case OpCode::Ge:
+                case OpCode::Gt:
+                case OpCode::BitAnd:
+                case OpCode::BitXor:
+                case OpCode::BitOr:
+                case OpCode::Shl:
+                case OpCode::Shr:
+                {   
+                    ASSERT(
+                        inst.parts.size() == 2, 
+                        format("unexpected number of operands for {} instruction.", inst.op_as_str())
+                    );
+                    
+                    String dst = inst.dst.as_str();
+                    auto& lhs = inst.parts.at(0);
+                    auto& rhs = inst.parts.at(1);
 
-                append(format("{} = {}: {}, {}", std::move(dst), inst.op_as_str(), lhs->as_str(), rhs->as_str()));
-                break;
-            }
-            case OpCode::Not:
-            case OpCode::Neg:
-            case OpCode::BitNot:
-            {
-                ASSERT(
-                    inst.parts.capacity() == 1, 
-                    format("unexpected number of operands for {} instruction.", inst.op_as_str())
-                );
-                String dst = inst.dst.value();
-                auto& lhs = inst.parts.front();
-                append(format("{} = {}: {}", std::move(dst), inst.op_as_str(), lhs->as_str()));
-                break;
+                    append(format("{} = {}: {}, {}", std::move(dst), inst.op_as_str(), lhs.as_str(), rhs.as_str()));
+                    break;
+                }
+                case OpCode::Not:
+                case OpCode::Neg:
+                case OpCode::BitNot:
+                {
+                    ASSERT(
+                        inst.parts.size() == 1, 
+                        format("unexpected number of operands for {} instruction.", inst.op_as_str())
+                    );
+                    String dst = inst.dst.as_str();
+                    auto& lhs = inst.parts.front();
+                    append(format("{} = {}: {}", std::move(dst), inst.op_as_str(), lhs.as_str()));
+                    break;
+                }
+                default: 
+                    append(format("#[unhandled({})]", inst.op_as_str()));
             }
-            default: 
-                append(format("#[unhandled({})]", inst.op_as_str()));
         }
     }
 
@@ -1,7 +1,13 @@
 #ifndef STRUCTS_HPP
 #define STRUCTS_HPP
 
+#include <algorithm>
+#include <array>
+#include <cstdint>
 #include <format>
+#include <initializer_list>
+#include <limits>
+#include <vector>
 #include "token.hpp"
 
 using String = std::string;
@@ -79,7 +85,9 @@ enum class OpCode: int {
     Nop
 };
 
-enum class OpKind : int {
+enum class OpKind : uint8_t {
+    // No operand, e.g the destination of a 'jmp'.
+    None,
     // Operand is a literal.
     Lit,
     // Operand is variable name. 
@@ -92,88 +100,144 @@ enum class OpKind : int {
     Label
 };
 
+/// @brief `Operand`
+/// A 16-byte tagged value, `kind` picks which member of the payload is live:
+/// `imm` for literals, `sym` for variables, addresses and labels, `temp` for temporaries.
+/// Operands are stored inline in their instruction, so lowering an expression never allocates for them.
 struct Operand {
-    OpKind kind;
+    OpKind kind = OpKind::None;
+    // What a literal was written as, floats keep their bits in `imm`.
+    LiteralKind lit = LiteralKind::Int;
+    union {
+        int64_t imm = 0;
+        SymId sym;
+        uint32_t temp;
+    };
+
+    static Operand literal(int64_t value, LiteralKind lit = LiteralKind::Int) {
+        Operand op{ OpKind::Lit };
+        op.lit = lit;
+        op.imm = value;
+        return op;
+    }
 
-    ~Operand() = default;
-    Operand(OpKind&& kind) : kind(std::move(kind)) {}
+    static Operand var(SymId name) {
+        return with_sym(OpKind::Sym, name);
+    }
 
-    virtual String as_str() const = 0;
-};
+    static Operand temporary(uint32_t id) {
+        Operand op{ OpKind::Temp };
+        op.temp = id;
+        return op;
+    }
 
-struct LitOp : public Operand {
-    String value;
-    LiteralKind kind;
+    static Operand addr(SymId name) {
+        return with_sym(OpKind::Addr, name);
+    }
 
-    LitOp() : Operand(OpKind::Lit), value{}, kind{} {}
-    LitOp(String&& value, LiteralKind&& kind) : Operand(OpKind::Lit), value(std::move(value)), kind(std::move(kind)) {}
+    static Operand label(SymId name) {
+        return with_sym(OpKind::Label, name);
+    }
 
-    String as_str() const {
-        return value;
+    bool is(OpKind other) const {
+        return kind == other;
     }
-};
 
-struct VarOp : public Operand {
-    String name;
+    bool operator==(const Operand& other) const {
+        return kind == other.kind && lit == other.lit && imm == other.imm;
+    }
 
-    VarOp() : Operand(OpKind::Sym), name{} {}
-    VarOp(std::string&& name) : Operand(OpKind::Sym), name{std::move(name)} {}
+    // How the operand reads in the IR and the assembly, e.g '42', 'x', '%t1', '&x'.
+    String as_str() const;
 
-    String as_str() const {
-        return name;
+private:
+    static Operand with_sym(OpKind kind, SymId name) {
+        Operand op{ kind };
+        // Clear the upper half, so equality can compare `imm`.
+        op.imm = 0;
+        op.sym = name;
+        return op;
     }
 };
 
-struct AddrOp : public Operand {
-    String ident;
-
-    AddrOp() : Operand(OpKind::Addr), ident{} {}
-    AddrOp(String&& addr) : Operand(OpKind::Addr), ident{std::move(addr)} {}
+static_assert(sizeof(Operand) == 16, "operands are meant to stay two words wide.");
 
-    String as_str() const {
-        return std::format("&{}", ident);
+template<>
+struct std::hash<Operand> {
+    size_t operator()(const Operand& op) const noexcept {
+        return std::hash<int64_t>{}(op.imm) * 31 + static_cast<size_t>(op.kind);
     }
 };
 
-struct TempOp : public Operand {
-    size_t id;
+struct Instruction {
+    // Instructions read at most two operands.
+    static CONST size_t MAX_PARTS = 2;
+
+    /// @brief `Parts`
+    /// The operands an instruction reads, kept inline.
+    class Parts {
+    public:
+        Parts() = default;
+        Parts(std::initializer_list<Operand> ops) {
+            for (const Operand& op : ops) {
+                push_back(op);
+            }
+        }
 
-    TempOp() : Operand(OpKind::Temp), id{0} {}
-    TempOp(size_t id) : Operand(OpKind::Temp), id{std::move(id)} {}
+        void push_back(const Operand& op) {
+            ASSERT(m_size < MAX_PARTS, "[ir::err] too many operands for one instruction.");
+            m_ops[m_size++] = op;
+        }
 
-    String as_str() const {
-        return std::format("%t{}", id);
-    }
-};
+        size_t size() const { return m_size; }
+        bool empty() const { return m_size == 0; }
 
+        Operand& at(size_t index) {
+            ASSERT(index < m_size, "[ir::err] operand index out of range.");
+            return m_ops[index];
+        }
 
-struct LabelOp : public Operand {
-    String ident;
+        const Operand& at(size_t index) const {
+            ASSERT(index < m_size, "[ir::err] operand index out of range.");
+            return m_ops[index];
+        }
 
-    LabelOp() : Operand(OpKind::Label), ident{""} {}
-    LabelOp(String ident) : Operand(OpKind::Temp), ident{std::move(ident)} {}
+        Operand& front() { return at(0); }
+        const Operand& front() const { return at(0); }
 
-    String as_str() const {
-        return ident;
-    }
-};
+        Operand* begin() { return m_ops.data(); }
+        Operand* end() { return m_ops.data() + m_size; }
+        const Operand* begin() const { return m_ops.data(); }
+        const Operand* end() const { return m_ops.data() + m_size; }
 
-struct Instruction {
-    using Parts = std::vector<Ptr<Operand>>;
+    private:
+        std::array<Operand, MAX_PARTS> m_ops{};
+        uint8_t m_size = 0;
+    };
 
     OpCode op;
-    Option<String> dst;
+    // What the instruction defines, `OpKind::None` if nothing.
+    Operand dst;
     Parts parts;
 
-    Instruction(OpCode&& op, Option<String>&& dst, Parts&& parts) 
-        : op{std::move(op)},
-          dst{std::move(dst)},
-          parts{std::move(parts)} {}
+    Instruction(OpCode op, Operand dst, Parts parts) 
+        : op{op},
+          dst{dst},
+          parts{parts} {}
 
-    bool match_code(OpCode&& other) {
+    bool match_code(OpCode other) const {
         return op == other;
     }
 
+    bool has_dst() const {
+        return !dst.is(OpKind::None);
+    }
+
+    // Are `parts` values the instruction reads? Sizes, callees and argument counts are not.
+    bool reads_parts() const {
+        return op != OpCode::Alloc && op != OpCode::Pop && op != OpCode::Call;
+    }
+
     inline std::string op_as_str() {
         switch(op) {
             case OpCode::Label:       return "label";
@@ -220,31 +284,120 @@ struct Instruction {
 
 };
 
-inline Instruction new_inst(OpCode&& op, Option<String>&& dst, Instruction::Parts&& parts) {
-    return Instruction(std::move(op), std::move(dst), std::move(parts));
+inline Instruction new_inst(OpCode op, Operand dst, Instruction::Parts parts) {
+    return Instruction(op, dst, parts);
 };
 
-struct IrFn {
-    using Container = std::vector<Instruction>;
+// Does `op` end a basic block?
+inline bool is_terminator(OpCode op) {
+    return op == OpCode::Jmp || op == OpCode::JmpFalse || op == OpCode::JmpTrue || op == OpCode::Ret;
+}
+
+using BlockId = uint32_t;
+CONST BlockId NO_BLOCK = std::numeric_limits<BlockId>::max();
+CONST size_t NO_LOOP = std::numeric_limits<size_t>::max();
+
+/// @brief `Phi`
+/// Merges the values a promoted variable has at the end of each predecessor, `args[i]` flows in from `preds[i]`.
+/// Phis only exist while a function is in SSA form, they are all evaluated at once on entry to their block.
+struct Phi {
+    Operand dst;
+    // The variable being merged.
+    SymId var;
+    std::vector<Operand> args;
+};
 
-    String name;
-    size_t space_occupied;
-    Container insts;
+/// @brief `BasicBlock`
+/// A straight run of instructions, only entered at the top and only left at the bottom.
+/// It starts with its label if it has one, and ends with a terminator or falls through into the next block.
+/// Edges are filled by `cfg::link`, dominators and loops by `cfg::analyze`.
+struct BasicBlock {
+    BlockId id;
+    std::vector<Instruction> insts;
+    // Run before `insts`, see `Phi`.
+    std::vector<Phi> phis;
+    std::vector<BlockId> preds;
+    std::vector<BlockId> succs;
+
+    // Immediate dominator, `NO_BLOCK` for the entry and for unreachable blocks.
+    BlockId idom = NO_BLOCK;
+    // Blocks this one immediately dominates.
+    std::vector<BlockId> dom_children;
+    // Innermost loop containing the block and how many loops do, `NO_LOOP` and 0 outside loops.
+    size_t loop = NO_LOOP;
+    uint32_t loop_depth = 0;
+
+    explicit BasicBlock(BlockId id) : id{id}, insts(), phis(), preds(), succs(), dom_children() {}
+
+    // Where `pred` sits in `preds`, and so which argument of each phi comes from it.
+    size_t pred_index(BlockId pred) const {
+        auto it = std::find(preds.begin(), preds.end(), pred);
+        ASSERT(it != preds.end(), "[cfg::err] not a predecessor of the block.");
+        return static_cast<size_t>(it - preds.begin());
+    }
+
+    // The label the block starts with, if any.
+    Option<SymId> label() const {
+        if (!insts.empty() && insts.front().match_code(OpCode::Label)) {
+            return insts.front().dst.sym;
+        }
+        return std::nullopt;
+    }
+
+    // The instruction leaving the block, `nullptr` if it falls through.
+    const Instruction* terminator() const {
+        if (!insts.empty() && is_terminator(insts.back().op)) {
+            return &insts.back();
+        }
+        return nullptr;
+    }
+};
+
+/// @brief `Loop`
+/// A natural loop: its header dominates every block of it, and each of them reaches the header again.
+struct Loop {
+    BlockId header;
+    // Sorted, the header included.
+    std::vector<BlockId> blocks;
+    // Enclosing loop, `NO_LOOP` for outermost loops.
+    size_t parent = NO_LOOP;
+    uint32_t depth = 1;
+
+    bool contains(BlockId block) const {
+        return std::binary_search(blocks.begin(), blocks.end(), block);
+    }
+};
 
-    IrFn(String&& name) : name{std::move(name)}, insts() {}
-    IrFn(String&& name, Container insts) 
-        : name{std::move(name)},
-          insts{std::move(insts)},
-          space_occupied{0} {}
+struct IrFn {
+    SymId name;
+    size_t space_occupied;
+    // In layout order, the entry first. Codegen emits them in this order.
+    std::vector<BasicBlock> blocks;
+    // Outer loops come before the loops they contain.
+    std::vector<Loop> loops;
+    // Temporaries are numbered from 0, passes take fresh ones from `new_temp`.
+    uint32_t temp_count = 0;
+    // Set between `opt::construct_ssa` and `opt::destruct_ssa`.
+    bool in_ssa = false;
+
+    IrFn(SymId name) : name{name}, space_occupied{0}, blocks(), loops() {}
+
+    Operand new_temp() {
+        return Operand::temporary(temp_count++);
+    }
 
     // Is 'inst' a label that defines a start of a function?
     bool fn_label(Instruction& inst) {
         ASSERT(inst.match_code(OpCode::Label), "instruction must be of type 'label'");
-        return name.compare(inst.dst.value()) == 0;
+        return inst.dst == Operand::label(name);
     }
 
-    void push_inst(Instruction&& inst) {
-        insts.push_back(std::move(inst));
+    size_t inst_count() const {
+        size_t count = 0;
+        for (const auto& block : blocks) {
+            count += block.insts.size();
+        }
+        return count;
     }
 
     // A string that represents the function.
@@ -3,8 +3,8 @@
 #include <expected>
 #include <algorithm>
 #include <sstream>
-#include <fstream>
 #include <cstring>
+#include <cerrno>
 #include <string>
 
 #include "common.hpp"
@@ -19,8 +19,8 @@ void Lexer::lex_eof() {
 	tok->update_location(m_cursor.cur_loc.line, m_cursor.cur_loc.col);
 }
 
-void Lexer::lex_foreign(char ch) {
-	tok->extend(ch);
+void Lexer::lex_foreign() {
+	tok->value = m_cursor.slice_from(m_cursor.pos - 1);
 	tok->kind = TokenKind::Foreign;
 	tok->update_location(m_cursor.cur_loc.line, m_cursor.cur_loc.col);
 }
@@ -30,58 +30,60 @@ void Lexer::lex_line_comment() {
 	advance_cursor();
 
 	//! Until we reached end of line we stop.
-	while(!m_cursor.reached_eof() && !m_cursor.reached_new_line()) {
-		auto _ = advance_cursor();
+	if(!m_cursor.reached_eof() && !m_cursor.reached_new_line()) {
+		m_cursor.skip_line();
 	}
 }
 
 void Lexer::lex_word() {
 	tok->update_location(m_cursor.cur_loc.line, m_cursor.cur_loc.col);
-	tok->extend(m_cursor.current);  
+	size_t start = m_cursor.pos - 1;
 
-	while(
-		!m_cursor.reached_eof() &&
-		is_alnum(m_cursor.peek_next()) || m_cursor.peek_next() == '_'
-	) {
-		tok->extend(advance_cursor());
-	}
+	m_cursor.skip_identifier();
 
 	//! Assuming that the current token is a readable, if it is followed by a '!';
 	if(m_cursor.peek_next() == '!') {
-		tok->extend(advance_cursor());
+		advance_cursor();
+		tok->value = m_cursor.slice_from(start);
 		tok->kind = TokenKind::Readable;
 		return;
 	}
 
-	if(Tokenizer::bool_from_token(*tok) != std::nullopt) {
+	tok->value = m_cursor.slice_from(start);
+
+	if(Tokenizer::bool_from_token(tok->value) != std::nullopt) {
 		tok->kind = TokenKind::LiteralBoolean;
-	} else if(Tokenizer::keyword_from_token(tok->value) != std::nullopt) {
+	} else if(auto keyword = Tokenizer::keyword_from_token(tok->value)) {
 		tok->kind = TokenKind::Keyword;
+		tok->keyword = keyword.value();
 	} else {
 		tok->kind = TokenKind::Identifier;
+		tok->sym = intern(tok->value);
 	}
 }
 
 void Lexer::lex_symbol() {
 	tok->update_location(m_cursor.cur_loc.line, m_cursor.cur_loc.col);
+	size_t start = m_cursor.pos - 1;
 
 	switch (m_cursor.current) {
-		case '(': tok->fill_with("(", TokenKind::OpenParen);    break;
-		case ')': tok->fill_with(")", TokenKind::CloseParen);   break;
-		case '{': tok->fill_with("{", TokenKind::OpenCurly);    break;
-		case '}': tok->fill_with("}", TokenKind::CloseCurly);   break;
-		case '[': tok->fill_with("[", TokenKind::OpenBracket);  break;
-		case ']': tok->fill_with("]", TokenKind::CloseBracket); break;
-		case ':': tok->fill_with(":", TokenKind::Colon);        break;
-		case ';': tok->fill_with(";", TokenKind::SemiColon);    break;
-		case ',': tok->fill_with(",", TokenKind::Comma);        break;
-		case '.': tok->fill_with(".", TokenKind::Dot);          break;
-		case '@': tok->fill_with("@", TokenKind::At);           break;
+		case '(': tok->fill_with(TokenKind::OpenParen);    break;
+		case ')': tok->fill_with(TokenKind::CloseParen);   break;
+		case '{': tok->fill_with(TokenKind::OpenCurly);    break;
+		case '}': tok->fill_with(TokenKind::CloseCurly);   break;
+		case '[': tok->fill_with(TokenKind::OpenBracket);  break;
+		case ']': tok->fill_with(TokenKind::CloseBracket); break;
+		case ':': tok->fill_with(TokenKind::Colon);        break;
+		case ';': tok->fill_with(TokenKind::SemiColon);    break;
+		case ',': tok->fill_with(TokenKind::Comma);        break;
+		case '.': tok->fill_with(TokenKind::Dot);          break;
+		case '@': tok->fill_with(TokenKind::At);           break;
 		default: break;
 	}
 
 	//! If token was assigned with a value in the above switch statement, we exit.
 	if(!tok->match_kind(TokenKind::None)) {
+		tok->value = m_cursor.slice_from(start);
 		return;
 	}
 
@@ -89,174 +91,172 @@ void Lexer::lex_symbol() {
 	{
 		case '+': {
 			if(m_cursor.peek_next() == '=') {
-				tok->fill_with("+=", TokenKind::PlusAssign);
+				tok->fill_with(TokenKind::PlusAssign);
 				advance_cursor();
 			} else {
-				tok->fill_with("+", TokenKind::Plus);
+				tok->fill_with(TokenKind::Plus);
 			}
 			break;
 		}
 		case '-': {
 			if(m_cursor.peek_next() == '=') {
-				tok->fill_with("-=", TokenKind::MinusAssign);
+				tok->fill_with(TokenKind::MinusAssign);
 				advance_cursor();
 			} else if(m_cursor.peek_next() == '>') {
-				tok->fill_with("->", TokenKind::ReturnSymbol);
+				tok->fill_with(TokenKind::ReturnSymbol);
 				advance_cursor();
 			} else {
-				tok->fill_with("-", TokenKind::Minus);
+				tok->fill_with(TokenKind::Minus);
 			}
 			break;
 		}
 		case '*': {
 			if(m_cursor.peek_next() == '=') {
-				tok->fill_with("*=", TokenKind::StarAssign);
+				tok->fill_with(TokenKind::StarAssign);
 				advance_cursor();
 			} else if(m_cursor.peek_next() == '*') {
-				tok->fill_with("**", TokenKind::DoubleStar);
+				tok->fill_with(TokenKind::DoubleStar);
 				advance_cursor();
 			} else {
-				tok->fill_with("*", TokenKind::Star);
+				tok->fill_with(TokenKind::Star);
 			}
 			break;
 		}
 		case '/': {
 			if(m_cursor.peek_next() == '=') {
-				tok->fill_with("/=", TokenKind::SlashAssign);
+				tok->fill_with(TokenKind::SlashAssign);
 				advance_cursor();
 			} else if(m_cursor.peek_next() == '/') {
-				tok->fill_with("/=", TokenKind::DoubleSlash);
+				tok->fill_with(TokenKind::DoubleSlash);
 				advance_cursor();
 			} else {
-				tok->fill_with("/", TokenKind::Slash);
+				tok->fill_with(TokenKind::Slash);
 			}
 			break;
 		}
 		case '%': {
 			if(m_cursor.peek_next() == '=') {
-				tok->fill_with("%=", TokenKind::PrecentAssign);
+				tok->fill_with(TokenKind::PrecentAssign);
 				advance_cursor();
 			} else {
-				tok->fill_with("%", TokenKind::Precent);
+				tok->fill_with(TokenKind::Precent);
 			}
 			break;
 		}
 		case '|': {
 			if(m_cursor.peek_next() == '=') {
-				tok->fill_with("|=", TokenKind::PipeAssign);
+				tok->fill_with(TokenKind::PipeAssign);
 				advance_cursor();
 			} else {
-				tok->fill_with("|", TokenKind::Pipe);
+				tok->fill_with(TokenKind::Pipe);
 			}
 			break;
 		}
 		case '^': {
 			if(m_cursor.peek_next() == '=') {
-				tok->fill_with("^=", TokenKind::HatAssign);
+				tok->fill_with(TokenKind::HatAssign);
 				advance_cursor();
 			} else {
-				tok->fill_with("^", TokenKind::Hat);
+				tok->fill_with(TokenKind::Hat);
 			}
 			break;
 		}
 		case '&': {
 			if(m_cursor.peek_next() == '=') {
-				tok->fill_with("&=", TokenKind::AmpersandAssign);
+				tok->fill_with(TokenKind::AmpersandAssign);
 				advance_cursor();
 			} else {
-				tok->fill_with("&", TokenKind::Ampersand);
+				tok->fill_with(TokenKind::Ampersand);
 			}
 			break;
 		}
 		case '<': {
 			if (m_cursor.peek_next() == '=') {
-				tok->fill_with("<=", TokenKind::Le);
+				tok->fill_with(TokenKind::Le);
 				advance_cursor();
 			} else if(m_cursor.peek_next() == '<') {
-				tok->fill_with("<<", TokenKind::ShiftLeft);
+				tok->fill_with(TokenKind::ShiftLeft);
 				advance_cursor();
 			} else {
-				tok->fill_with("<", TokenKind::OpenAngle);
+				tok->fill_with(TokenKind::OpenAngle);
 			}
 			break;
 		}
 		case '>': {
 			if (m_cursor.peek_next() == '=') {
-				tok->fill_with(">=", TokenKind::Ge);
+				tok->fill_with(TokenKind::Ge);
 				advance_cursor();
 			} else if(m_cursor.peek_next() == '>') {
-				tok->fill_with(">>", TokenKind::ShiftRight);
+				tok->fill_with(TokenKind::ShiftRight);
 				advance_cursor();
 			} else {
-				tok->fill_with(">", TokenKind::CloseAngle);
+				tok->fill_with(TokenKind::CloseAngle);
 			}
 			break;
 		}
 		case '=': {
 			if (m_cursor.peek_next() == '=') {
-				tok->fill_with("==", TokenKind::DoubleEq);
+				tok->fill_with(TokenKind::DoubleEq);
 				advance_cursor();
 			} else {
-				tok->fill_with("=", TokenKind::Eq);
+				tok->fill_with(TokenKind::Eq);
 			}
 			break;
 		}
 		case '!': {
 			if (m_cursor.peek_next() == '=') {
-				tok->fill_with("!=", TokenKind::NotEq);
+				tok->fill_with(TokenKind::NotEq);
 				advance_cursor();
 			} else {
-				tok->fill_with("!", TokenKind::Bang);
+				tok->fill_with(TokenKind::Bang);
 			}
 			break;
 		}
 		default:
-			tok->fill_with(std::string{m_cursor.current}, TokenKind::Foreign);
+			tok->fill_with(TokenKind::Foreign);
 			break;
 	}
+
+	//! Like every other lexeme, the symbol is a view into the source.
+	tok->value = m_cursor.slice_from(start);
 }
 
 void Lexer::lex_literal() {
+	// Every literal is a contiguous region of the source, starting at the current character.
+	size_t start = m_cursor.pos - 1;
+
 	// Lexes a numerical literal, either an integer or a float.
 	auto lex_numerical_literal = [&]() -> void {
-		tok->extend(m_cursor.current);
-
-		while (!m_cursor.reached_eof() && is_digit(m_cursor.peek_next())) {
-			tok->extend(advance_cursor());
-		}
+		m_cursor.skip_digits();
 
 		if(m_cursor.peek_next() == '.') {
 			// Eat the radix point.
 			advance_cursor();
-			std::string after_radix{""};
-			
-			while (!m_cursor.reached_eof() && is_digit(m_cursor.peek_next())) {
-				after_radix += advance_cursor();
-			}
+			size_t radix = m_cursor.pos;
+			m_cursor.skip_digits();
 
-			if(after_radix != "") {
-				tok->extend('.');
-				tok->value.append(after_radix);
+			if(m_cursor.pos != radix) {
+				tok->value = m_cursor.slice_from(start);
 				tok->kind = TokenKind::LiteralFloat;
 			} else {
 				m_cursor.rewind(1);
+				tok->value = m_cursor.slice_from(start);
 				tok->kind = TokenKind::LiteralNum;
 			}
 		} else {
+			tok->value = m_cursor.slice_from(start);
 			tok->kind = TokenKind::LiteralNum;
 		}
 	};
 
 	//! Lexes a string literal.
+	//! Escape sequences are kept verbatim, they are resolved when lowering into IR.
 	auto lex_string_literal = [&]() {
-		//! '"' was processed, so we consume it.
-		tok->extend(m_cursor.current);
-
 		while (!m_cursor.reached_eof()) {
 			char next_char = m_cursor.peek_next();
 
 			if (next_char == '\\') {
-				tok->extend(advance_cursor());
+				advance_cursor();
 
 				char escaped_char = advance_cursor();
 
@@ -267,18 +267,18 @@ void Lexer::lex_literal() {
 				) {
 					ASSERT(false, std::format("unexpected escape sequence, got: '\\{}'", escaped_char));
 				}
-				
-				tok->extend(escaped_char);
+
 				continue;
 			}
 
 			if (next_char == '"') {
-				tok->extend(advance_cursor());
+				advance_cursor();
+				tok->value = m_cursor.slice_from(start);
 				tok->kind = TokenKind::LiteralString;
 				return;
 			}
 
-			tok->extend(advance_cursor());
+			advance_cursor();
 		}
 
 		// If we reached this point, the string was not terminated.
@@ -288,6 +288,7 @@ void Lexer::lex_literal() {
 	// Lexes a char literal (e.g. 'a' or '\n').
 	auto lex_char_literal = [&]() {
 		advance_cursor();
+		size_t inner = m_cursor.pos - 1;
 
 		ASSERT(m_cursor.current != '\'', "a char literal must contain a character.");
 
@@ -302,14 +303,14 @@ void Lexer::lex_literal() {
 				case '\\':
 				case '\'':
 				case '0':
-					tok->value = std::string("\\") + esc; // e.g., "\\n"
+					tok->value = m_cursor.slice_from(inner); // e.g., "\\n"
 					break;
 				default:
 					ASSERT(false, std::format("unknown escape sequence '\\{}'", esc).c_str());
 			}
 		} else {
-			// Non-escaped character: store as string
-			tok->value = std::string(1, m_cursor.current);
+			// Non-escaped character: a single byte of the source.
+			tok->value = m_cursor.slice_from(inner);
 		}
 
 		// Expect closing quote
@@ -329,15 +330,15 @@ void Lexer::lex_literal() {
 	}
 }
 
-void Lexer::next_token(LazyTokenStream& token_stream) {
+bool Lexer::scan_token() {
 	m_cursor.skip_whitespace();
 	advance_cursor();
 
 	if(m_cursor.reached_new_line()) {
-		return;
+		return false;
 	} else if(m_cursor.current == '#') {
 		lex_line_comment();
-		return;
+		return false;
 	} else if(m_cursor.reached_eof()) { 
 		lex_eof();
 	} else if(is_alpha(m_cursor.current) || m_cursor.current == '_') {
@@ -347,41 +348,43 @@ void Lexer::next_token(LazyTokenStream& token_stream) {
 	} else if(is_symbol(m_cursor.current)) {
 		lex_symbol();
 	} else { 
-		lex_foreign(m_cursor.current); 
+		lex_foreign(); 
 	};
 
-	token_stream.feed(*tok);
+	return true;
+}
+
+Token Lexer::next_token() {
+	while(!scan_token()) {}
+
+	Token next = *tok;
 	tok->clean();
+	return next;
 }
 
 bool Lexer::open_and_populate_cursor() {
-	std::ifstream ifs(m_cursor.file_name, std::ios::in);
-
-	ASSERT(ifs.is_open(), "could not open: " + m_cursor.file_name, strerror(errno));
-	
-	std::string line;
-	while (std::getline(ifs, line)) {
-		m_cursor.source.push_back(line);
-	}
-	m_cursor.total_lines = m_cursor.source.size();
+	auto buffer = std::make_shared<SourceBuffer>();
 
-	ASSERT(!m_cursor.source.empty(), "cannot lex an empty file.");
+	bool opened = buffer->open(m_cursor.file_name);
+	ASSERT(opened, "could not open: " + m_cursor.file_name, strerror(errno));
+	ASSERT(buffer->total_lines() > 0, "cannot lex an empty file.");
 
-	ifs.close();
+	m_cursor.attach(std::move(buffer));
 	return true;
 }
 
 auto Lexer::lex_source() -> LazyTokenStream {
-	LazyTokenStream token_stream{};
-
 	if(!open_and_populate_cursor()) {
-		return token_stream;
+		return LazyTokenStream{};
 	}
 
+	// Token values are offsets into the source, so the stream shares ownership of it.
+	LazyTokenStream token_stream{m_cursor.source};
+
 	do {
-		next_token(token_stream);
+		token_stream.feed(next_token());
 	} while(token_stream.has_next());
 
 	token_stream.reset();
 	return token_stream;
-}
\ No newline at end of file
+}
@@ -2,24 +2,33 @@
 #define LEXER_HPP_
 
 #include <iostream>
+#include <cstring>
 #include <memory>
 #include <string>
 #include <vector>
-#include <vector>
 #include <expected>
 #include <sstream>
 
 #include "token.hpp"
 #include "diag.hpp"
+#include "source.hpp"
+#include "scan.hpp"
 
 using Tokenizer::Token;
+using Tokenizer::TokenArray;
+using Tokenizer::TokenIndex;
+using Tokenizer::TokenRef;
 using Tokenizer::TokenKind;
 using Tokenizer::Location;
 using Tokenizer::LazyTokenStream;
 
 struct SourceCursor {
     std::string file_name;
-    std::vector<std::string> source;
+    SharedPtr<SourceBuffer> source;
+    // Flat offset of the next byte to be consumed.
+    size_t pos = 0;
+    // One past the last byte that can be consumed.
+    size_t end = 0;
     Location cur_loc = Location::Singularity();
     char current = 0;
     int total_lines = 0;
@@ -28,55 +37,113 @@ struct SourceCursor {
     explicit SourceCursor(std::string filename) 
         : file_name(std::move(filename)), source() {}
 
+    // Binds the cursor to a loaded buffer and moves it to the first byte.
+    void attach(SharedPtr<SourceBuffer> buffer) {
+        source = std::move(buffer);
+        pos = 0;
+        end = source->content_end();
+        total_lines = source->total_lines();
+        cur_loc = Location::Singularity();
+        current = 0;
+        eof = false;
+    }
+
     // Advances the cursor, using pre-increments.
     // This is makes peeking easier just by using `cur_loc.col` instead of incrementing once again.
     char advance_self() {
-        if (cur_loc.col == source[cur_loc.line].size()) {
-            if (cur_loc.line + 1 < total_lines) {
-                cur_loc.line++;
-                cur_loc.col = 0;
-                current = '\n';
-                return current;
-            } else {
-                eof = true;
-                return '\0';
-            }
-        } else {
-            current = source[cur_loc.line][cur_loc.col++];
+        if (pos >= end) {
+            eof = true;
+            current = '\0';
             return current;
         }
+        current = source->data()[pos++];
+        if (current == '\n') {
+            cur_loc.line++;
+            cur_loc.col = 0;
+        } else {
+            cur_loc.col++;
+        }
+        return current;
     }
 
-    // Peeks the next character safely.
-    char peek_next(int step_size = 0) {
-        if (cur_loc.col + step_size < source[cur_loc.line].size()) {
-            return source[cur_loc.line][cur_loc.col + step_size];
+    // Consumes every byte up to `stop` at once, keeping the location in sync.
+    // Equivalent to calling `advance_self` until `pos == stop`.
+    void advance_to(size_t stop) {
+        if (stop <= pos) {
+            return;
         }
-        if (cur_loc.line + 1 < total_lines) {
-            if (step_size < source[cur_loc.line + 1].size()) {
-                return source[cur_loc.line + 1][step_size];
-            }
+
+        const char* data = source->data();
+        const char* cur = data + pos;
+        const char* last = data + stop;
+        const char* last_nl = nullptr;
+        int lines = 0;
+
+        while (const char* nl = static_cast<const char*>(std::memchr(cur, '\n', last - cur))) {
+            lines++;
+            last_nl = nl;
+            cur = nl + 1;
+        }
+
+        if (last_nl != nullptr) {
+            cur_loc.line += lines;
+            cur_loc.col = static_cast<int>(last - (last_nl + 1));
+        } else {
+            cur_loc.col += static_cast<int>(stop - pos);
+        }
+
+        current = data[stop - 1];
+        pos = stop;
+    }
+
+    // Peeks the next character safely.
+    char peek_next(int step_size = 0) const {
+        if (pos + step_size < end) {
+            return source->data()[pos + step_size];
         }
         return '\0';
     }
 
-    // Rewinds the cursor `step_size` bytes back.
+    // The bytes between `start` and the cursor, viewed in place.
+    std::string_view slice_from(size_t start) const {
+        return { source->data() + start, pos - start };
+    }
+
+    // Rewinds the cursor `step_size` bytes back, never past the start of the current line.
     void rewind(int step_size) {
         ASSERT(step_size > 0, "Cannot rewind lexer.SourceCursor with a negative step_size");
-        if(cur_loc.col >= step_size) {
-            cur_loc.col -= step_size;
-        } else {
-            cur_loc.col = 0;
-        }
+        int step = std::min(step_size, cur_loc.col);
+        cur_loc.col -= step;
+        pos -= step;
     }
 
     void skip_whitespace() {
-        while (
-            !reached_eof() &&
-            std::isspace(static_cast<unsigned char>(peek_next()))
-        ) {
-            advance_self();
+        if (reached_eof()) {
+            return;
+        }
+        advance_to(scan::whitespace(source->data(), pos, end));
+    }
+
+    // Consumes the run of identifier characters following the cursor.
+    void skip_identifier() {
+        advance_to(scan::identifier(source->data(), pos, end));
+    }
+
+    // Consumes the run of digits following the cursor.
+    void skip_digits() {
+        advance_to(scan::digits(source->data(), pos, end));
+    }
+
+    // Consumes the rest of the line, including the line break if there is one.
+    void skip_line() {
+        size_t stop = scan::line(source->data(), pos, end);
+        if (stop < end) {
+            advance_to(stop + 1);
+            return;
         }
+        advance_to(end);
+        // Like reading past the last byte one at a time, ends up at eof.
+        advance_self();
     }
 
     bool reached_new_line() const {
@@ -87,16 +154,14 @@ struct SourceCursor {
         return eof;
     }
 
-    std::vector<std::string> one_lined_region(int line = -1) {
-        std::vector<std::string> region(1, "");
-
+    // A view of a single source line, defaults to the line under the cursor.
+    std::string_view one_lined_region(int line = -1) const {
         int target_line = (line == -1) ? cur_loc.line : line;
 
         if (target_line >= 0 && target_line < total_lines) {
-            region[0] = source[target_line];
+            return source->line(target_line);
         }
-
-        return region;
+        return {};
     }
 };
 
@@ -116,8 +181,13 @@ public:
 
     bool open_and_populate_cursor();
     
+    // Lexes the whole source up front.
     LazyTokenStream lex_source();
 
+    // Lexes on demand, returns the next token of an opened source.
+    // Once the source is exhausted every call returns an `Eof` token.
+    Token next_token();
+
 private:
     Ptr<Token> tok;
     SourceCursor m_cursor;
@@ -127,13 +197,14 @@ private:
     }
 
     void lex_eof();
-    void lex_foreign(char ch);
+    void lex_foreign();
     void lex_line_comment();
 
     void lex_word();
     void lex_literal();
     void lex_symbol();
-    void next_token(LazyTokenStream& token_stream);
+    // Lexes a single lexeme, returns false if it does not produce a token (e.g a comment).
+    bool scan_token();
 
     inline void push_diagnostic(const Diagnostic& diag) { diags.push(diag); }
 };
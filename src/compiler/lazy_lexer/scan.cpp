@@ -0,0 +1,188 @@
+#include "scan.hpp"
+
+#if defined(__x86_64__) || defined(__i386__)
+#define SCAN_X86 1
+#include <immintrin.h>
+#endif
+
+namespace {
+
+enum class CharClass {
+    Whitespace,
+    Identifier,
+    Digit,
+    Line
+};
+
+template<CharClass C>
+inline bool in_class(unsigned char c) {
+    if constexpr (C == CharClass::Whitespace) {
+        return c == ' ' || static_cast<unsigned char>(c - '\t') <= '\r' - '\t';
+    } else if constexpr (C == CharClass::Identifier) {
+        return static_cast<unsigned char>((c | 0x20) - 'a') <= 'z' - 'a'
+            || static_cast<unsigned char>(c - '0') <= 9
+            || c == '_';
+    } else if constexpr (C == CharClass::Digit) {
+        return static_cast<unsigned char>(c - '0') <= 9;
+    } else {
+        return c != '\n' && c != '\r';
+    }
+}
+
+template<CharClass C>
+size_t run_scalar(const char* data, size_t from, size_t end) {
+    while (from < end && in_class<C>(static_cast<unsigned char>(data[from]))) {
+        ++from;
+    }
+    return from;
+}
+
+#ifdef SCAN_X86
+
+// Bytes of `v` that fall in [lo, lo + span], compared as unsigned.
+inline __m128i in_range_sse2(__m128i v, char lo, char span) {
+    __m128i shifted = _mm_sub_epi8(v, _mm_set1_epi8(lo));
+    return _mm_cmpeq_epi8(_mm_min_epu8(shifted, _mm_set1_epi8(span)), shifted);
+}
+
+// 0xFF for every byte of `v` that belongs to the run.
+template<CharClass C>
+inline __m128i classify_sse2(__m128i v) {
+    if constexpr (C == CharClass::Whitespace) {
+        return _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8(' ')), in_range_sse2(v, '\t', '\r' - '\t'));
+    } else if constexpr (C == CharClass::Identifier) {
+        __m128i alpha = in_range_sse2(_mm_or_si128(v, _mm_set1_epi8(0x20)), 'a', 'z' - 'a');
+        __m128i digit = in_range_sse2(v, '0', 9);
+        __m128i under = _mm_cmpeq_epi8(v, _mm_set1_epi8('_'));
+        return _mm_or_si128(_mm_or_si128(alpha, digit), under);
+    } else if constexpr (C == CharClass::Digit) {
+        return in_range_sse2(v, '0', 9);
+    } else {
+        __m128i breaks = _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('\n')), _mm_cmpeq_epi8(v, _mm_set1_epi8('\r')));
+        return _mm_xor_si128(breaks, _mm_set1_epi8(-1));
+    }
+}
+
+template<CharClass C>
+size_t run_sse2(const char* data, size_t from, size_t end) {
+    while (end - from >= 16) {
+        __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + from));
+        unsigned outside = ~static_cast<unsigned>(_mm_movemask_epi8(classify_sse2<C>(block))) & 0xFFFFu;
+        if (outside != 0) {
+            return from + __builtin_ctz(outside);
+        }
+        from += 16;
+    }
+    return run_scalar<C>(data, from, end);
+}
+
+__attribute__((target("avx2")))
+inline __m256i in_range_avx2(__m256i v, char lo, char span) {
+    __m256i shifted = _mm256_sub_epi8(v, _mm256_set1_epi8(lo));
+    return _mm256_cmpeq_epi8(_mm256_min_epu8(shifted, _mm256_set1_epi8(span)), shifted);
+}
+
+template<CharClass C>
+__attribute__((target("avx2")))
+inline __m256i classify_avx2(__m256i v) {
+    if constexpr (C == CharClass::Whitespace) {
+        return _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8(' ')), in_range_avx2(v, '\t', '\r' - '\t'));
+    } else if constexpr (C == CharClass::Identifier) {
+        __m256i alpha = in_range_avx2(_mm256_or_si256(v, _mm256_set1_epi8(0x20)), 'a', 'z' - 'a');
+        __m256i digit = in_range_avx2(v, '0', 9);
+        __m256i under = _mm256_cmpeq_epi8(v, _mm256_set1_epi8('_'));
+        return _mm256_or_si256(_mm256_or_si256(alpha, digit), under);
+    } else if constexpr (C == CharClass::Digit) {
+        return in_range_avx2(v, '0', 9);
+    } else {
+        __m256i breaks = _mm256_or_si256(
+            _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\n')),
+            _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\r'))
+        );
+        return _mm256_xor_si256(breaks, _mm256_set1_epi8(-1));
+    }
+}
+
+template<CharClass C>
+__attribute__((target("avx2")))
+size_t run_avx2(const char* data, size_t from, size_t end) {
+    while (end - from >= 32) {
+        __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + from));
+        unsigned outside = ~static_cast<unsigned>(_mm256_movemask_epi8(classify_avx2<C>(block)));
+        if (outside != 0) {
+            return from + __builtin_ctz(outside);
+        }
+        from += 32;
+    }
+    // Finish the tail 16 bytes at a time.
+    return run_sse2<C>(data, from, end);
+}
+
+#endif // SCAN_X86
+
+using Kernel = size_t (*)(const char*, size_t, size_t);
+
+struct Kernels {
+    Kernel whitespace;
+    Kernel identifier;
+    Kernel digits;
+    Kernel line;
+    const char* isa;
+};
+
+template<template<CharClass> class Impl>
+constexpr Kernels make_kernels(const char* isa) {
+    return Kernels {
+        Impl<CharClass::Whitespace>::run,
+        Impl<CharClass::Identifier>::run,
+        Impl<CharClass::Digit>::run,
+        Impl<CharClass::Line>::run,
+        isa
+    };
+}
+
+template<CharClass C> struct Scalar { static constexpr Kernel run = run_scalar<C>; };
+#ifdef SCAN_X86
+template<CharClass C> struct Sse2 { static constexpr Kernel run = run_sse2<C>; };
+template<CharClass C> struct Avx2 { static constexpr Kernel run = run_avx2<C>; };
+#endif
+
+Kernels select_kernels() {
+#ifdef SCAN_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        return make_kernels<Avx2>("avx2");
+    }
+    if (__builtin_cpu_supports("sse2")) {
+        return make_kernels<Sse2>("sse2");
+    }
+#endif
+    return make_kernels<Scalar>("scalar");
+}
+
+const Kernels& kernels() {
+    static const Kernels selected = select_kernels();
+    return selected;
+}
+
+} // namespace
+
+size_t scan::whitespace(const char* data, size_t from, size_t end) {
+    return kernels().whitespace(data, from, end);
+}
+
+size_t scan::identifier(const char* data, size_t from, size_t end) {
+    return kernels().identifier(data, from, end);
+}
+
+size_t scan::digits(const char* data, size_t from, size_t end) {
+    return kernels().digits(data, from, end);
+}
+
+size_t scan::line(const char* data, size_t from, size_t end) {
+    return kernels().line(data, from, end);
+}
+
+const char* scan::isa() {
+    return kernels().isa;
+}
@@ -0,0 +1,29 @@
+#ifndef SCAN_HPP_
+#define SCAN_HPP_
+
+#include <cstddef>
+
+/// @brief `scan`
+/// Kernels that find the end of a run of characters of the same class.
+/// Each kernel looks at `data[from, end)` and returns the offset of the first byte outside the run, or `end`.
+/// The widest implementation the CPU supports (AVX2, SSE2 or scalar) is chosen once, on first use.
+namespace scan {
+
+// Whitespace as classified by `std::isspace` in the "C" locale: ' ', '\t', '\n', '\v', '\f', '\r'.
+size_t whitespace(const char* data, size_t from, size_t end);
+
+// Identifier characters: [A-Za-z0-9_].
+size_t identifier(const char* data, size_t from, size_t end);
+
+// Decimal digits: [0-9].
+size_t digits(const char* data, size_t from, size_t end);
+
+// Anything but a line break, so the returned offset points at the first '\n' or '\r'.
+size_t line(const char* data, size_t from, size_t end);
+
+// Name of the selected implementation, e.g "avx2".
+const char* isa();
+
+} // namespace scan
+
+#endif // SCAN_HPP_
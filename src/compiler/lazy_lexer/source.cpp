@@ -0,0 +1,110 @@
+#include <cerrno>
+#include <cstring>
+#include <limits>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "source.hpp"
+
+SourceBuffer::~SourceBuffer() {
+    if (m_map != nullptr) {
+        munmap(m_map, m_map_size);
+    }
+}
+
+bool SourceBuffer::open(const std::string& path) {
+    bool from_stdin = path == "-";
+    int fd = from_stdin ? STDIN_FILENO : ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+
+    struct stat st{};
+    bool loaded = false;
+
+    // Only regular files can be mapped, stdin and pipes are streamed instead.
+    if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {
+        loaded = map_file(fd, static_cast<size_t>(st.st_size));
+    }
+    if (!loaded) {
+        loaded = read_stream(fd);
+    }
+
+    // Closing must not hide why reading failed.
+    int error = errno;
+    if (!from_stdin) {
+        ::close(fd);
+    }
+
+    if (!loaded) {
+        errno = error;
+        return false;
+    }
+    index_lines();
+    return true;
+}
+
+bool SourceBuffer::map_file(int fd, size_t size) {
+    void* region = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (region == MAP_FAILED) {
+        return false;
+    }
+
+    // The lexer walks the buffer front to back exactly once.
+    madvise(region, size, MADV_SEQUENTIAL);
+
+    m_map = region;
+    m_map_size = size;
+    m_data = static_cast<const char*>(region);
+    m_size = size;
+    return true;
+}
+
+bool SourceBuffer::read_stream(int fd) {
+    static CONST size_t CHUNK_SIZE = 1 << 16;
+
+    m_owned.clear();
+    char chunk[CHUNK_SIZE];
+
+    while (true) {
+        ssize_t n = ::read(fd, chunk, CHUNK_SIZE);
+        if (n == 0) {
+            break;
+        }
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        m_owned.append(chunk, static_cast<size_t>(n));
+    }
+
+    m_data = m_owned.data();
+    m_size = m_owned.size();
+    return true;
+}
+
+void SourceBuffer::index_lines() {
+    ASSERT(
+        m_size < std::numeric_limits<Offset>::max(),
+        "source files larger than 4GiB are not supported."
+    );
+
+    m_line_starts.clear();
+    if (m_size == 0) {
+        return;
+    }
+
+    m_line_starts.push_back(0);
+
+    const char* cur = m_data;
+    const char* end = m_data + m_size;
+    while (const char* nl = static_cast<const char*>(std::memchr(cur, '\n', end - cur))) {
+        cur = nl + 1;
+        if (cur == end) {
+            break;
+        }
+        m_line_starts.push_back(static_cast<Offset>(cur - m_data));
+    }
+}
@@ -0,0 +1,89 @@
+#ifndef SOURCE_HPP_
+#define SOURCE_HPP_
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cstdint>
+
+#include "alias.hpp"
+#include "common.hpp"
+
+/// @brief `SourceBuffer`
+/// Owns the bytes of a single source file as one contiguous region.
+/// Regular files are memory-mapped, anything else (stdin, pipes, fifos) is read into an owned buffer.
+/// A line-start table is built once, so lines can be sliced without copying.
+class SourceBuffer {
+public:
+    using Offset = uint32_t;
+
+    SourceBuffer() = default;
+    ~SourceBuffer();
+
+    SourceBuffer(const SourceBuffer&) = delete;
+    SourceBuffer& operator=(const SourceBuffer&) = delete;
+
+    // Loads `path` into the buffer and indexes its lines.
+    // A `path` of '-' reads stdin.
+    // Returns false if the file could not be opened or read, `errno` then holds the failure.
+    bool open(const std::string& path);
+
+    inline const char* data() const {
+        return m_data;
+    }
+
+    inline size_t size() const {
+        return m_size;
+    }
+
+    // Was the file memory-mapped or read through the fallback path?
+    inline bool mapped() const {
+        return m_map != nullptr;
+    }
+
+    // Same semantics as reading the file with `std::getline`.
+    // A trailing newline does not open a new line.
+    inline int total_lines() const {
+        return static_cast<int>(m_line_starts.size());
+    }
+
+    inline size_t line_start(int line) const {
+        return m_line_starts[line];
+    }
+
+    // One past the last byte of `line`, the newline itself is excluded.
+    inline size_t line_end(int line) const {
+        if (line + 1 < total_lines()) {
+            return m_line_starts[line + 1] - 1;
+        }
+        return (m_size > 0 && m_data[m_size - 1] == '\n') ? m_size - 1 : m_size;
+    }
+
+    inline std::string_view line(int line) const {
+        return { m_data + line_start(line), line_end(line) - line_start(line) };
+    }
+
+    // One past the last byte that belongs to the source lines.
+    inline size_t content_end() const {
+        return total_lines() == 0 ? 0 : line_end(total_lines() - 1);
+    }
+
+private:
+    const char* m_data = nullptr;
+    size_t m_size = 0;
+
+    // Mapping of a regular file.
+    void* m_map = nullptr;
+    size_t m_map_size = 0;
+
+    // Fallback storage for non-mappable inputs.
+    std::string m_owned;
+
+    std::vector<Offset> m_line_starts;
+
+    bool map_file(int fd, size_t size);
+    bool read_stream(int fd);
+    void index_lines();
+};
+
+#endif // SOURCE_HPP_
@@ -3,6 +3,10 @@
 #include "token.hpp"
 
 using Tokenizer::Token;
+using Tokenizer::TokenRef;
+using Tokenizer::TokenArray;
+using Tokenizer::TokenIndex;
+using Tokenizer::Location;
 using Tokenizer::TokenKind;
 using Tokenizer::LiteralKind;
 using Tokenizer::Keyword;
@@ -11,25 +15,6 @@ using Tokenizer::UnOpKind;
 using Tokenizer::AssignOp;
 using Tokenizer::BooleanKind;
 
-Option<Keyword> Tokenizer::keyword_from_token(const std::string& lexeme) {
-  if(lexeme == "import")     return Keyword::Import;
-  if(lexeme == "fn")     return Keyword::Fn;
-  if(lexeme == "end")    return Keyword::End;
-  if(lexeme == "return") return Keyword::Return;
-  if(lexeme == "if")     return Keyword::If;
-  if(lexeme == "else")   return Keyword::Else; 
-  if(lexeme == "let")    return Keyword::Let;
-  if(lexeme == "mut")    return Keyword::Mut;
-  if(lexeme == "loop")   return Keyword::Loop;
-  if(lexeme == "break")  return Keyword::Break;
-  if(lexeme == "with")   return Keyword::With;
-  if(lexeme == "and")    return Keyword::And;
-  if(lexeme == "or")     return Keyword::Or;
-  if(lexeme == "not")    return Keyword::Not;
-  if(lexeme == "ptr")    return Keyword::Ptr;
-  return std::nullopt;
-}
-
 Option<LiteralKind> Tokenizer::lit_from_tok(const TokenKind& kind) {
   switch (kind) {
     case TokenKind::LiteralNum:     return LiteralKind::Int;
@@ -42,8 +27,8 @@ Option<LiteralKind> Tokenizer::lit_from_tok(const TokenKind& kind) {
   }
 }
 
-Option<BinOpKind> Tokenizer::bin_op_from_token(const Token& tok) {
-  switch (tok.kind) {
+Option<BinOpKind> Tokenizer::bin_op_from_token(TokenRef tok) {
+  switch (tok.kind()) {
     case TokenKind::Plus:         return BinOpKind::Add;
     case TokenKind::Minus:        return BinOpKind::Sub;
     case TokenKind::Star:         return BinOpKind::Mul;
@@ -62,25 +47,21 @@ Option<BinOpKind> Tokenizer::bin_op_from_token(const Token& tok) {
     case TokenKind::Ge:           return BinOpKind::Ge;
     case TokenKind::DoubleEq:     return BinOpKind::Eq;
     case TokenKind::NotEq:        return BinOpKind::NotEq;
-    default: {
-      auto keyword_match = keyword_from_token(tok.value);
-
-      if(!keyword_match.has_value()) {
-        return std::nullopt;
-      }
-
-      switch (keyword_match.value()) {
+    case TokenKind::Keyword: {
+      switch (tok.keyword()) {
         case Keyword::And:  return BinOpKind::And;
         case Keyword::Or:   return BinOpKind::Or;
         default: 
           return std::nullopt;
       }
     }
+    default:
+      return std::nullopt;
   }
 }
 
-Option<UnOpKind> Tokenizer::un_op_from_token(const Token& tok) {
-  switch (tok.kind) {
+Option<UnOpKind> Tokenizer::un_op_from_token(TokenRef tok) {
+  switch (tok.kind()) {
     case TokenKind::Bang: return UnOpKind::BitNot;
     case TokenKind::Minus: return UnOpKind::Neg;
     case TokenKind::At: return UnOpKind::Dereference;
@@ -95,8 +76,8 @@ Option<UnOpKind> Tokenizer::un_op_from_token(const Token& tok) {
   }
 }
 
-Option<AssignOp> Tokenizer::assign_op_from_token(const Token& tok) {
-  switch (tok.kind) {
+Option<AssignOp> Tokenizer::assign_op_from_token(TokenRef tok) {
+  switch (tok.kind()) {
     case TokenKind::Eq: return AssignOp::Eq;
     case TokenKind::StarAssign: return AssignOp::Mul;
     case TokenKind::SlashAssign: return AssignOp::Div;
@@ -113,9 +94,9 @@ Option<AssignOp> Tokenizer::assign_op_from_token(const Token& tok) {
   }
 }
 
-Option<BooleanKind> Tokenizer::bool_from_token(const Token& tok) {
-  if(tok.value == "true")  return BooleanKind::True;
-  if(tok.value == "false") return BooleanKind::False;
+Option<BooleanKind> Tokenizer::bool_from_token(std::string_view value) {
+  if(value == "true")  return BooleanKind::True;
+  if(value == "false") return BooleanKind::False;
   return std::nullopt;
 }
 
@@ -275,4 +256,66 @@ void Token::out() const {
             << "    column: " << loc.col << "\n"
             << "  }\n"
             << "}\n";
-}
\ No newline at end of file
+}
+
+TokenArray::TokenArray(SharedPtr<SourceBuffer> source, size_t ring_capacity)
+  : m_source(std::move(source)) {
+  if (ring_capacity == 0) {
+    return;
+  }
+
+  ASSERT((ring_capacity & (ring_capacity - 1)) == 0, "token ring capacity must be a power of two.");
+  m_mask = ring_capacity - 1;
+  m_kinds.resize(ring_capacity);
+  m_offsets.resize(ring_capacity);
+  m_lengths.resize(ring_capacity);
+  m_locs.resize(ring_capacity);
+  m_payloads.resize(ring_capacity);
+}
+
+void TokenArray::push(const Token& token) {
+  size_t offset = 0;
+  if (!token.value.empty()) {
+    offset = static_cast<size_t>(token.value.data() - m_source->data());
+    ASSERT(
+      offset + token.value.size() <= m_source->size(),
+      "token value does not point into the source buffer."
+    );
+  }
+
+  uint32_t payload = 0;
+  if (token.kind == TokenKind::Identifier) {
+    payload = token.sym.id;
+  } else if (token.kind == TokenKind::Keyword) {
+    payload = static_cast<uint32_t>(token.keyword);
+  }
+
+  uint8_t kind = static_cast<uint8_t>(token.kind);
+  auto length = static_cast<SourceBuffer::Offset>(token.value.size());
+  uint64_t loc = (static_cast<uint64_t>(static_cast<uint32_t>(token.loc.line)) << 32)
+               | static_cast<uint32_t>(token.loc.col);
+
+  size_t s = slot(static_cast<TokenIndex>(m_count));
+  if (s == m_kinds.size()) {
+    m_kinds.push_back(kind);
+    m_offsets.push_back(static_cast<SourceBuffer::Offset>(offset));
+    m_lengths.push_back(length);
+    m_locs.push_back(loc);
+    m_payloads.push_back(payload);
+  } else {
+    m_kinds[s] = kind;
+    m_offsets[s] = static_cast<SourceBuffer::Offset>(offset);
+    m_lengths[s] = length;
+    m_locs[s] = loc;
+    m_payloads[s] = payload;
+  }
+  m_count++;
+}
+
+Token TokenArray::at(TokenIndex i) const {
+  Location l = loc(i);
+  Token token(kind(i), value(i), l.line, l.col);
+  token.sym = sym(i);
+  token.keyword = keyword(i);
+  return token;
+}
@@ -1,18 +1,23 @@
 #ifndef TOKEN_HPP_
 #define TOKEN_HPP_
 
+#include <array>
+#include <cstdint>
 #include <vector>
 #include <string>
+#include <string_view>
 #include <variant>
 #include <unordered_map>
 #include <algorithm>
 
 #include "alias.hpp"
 #include "common.hpp"
+#include "intern.hpp"
+#include "source.hpp"
 
 namespace Tokenizer {
 
-enum class TokenKind: int {
+enum class TokenKind: uint8_t {
     //!
     //! Literals
     LiteralNum,
@@ -236,9 +241,98 @@ enum class UnOpKind: int {
     AddrOf
 };
 
+namespace keywords {
+
+struct Entry {
+    std::string_view lexeme;
+    Keyword keyword;
+};
+
+inline constexpr Entry TABLE[] = {
+    { "import", Keyword::Import },
+    { "fn",     Keyword::Fn     },
+    { "end",    Keyword::End    },
+    { "return", Keyword::Return },
+    { "if",     Keyword::If     },
+    { "else",   Keyword::Else   },
+    { "let",    Keyword::Let    },
+    { "mut",    Keyword::Mut    },
+    { "loop",   Keyword::Loop   },
+    { "break",  Keyword::Break  },
+    { "with",   Keyword::With   },
+    { "and",    Keyword::And    },
+    { "or",     Keyword::Or     },
+    { "not",    Keyword::Not    },
+    { "ptr",    Keyword::Ptr    },
+};
+
+inline constexpr size_t COUNT = std::size(TABLE);
+inline constexpr size_t MIN_LEN = std::ranges::min(TABLE, {}, [](const Entry& e) { return e.lexeme.size(); }).lexeme.size();
+inline constexpr size_t MAX_LEN = std::ranges::max(TABLE, {}, [](const Entry& e) { return e.lexeme.size(); }).lexeme.size();
+
+// Number of slots in the hash table, a power of two.
+inline constexpr unsigned SLOT_BITS = 6;
+inline constexpr size_t SLOTS = size_t{1} << SLOT_BITS;
+inline constexpr uint8_t EMPTY = 0xFF;
+
+static_assert(COUNT < SLOTS, "the keyword table must have more slots than keywords.");
+
+// Mixes the length with the first and the last character, then keeps the top bits of a multiplicative hash.
+constexpr size_t hash(std::string_view s, uint32_t seed) {
+    uint32_t key = (static_cast<uint32_t>(static_cast<unsigned char>(s.front())) << 16)
+                 | (static_cast<uint32_t>(static_cast<unsigned char>(s.back())) << 8)
+                 | static_cast<uint32_t>(s.size());
+    return static_cast<uint32_t>(key * seed) >> (32 - SLOT_BITS);
+}
+
+constexpr bool collision_free(uint32_t seed) {
+    bool used[SLOTS] = {};
+    for (const Entry& e : TABLE) {
+        size_t slot = hash(e.lexeme, seed);
+        if (used[slot]) return false;
+        used[slot] = true;
+    }
+    return true;
+}
+
+// Searches for the first odd multiplier that maps every keyword into its own slot.
+constexpr uint32_t find_seed() {
+    for (uint32_t seed = 0x9E3779B1u; ; seed += 2) {
+        if (collision_free(seed)) return seed;
+    }
+}
+
+inline constexpr uint32_t SEED = find_seed();
+
+// Slot -> index into `TABLE`, or `EMPTY`.
+inline constexpr auto SLOT_TABLE = [] {
+    std::array<uint8_t, SLOTS> slots{};
+    slots.fill(EMPTY);
+    for (size_t i = 0; i < COUNT; ++i) {
+        slots[hash(TABLE[i].lexeme, SEED)] = static_cast<uint8_t>(i);
+    }
+    return slots;
+}();
+
+} // namespace keywords
+
 // Converts the value of a token into a keyword.
 // Returns an optional wrapping a `Tokenizer::Keyword` or an `std::nullopt`.
-Option<Keyword> keyword_from_token(const std::string& lexeme);
+// A perfect hash generated at compile time picks the only candidate, so at most one comparison is made.
+constexpr Option<Keyword> keyword_from_token(std::string_view lexeme) {
+    if (lexeme.size() < keywords::MIN_LEN || lexeme.size() > keywords::MAX_LEN) {
+        return std::nullopt;
+    }
+    uint8_t index = keywords::SLOT_TABLE[keywords::hash(lexeme, keywords::SEED)];
+    if (index == keywords::EMPTY || keywords::TABLE[index].lexeme != lexeme) {
+        return std::nullopt;
+    }
+    return keywords::TABLE[index].keyword;
+}
+
+static_assert(keyword_from_token("return") == Keyword::Return);
+static_assert(keyword_from_token("ptr") == Keyword::Ptr);
+static_assert(!keyword_from_token("main").has_value());
 
 // Converts a `Tokenizer::TokenKind` into a `Tokenizer::LiteralKind`.
 // Returns an optional wrapping a `Tokenizer::LiteralKind` or an `std::nullopt`.
@@ -250,27 +344,37 @@ std::string bin_op_str(const BinOpKind& kind);
 std::string un_op_str(const UnOpKind& kind);
 std::string assign_op_str(const AssignOp& kind);
 
-// A wrapper for `[std::string]`.
+// A wrapper for an interned name.
 struct Identifier {
-    std::string _ident;
+    SymId _ident;
 
     Identifier() = default;
-    Identifier(std::string ident) : _ident(ident) {};
+    Identifier(SymId ident) : _ident(ident) {};
+    Identifier(std::string_view ident) : _ident(intern(ident)) {};
+    Identifier(const std::string& ident) : _ident(intern(ident)) {};
     
-    std::string as_str() const noexcept {
+    SymId id() const noexcept {
         return _ident;
     }
 
-    bool matches(const std::string& s) const noexcept {
-        return _ident == s;
+    std::string_view str() const noexcept {
+        return _ident.str();
+    }
+
+    std::string as_str() const noexcept {
+        return _ident.as_str();
+    }
+
+    bool matches(std::string_view s) const noexcept {
+        return _ident.str() == s;
     }
 
     bool cmp(const Identifier& s) const noexcept {
-        return s.matches(_ident);
+        return _ident == s._ident;
     }
 
-    void set(std::string&& s) noexcept {
-        _ident.assign(s);
+    void set(SymId s) noexcept {
+        _ident = s;
     }
 };
 
@@ -295,31 +399,33 @@ struct Location {
 
 /// @brief `Tokenizer::Token`
 /// Is a struct that stores information about a specific lexeme found within the source code.
+/// The lexeme is a view into the source buffer.
 struct Token {
     TokenKind kind;
-    std::string value;
+    std::string_view value;
     Location loc;
+    // Interned name of identifiers, left empty for any other kind.
+    SymId sym;
+    // Classified once by the lexer, only meaningful if `kind` is `TokenKind::Keyword`.
+    Keyword keyword;
 
-    Token() : kind{TokenKind::None}, value{}, loc{Location::Singularity()} {}
+    Token() : kind{TokenKind::None}, value{}, loc{Location::Singularity()}, sym{}, keyword{} {}
 
-    Token(TokenKind k, std::string v, int l, int c)
-        : kind{k}, value{std::move(v)}, loc{l, c} {}
+    Token(TokenKind k, std::string_view v, int l, int c)
+        : kind{k}, value{v}, loc{l, c}, sym{}, keyword{} {}
 
     // Pretty-prints the tokens data.
     void out() const;
 
     // Resets the token.
     void clean() {
-        value.clear();
+        value = {};
+        sym = {};
+        keyword = {};
         kind = TokenKind::None;
         loc = Location::Singularity();
     }
 
-    // Appends a character to the token's value.
-    void extend(char ch) {
-        value += ch;
-    }
-
     // Checks if the token matches a specific `Tokenizer::TokenKind`.
     // A single-match closure is used a lot within the compiler frontend, so we created a seperate function.
     bool match_kind(TokenKind k) const {
@@ -335,15 +441,12 @@ struct Token {
     // Checks if the token represents a keyword.
     template<typename... Kw>
     bool match_keyword(Kw... keywords) const {
-        if(!match_kind(TokenKind::Keyword)) return false;
-        auto keyword_match = Tokenizer::keyword_from_token(value);
-        return keyword_match.has_value() && ((keyword_match.value() == keywords) || ...);
+        return match_kind(TokenKind::Keyword) && ((keyword == keywords) || ...);
     }
 
-    // Populates the token with new values.
-    void fill_with(std::string v, TokenKind k) {
+    // Populates the token with a new kind, the lexer points its value into the source.
+    void fill_with(TokenKind k) {
         kind = k;
-        value = std::move(v);
     }
 
     // Updates the tokens location in the source code.
@@ -352,13 +455,125 @@ struct Token {
     }
 };
 
+// Position of a token within a `Tokenizer::TokenArray`.
+using TokenIndex = uint32_t;
+
+/// @brief `Tokenizer::TokenArray`
+/// Stores tokens as a structure of arrays, one array per field.
+/// Kinds are single bytes, so the parser's kind checks touch a fraction of the memory a `Token` would.
+/// Values are offsets into the source buffer, which the array keeps alive.
+/// Given a power-of-two capacity, the array acts as a ring that only remembers the latest tokens.
+class TokenArray {
+public:
+    TokenArray() = default;
+    explicit TokenArray(SharedPtr<SourceBuffer> source, size_t ring_capacity = 0);
+
+    // Appends a token, its value must point into the source buffer.
+    void push(const Token& token);
+
+    // Tokens pushed so far, including the ones a ring already dropped.
+    inline size_t size() const {
+        return m_count;
+    }
+
+    inline bool empty() const {
+        return m_count == 0;
+    }
+
+    inline TokenKind kind(TokenIndex i) const {
+        return static_cast<TokenKind>(m_kinds[slot(i)]);
+    }
+
+    inline std::string_view value(TokenIndex i) const {
+        size_t s = slot(i);
+        return { m_source->data() + m_offsets[s], m_lengths[s] };
+    }
+
+    inline Location loc(TokenIndex i) const {
+        uint64_t packed = m_locs[slot(i)];
+        return { static_cast<int>(packed >> 32), static_cast<int>(static_cast<uint32_t>(packed)) };
+    }
+
+    inline SymId sym(TokenIndex i) const {
+        return kind(i) == TokenKind::Identifier ? SymId{ m_payloads[slot(i)] } : SymId{};
+    }
+
+    inline Keyword keyword(TokenIndex i) const {
+        return kind(i) == TokenKind::Keyword ? static_cast<Keyword>(m_payloads[slot(i)]) : Keyword{};
+    }
+
+    // Rebuilds the full token at `i`.
+    Token at(TokenIndex i) const;
+
+private:
+    SharedPtr<SourceBuffer> m_source;
+    // All ones for an unbounded array, `capacity - 1` for a ring.
+    size_t m_mask = SIZE_MAX;
+    size_t m_count = 0;
+
+    std::vector<uint8_t> m_kinds;
+    std::vector<SourceBuffer::Offset> m_offsets;
+    std::vector<SourceBuffer::Offset> m_lengths;
+    // The line in the upper half, the column in the lower one.
+    std::vector<uint64_t> m_locs;
+    // The `SymId` of identifiers or the `Keyword` of keywords.
+    std::vector<uint32_t> m_payloads;
+
+    inline size_t slot(TokenIndex i) const {
+        return i & m_mask;
+    }
+};
+
+/// @brief `Tokenizer::TokenRef`
+/// A handle to a token within a `Tokenizer::TokenArray`, every field is read on demand.
+struct TokenRef {
+    const TokenArray* tokens;
+    TokenIndex index;
+
+    inline TokenKind kind() const {
+        return tokens->kind(index);
+    }
+
+    inline std::string_view value() const {
+        return tokens->value(index);
+    }
+
+    inline Location loc() const {
+        return tokens->loc(index);
+    }
+
+    inline SymId sym() const {
+        return tokens->sym(index);
+    }
+
+    inline Keyword keyword() const {
+        return tokens->keyword(index);
+    }
+
+    bool match_kind(TokenKind k) const {
+        return kind() == k;
+    }
+
+    template<typename... Kinds>
+    bool matches_any(Kinds... kinds) const {
+        TokenKind k = kind();
+        return ((k == kinds) || ...);
+    }
+
+    template<typename... Kw>
+    bool match_keyword(Kw... keywords) const {
+        return match_kind(TokenKind::Keyword) && ((keyword() == keywords) || ...);
+    }
+};
+
 /// @brief `Tokenizer::LazyTokenStream`
 /// Is a struct that stores the token-stream buffer, meant for travesing and parsing.
 struct LazyTokenStream {
     int cur = -1;
-    std::vector<Token> m_tokens;
+    TokenArray tokens;
 
-    LazyTokenStream() : m_tokens() {}
+    LazyTokenStream() : tokens() {}
+    explicit LazyTokenStream(SharedPtr<SourceBuffer> source) : tokens(std::move(source)) {}
     ~LazyTokenStream() = default;
 
     // Resets the cursors position.
@@ -368,7 +583,7 @@ struct LazyTokenStream {
 
     // Size casting, from `std::size_t` to a primitive int.
     inline int self_size() const {
-        return static_cast<int>(m_tokens.size());
+        return static_cast<int>(tokens.size());
     }
 
     // Checks wether the token stream holds an End-of-file token.
@@ -378,8 +593,8 @@ struct LazyTokenStream {
             k++;
         }
         return (
-            !m_tokens.empty() &&
-            m_tokens.at(k).match_kind(TokenKind::Eof)
+            !tokens.empty() &&
+            tokens.kind(static_cast<TokenIndex>(k)) == TokenKind::Eof
         );
     }
 
@@ -391,34 +606,34 @@ struct LazyTokenStream {
     // Pushes a token into the buffer.
     void feed(const Token& token) {
         cur++;
-        m_tokens.push_back(token);
+        tokens.push(token);
     }
 
     // Consumes a token from the stream.
-    Option<Token> eat_one_token() {
+    Option<TokenRef> eat_one_token() {
         if(!has_next()) {
             return std::nullopt;
         } else {
-            return std::make_optional<Token>(m_tokens.at(++cur));
+            return TokenRef{ &tokens, static_cast<TokenIndex>(++cur) };
         }
     }
 
     void dump() const {
-        for(const auto& tok : m_tokens) tok.out();
+        for(size_t i = 0; i < tokens.size(); i++) tokens.at(static_cast<TokenIndex>(i)).out();
     }
 };
 
 // Converts a 'Tokenizer::TokenKind` into a `Tokenizer::BinOpKind`.
-Option<BinOpKind> bin_op_from_token(const Token& tok);
+Option<BinOpKind> bin_op_from_token(TokenRef tok);
 
 // Converts a 'Tokenizer::TokenKind` into a `Tokenizer::UnOpKind`.
-Option<UnOpKind> un_op_from_token(const Token& tok); 
+Option<UnOpKind> un_op_from_token(TokenRef tok);
 
 // Converts a 'Tokenizer::TokenKind` into a `Tokenizer::AssignOp`.
-Option<AssignOp> assign_op_from_token(const Token& tok);
+Option<AssignOp> assign_op_from_token(TokenRef tok);
 
-// Converts a 'Tokenizer::TokenKind` into a `Tokenizer::BooleanKind`.
-Option<BooleanKind> bool_from_token(const Token& tok);
+// Converts the value of a word into a `Tokenizer::BooleanKind`.
+Option<BooleanKind> bool_from_token(std::string_view value);
 
 };
 
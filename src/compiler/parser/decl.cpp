@@ -7,19 +7,19 @@ using Tokenizer::Identifier;
 Identifier Parser::parse_general_ident() {
     ASSERT(
         cur_tok().match_kind(TokenKind::Identifier),
-        std::format("expected identifier but got '{}'", cur_tok().value)
+        std::format("expected identifier but got '{}'", cur_tok().value())
     );
 
-    Identifier ident(cur_tok().value);
+    Identifier ident(cur_tok().sym());
     eat();
 
     return ident;
 }
 
-Ptr<Type> Parser::parse_type() {
+TypeRef Parser::parse_type() {
     if(cur_tok().match_kind(TokenKind::Identifier))
     {
-        Identifier ident(cur_tok().value);
+        Identifier ident(cur_tok().sym());
         Option<Primitive> type = maybe_primitive(ident.as_str()); 
         ASSERT(
             type.has_value(),
@@ -27,33 +27,32 @@ Ptr<Type> Parser::parse_type() {
         );
         // Eat the type identifier.
         eat();
-        Primitive ty = type.value();
-        return mk_ptr(PrimitiveType(std::move(ty)));
+        return primitive_type(type.value());
     }
     if(cur_tok().match_keyword(Keyword::Ptr)) 
     {
         eat();
         ASSERT(
             cur_tok().match_kind(TokenKind::OpenParen),
-            std::format("expected `(` after ptr keyword but got '{}'", cur_tok().value)
+            std::format("expected `(` after ptr keyword but got '{}'", cur_tok().value())
         );
 
         // A pointer underlying type.
         // E.g 'mut string_type_example: ptr(int)
         eat();
-        Ptr<Type> type = parse_type();
+        TypeRef type = parse_type();
         
         ASSERT(
             cur_tok().match_kind(TokenKind::CloseParen),
-            std::format("expected `)` after ptr type but got '{}'", cur_tok().value)
+            std::format("expected `)` after ptr type but got '{}'", cur_tok().value())
         );
         eat();
 
-        return mk_ptr(PointerType(std::move(type)));
+        return pointer_type(type);
     }
     ASSERT(
         false,
-        std::format("expected type but got '{}'", cur_tok().value)
+        std::format("expected type but got '{}'", cur_tok().value())
     );
     return nullptr;
 }
@@ -70,17 +69,17 @@ Option<Parameter> Parser::parse_param_within_fn_header() {
         cur_tok().match_kind(TokenKind::Identifier), 
         std::format(
             "expected an identifier but got '{}'", 
-            Tokenizer::tok_kind_str(cur_tok().kind)
+            Tokenizer::tok_kind_str(cur_tok().kind())
         )
     );
 
     // Build and eat the identifier.
-    Identifier param_ident(cur_tok().value);
+    Identifier param_ident(cur_tok().sym());
     eat();
 
     ASSERT(
         cur_tok().match_kind(TokenKind::Colon),
-        std::format("expected ':' after param identifier but got '{}'", cur_tok().value)
+        std::format("expected ':' after param identifier but got '{}'", cur_tok().value())
     );
     eat();
 
@@ -113,7 +112,7 @@ void Parser::parse_fn_header_params(FnHeader& header) {
             
             ASSERT(
                 cur_tok().match_kind(TokenKind::Comma),
-                std::format("expected a comma or a closing parenthesis after function parameter but got '{}'", cur_tok().value)
+                std::format("expected a comma or a closing parenthesis after function parameter but got '{}'", cur_tok().value())
             );        
             eat();
         }
@@ -121,26 +120,26 @@ void Parser::parse_fn_header_params(FnHeader& header) {
 }
 
 void Parser::parse_fn_header(FnHeader& header) {
-    Ptr<Type> type = parse_type();
+    TypeRef type = parse_type();
     Identifier ident = parse_general_ident();
     
     ASSERT(
         cur_tok().match_kind(TokenKind::OpenParen), 
         std::format(
             "expected '(' after in fn declaration but got '{}'",
-            Tokenizer::tok_kind_str(cur_tok().kind)
+            Tokenizer::tok_kind_str(cur_tok().kind())
         )
     );    
     
-    current_ctxt.set(ident.as_str());
+    current_ctxt = ident;
     header.ident = std::move(ident);
-    header.ret_type = std::move(type);
+    header.ret_type = type;
 
     eat();
     parse_fn_header_params(header);
 }
 
-Fn Parser::parse_fn_decl() {
+ArenaPtr<FnNode> Parser::parse_fn_decl() {
     // Eat the 'fn' keyword and bump into the function return type.
     eat();
 
@@ -149,20 +148,20 @@ Fn Parser::parse_fn_decl() {
     
     // Eat the closing parenthesis.
     eat();
-    Statement::Block body = parse_block();
+    ArenaPtr<BlockNode> body = parse_block();
 
     ASSERT(
-        !body.stmts.empty(), 
+        !body->children.empty(), 
         "cannot define function without a body"
     );
 
     ASSERT(
         cur_tok().match_keyword(Tokenizer::Keyword::End), 
-        std::format("expected 'end' keyword but got '{}'", Tokenizer::tok_kind_str(cur_tok().kind))
+        std::format("expected 'end' keyword but got '{}'", Tokenizer::tok_kind_str(cur_tok().kind()))
     );
     eat();
 
-    return Fn(header, body);
+    return mk_node<FnNode>(mk_node<FnHeaderNode>(std::move(header)), std::move(body));
 }
 
 Option<Initializer> Parser::parse_local_initializer() {
@@ -175,7 +174,7 @@ Option<Initializer> Parser::parse_local_initializer() {
     
     ASSERT(
         cur_tok().match_kind(TokenKind::Eq),
-        std::format("expected a '=' but got '{}'", cur_tok().value)
+        std::format("expected a '=' but got '{}'", cur_tok().value())
     );
     auto assign_op = assign_op_from_token(cur_tok()).value();
 
@@ -187,7 +186,7 @@ Option<Initializer> Parser::parse_local_initializer() {
         cur_tok().match_kind(TokenKind::SemiColon), 
         std::format(
             "expected ';' after local declaration but got '{}'",
-            Tokenizer::tok_kind_str(cur_tok().kind)
+            Tokenizer::tok_kind_str(cur_tok().kind())
         )
     );
 
@@ -195,9 +194,9 @@ Option<Initializer> Parser::parse_local_initializer() {
     return init;
 }
 
-Var Parser::parse_local_decl() {
+ArenaPtr<VarDeclarationNode> Parser::parse_local_decl() {
     // Save the mutability modifier.
-    Token& mut_token = cur_tok();
+    TokenRef mut_token = cur_tok();
     
     // Eat 'let' or 'mut'
     eat();
@@ -205,12 +204,12 @@ Var Parser::parse_local_decl() {
         cur_tok().match_kind(TokenKind::Identifier), 
         std::format(
             "expected an identifier but got '{}'", 
-            Tokenizer::tok_kind_str(cur_tok().kind)
+            Tokenizer::tok_kind_str(cur_tok().kind())
         )
     );
 
     Mutability mut = Declaration::mut_from_token(mut_token);
-    Identifier ident(cur_tok().value);
+    Identifier ident(cur_tok().sym());
 
     // Eat the identifier.
     eat();
@@ -218,32 +217,38 @@ Var Parser::parse_local_decl() {
         cur_tok().match_kind(TokenKind::Colon),
         std::format(
             "expected a colon after identifier but got '{}'", 
-            Tokenizer::tok_kind_str(cur_tok().kind)
+            Tokenizer::tok_kind_str(cur_tok().kind())
         )
     );
 
     // Eat the colon.
     eat(); 
-    Ptr<Type> type = parse_type();
+    TypeRef type = parse_type();
     Option<Initializer> init = parse_local_initializer();
 
-    return Var(
-        std::move(mut),
-        std::move(ident),
-        std::move(type),
-        std::move(init)
+    Option<AssignOp> op = std::nullopt;
+    ArenaPtr<ExprNode> expr = nullptr;
+    if(init.has_value()) {
+        op = init->assignment;
+        expr = std::move(init->expr);
+    }
+
+    return mk_node<VarDeclarationNode>(
+        VarInfo(std::move(mut), std::move(ident), type),
+        std::move(op),
+        std::move(expr)
     );
 }
 
-Assignment Parser::parse_local_assignment() {
+ArenaPtr<AssignmentNode> Parser::parse_local_assignment() {
     ASSERT(
         cur_tok().match_kind(TokenKind::Identifier),
         std::format(
             "expected an identifier but got '{}'", 
-            Tokenizer::tok_kind_str(cur_tok().kind)
+            Tokenizer::tok_kind_str(cur_tok().kind())
         )
     );
-    Identifier lvalue(cur_tok().value);
+    Identifier lvalue(cur_tok().sym());
 
     eat();
     if(cur_tok().match_kind(TokenKind::SemiColon)) {
@@ -256,15 +261,15 @@ Assignment Parser::parse_local_assignment() {
         init.has_value(),
         format(
             "expected an assignment operator or but got '{}'", 
-            tok_kind_str(cur_tok().kind)
+            tok_kind_str(cur_tok().kind())
         )
     );
 
-    return Assignment(std::move(lvalue), std::move(init.value()));
+    return mk_node<AssignmentNode>(init->assignment, std::move(lvalue), std::move(init->expr));
 }
 
-DerefAssignment Parser::parse_deref_assignment() {
-    Ptr<Expr::UnaryExpr> lvalue = expr_unary();
+ArenaPtr<DerefAssignmentNode> Parser::parse_deref_assignment() {
+    ArenaPtr<ExprNode> lvalue = expr_unary();
 
     if(cur_tok().match_kind(TokenKind::SemiColon)) {
         eat();
@@ -276,9 +281,9 @@ DerefAssignment Parser::parse_deref_assignment() {
         init.has_value(),
         std::format(
             "expected an assignment operator or but got '{}'", 
-            tok_kind_str(cur_tok().kind)
+            tok_kind_str(cur_tok().kind())
         )
     );
 
-    return DerefAssignment(std::move(lvalue), std::move(init.value()));
+    return mk_node<DerefAssignmentNode>(init->assignment, std::move(lvalue), std::move(init->expr));
 }
\ No newline at end of file
@@ -1,24 +1,9 @@
 #include "parser.hpp"
 #include "common.hpp"
 
-using Expr::ExprKind;
 using Expr::Precedence;
 using Expr::Associativity;
 
-std::string Expr::meaning_from_expr_kind(const ExprKind& kind) {
-    switch(kind) {
-        case ExprKind::Lit: return "Literal";
-        case ExprKind::Binary: return "Binary";
-        case ExprKind::Unary: return "Unary";
-        case ExprKind::Group: return "Group";
-        case ExprKind::FnCall: return "Function";
-        case ExprKind::Local: return "Local_Resource_Access";
-        default: {
-            return "unknown_Expr_Kind";
-        }
-    }
-}
-
 Precedence Expr::prec_from_bin_op(const BinOpKind& bin_op) {
     switch (bin_op) {
         case BinOpKind::Add:        
@@ -90,17 +75,16 @@ Expr::Precedence Parser::rhs_expr_precedence(Tokenizer::BinOpKind binary_op) {
     return Expr::Precedence::Dummy;
 }
 
-Ptr<Expr::UnaryExpr> Parser::expr_unary() {
+ArenaPtr<UnaryOpNode> Parser::expr_unary() {
     ASSERT(unary(), "unreachable: cannot parse something that is not an unary.");
 
     UnOpKind unary_op = un_op_from_token(cur_tok()).value();
     Expr::Precedence prec = Expr::prec_for_un_op(unary_op);
     eat();
-    auto unary_expr = expr(prec);
-    return mk_ptr(Expr::UnaryExpr(unary_op, unary_expr));
+    return mk_node<UnaryOpNode>(unary_op, expr(prec));
 }
 
-Ptr<Expr::GroupExpr> Parser::expr_group() {
+ArenaPtr<ExprNode> Parser::expr_group() {
     ASSERT(group_start(), "unreachable: group does not start with an opening parenthesis.");
 
     // Eat the open paren.
@@ -109,45 +93,51 @@ Ptr<Expr::GroupExpr> Parser::expr_group() {
 
     ASSERT(
         group_end(), 
-        "invalid use of parenthesis, expected `)` but got `" + cur_tok().value  + "`"
+        std::format("invalid use of parenthesis, expected `)` but got `{}`", cur_tok().value())
     );
 
     // Eat the closing paren.
+    // A group has no node of its own, the underlying expression is used as is.
     eat();
-    return mk_ptr(Expr::GroupExpr(group));
+    return group;
 }
 
-Ptr<Expr::Literal> Parser::expr_literal() {
-    Expr::Literal literal(cur_tok());
+ArenaPtr<LiteralNode> Parser::expr_literal() {
+    TokenRef tok = cur_tok();
+    auto literal = mk_node<LiteralNode>(
+        LiteralNode::LitStr(tok.value()),
+        lit_from_tok(tok.kind()).value_or(LiteralKind::None),
+        tok.loc()
+    );
 
     // Eat the literal itself.
     eat();
-    return mk_ptr(std::move(literal));
+    return literal;
 }
 
-Ptr<Expr::Local> Parser::expr_ident_local() {
+ArenaPtr<VarTerminalNode> Parser::expr_ident_local() {
     ASSERT(cur_tok().match_kind(TokenKind::Identifier), "unreachable: expected an identifier.");
 
-    Identifier ident(cur_tok().value);
+    Identifier ident(cur_tok().sym());
     eat();
 
-    return mk_ptr(Expr::Local(std::move(ident)));
+    return mk_node<VarTerminalNode>(std::move(ident));
 }
 
-Ptr<Expr::FnCall> Parser::expr_ident_fn() {
+ArenaPtr<FnCallNode> Parser::expr_ident_fn() {
     ASSERT(cur_tok().match_kind(TokenKind::Identifier), "unreachable: expected an identifier.");
 
-    Identifier ident(cur_tok().value);
+    Identifier ident(cur_tok().sym());
     eat();
 
     // Eat the open paren.
     ASSERT(
         cur_tok().match_kind(TokenKind::OpenParen), 
-        std::format("expected `(` but got `{}`", cur_tok().value)
+        std::format("expected `(` but got `{}`", cur_tok().value())
     );
     eat();
 
-    std::vector<Ptr<Expr::BaseExpr>> args;
+    std::vector<ArenaPtr<ExprNode>> args;
     while(!cur_tok().match_kind(TokenKind::CloseParen)) {
         auto arg = expr(Expr::Precedence::Dummy);
         args.push_back(std::move(arg));
@@ -162,14 +152,14 @@ Ptr<Expr::FnCall> Parser::expr_ident_fn() {
     // Eat the closing paren.
     ASSERT(
         cur_tok().match_kind(TokenKind::CloseParen), 
-        std::format("expected `)` but got `{}`", cur_tok().value)
+        std::format("expected `)` but got `{}`", cur_tok().value())
     );
     eat();
 
-    return mk_ptr(Expr::FnCall(std::move(ident), std::move(args)));
+    return mk_node<FnCallNode>(std::move(ident), std::move(args));
 }
 
-Ptr<Expr::BaseExpr> Parser::expr_primary() {
+ArenaPtr<ExprNode> Parser::expr_primary() {
     if(unary()) {
         return expr_unary();
     } 
@@ -181,7 +171,7 @@ Ptr<Expr::BaseExpr> Parser::expr_primary() {
     }
     if(cur_tok().match_kind(TokenKind::Identifier)) {
         if(
-            ntok_for([](Token& tok) {
+            ntok_for([](TokenRef tok) {
                 return tok.match_kind(TokenKind::OpenParen); 
             }, TokDistance::Next)
         ) {
@@ -189,11 +179,11 @@ Ptr<Expr::BaseExpr> Parser::expr_primary() {
         }
         return expr_ident_local();
     }
-    ASSERT(false, "invalid token: got `" + cur_tok().value + "`, expected expression");
+    ASSERT(false, std::format("invalid token: got `{}`, expected expression", cur_tok().value()));
     return nullptr;
 }
 
-Ptr<Expr::BaseExpr> Parser::expr(Expr::Precedence min_prec) {
+ArenaPtr<ExprNode> Parser::expr(Expr::Precedence min_prec) {
     auto base = expr_primary();
 
     auto bin_op_match = Tokenizer::bin_op_from_token(cur_tok());
@@ -207,10 +197,7 @@ Ptr<Expr::BaseExpr> Parser::expr(Expr::Precedence min_prec) {
         eat();
         
         auto rhs = expr(rhs_expr_precedence(op));
-
-        base = mk_ptr<Expr::BinExpr>(
-            Expr::BinExpr(op, std::move(base), std::move(rhs))
-        );
+        base = mk_node<BinOpNode>(op, std::move(base), std::move(rhs));
 
         // Continue the matching
         bin_op_match = bin_op_from_token(cur_tok());
@@ -219,6 +206,6 @@ Ptr<Expr::BaseExpr> Parser::expr(Expr::Precedence min_prec) {
     return base;
 }
 
-Ptr<Expr::BaseExpr> Parser::parse_expr_without_recovery() {
+ArenaPtr<ExprNode> Parser::parse_expr_without_recovery() {
     return expr(Expr::Precedence::Dummy);
 }
\ No newline at end of file
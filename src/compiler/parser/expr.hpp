@@ -63,100 +63,12 @@ using Tokenizer::UnOpKind;
 using Tokenizer::AssignOp;
 
 using Tokenizer::Token;
+using Tokenizer::TokenRef;
 using Tokenizer::Location;
 using Tokenizer::lit_from_tok;
 
 namespace Expr {
 
-enum class ExprKind: int {
-    // A value expression maps to Expr::Literal.
-    // E.g `1, true, foo, 1.0, "bar"`
-    Lit,
-    // A binary expression maps to Expr::BinExpr.
-    Binary,
-    // An unary expression, operator and the inner expression.
-    // E.g '-1', 'not true', '~foo'
-    Unary,
-    // An expression within parenthesis.
-    // E.g '(1 + 2)'
-    Group,
-    // A function call expression. Expr::FnCall.
-    // E.g 'foo(1, 2, 3)'
-    FnCall,
-    // A named variable.
-    // E.g 'foo'
-    Local,
-    // An address of a local variable.
-    Address
-};
-
-struct BaseExpr {
-    ExprKind kind;
-
-    BaseExpr(ExprKind k) : kind(k) {}
-    virtual ~BaseExpr() = default;
-    
-    inline bool matches(ExprKind kind) const { 
-        return kind == kind; 
-    } 
-};
-
-struct Literal : public BaseExpr {
-    std::string val;
-    LiteralKind kind;
-    Location loc = Location::Singularity();
-
-    explicit Literal() : BaseExpr(ExprKind::Lit) {}
-
-    explicit Literal(const Token& t): BaseExpr(ExprKind::Lit) {
-        val = t.value;
-        loc = t.loc;
-        kind = lit_from_tok(t.kind).value_or(LiteralKind::None);
-    }
-};
-
-struct Local : public BaseExpr {
-    Identifier ident;
-
-    Local(Identifier&& ident) 
-        : BaseExpr(ExprKind::Local), ident(std::move(ident)) {};
-};
-
-struct FnCall : public BaseExpr {
-    Identifier ident;
-    std::vector<Ptr<BaseExpr>> args;
-
-    FnCall(Identifier&& ident, std::vector<Ptr<BaseExpr>>&& args) 
-        : BaseExpr(ExprKind::FnCall), ident(std::move(ident)), args(std::move(args)) {}
-};
-
-struct BinExpr : public BaseExpr {
-    BinOpKind op;
-    Ptr<BaseExpr> lhs;
-    Ptr<BaseExpr> rhs;
-
-    BinExpr() : BaseExpr(ExprKind::Binary) {}
-
-    BinExpr(
-        BinOpKind op, 
-        Ptr<BaseExpr> lhs, 
-        Ptr<BaseExpr> rhs
-    ) : BaseExpr(ExprKind::Binary), op(op), lhs(std::move(lhs)), rhs(std::move(rhs)) {}
-};
-
-struct GroupExpr : public BaseExpr {
-    Ptr<BaseExpr> expr;
-    
-    GroupExpr(Ptr<BaseExpr>& e) : BaseExpr(ExprKind::Group), expr(std::move(e)) {} 
-};
-
-struct UnaryExpr : public BaseExpr {
-    UnOpKind op;
-    Ptr<BaseExpr> expr;
-
-    UnaryExpr(UnOpKind op, Ptr<BaseExpr>& e) : BaseExpr(ExprKind::Unary), op(op), expr(std::move(e)) {}
-};
-
 enum class Precedence : int {
     Dummy       = 0,  // Lowest precedence (used for undefined cases)
     LogicalOr   = 1,  // `or`
@@ -195,8 +107,6 @@ Associativity assoc_from_bin_op(const BinOpKind& bin_op);
 // Returns the corresponding associativity for an unary operator.
 Associativity assoc_from_un_op();
 
-std::string meaning_from_expr_kind(const ExprKind& kind);
-
 };
 
 #endif // EXPR_HPP_
\ No newline at end of file
@@ -1,6 +1,9 @@
 #ifndef PARSER_HPP_
 #define PARSER_HPP_
 
+#include <bit>
+
+#include "arena.hpp"
 #include "diag.hpp"
 #include "lex.hpp"
 #include "expr.hpp"
@@ -9,52 +12,91 @@
 #include "err.hpp"
 #include "typing.hpp"
 
-using Statement::Stmt;
-using Statement::StmtKind;
-using Statement::Block;
-using Statement::Import;
-using Statement::FnCall;
-using Statement::If;
-using Statement::Break;
-using Statement::Loop;
-
 using Declaration::Parameter;
-using Declaration::Var;
-using Declaration::Assignment;
-using Declaration::DerefAssignment;
 using Declaration::FnHeader;
-using Declaration::Fn;
-using Declaration::Initializer;
 
+/// @brief `Initializer`
+/// The assignment operator and the expression on the right side of a declaration or an assignment.
+struct Initializer {
+    Tokenizer::AssignOp assignment;
+    ArenaPtr<ExprNode> expr;
+
+    Initializer(Tokenizer::AssignOp op, ArenaPtr<ExprNode>&& expr)
+        : assignment(op), expr(std::move(expr)) {}
+};
+
+/// @brief `TokenCursor`
+/// Walks a `TokenArray` and hands out indices into it.
+/// Tokens either come from a stream that was lexed up front, or are pulled from a `Lexer` on demand
+/// into a small ring that only holds the previous token, the current one and the lookahead.
 struct TokenCursor {
-    Ptr<Token> cur;
-    Ptr<Token> prev;
-    size_t stream_size = 0;
-    SharedPtr<LazyTokenStream> stream;
+    using Source = Closure<Token>;
+
+    // How far past the current token the parser may look, see `Parser::ntok_for`.
+    static CONST size_t MAX_LOOKAHEAD = 1;
+    static CONST size_t CAPACITY = std::bit_ceil(MAX_LOOKAHEAD + 2);
+
+    // Feeds `window`, unset when walking a stream.
+    Source pull;
+    TokenArray window;
+    // The lexed stream, if there is one.
+    const TokenArray* stream = nullptr;
+    TokenIndex current = 0;
+    // Was the first token consumed yet?
+    bool started = false;
 
-    explicit TokenCursor(const LazyTokenStream& stream)
-        : stream(std::make_shared<LazyTokenStream>(std::move(stream))), 
-          stream_size(stream.self_size()), 
-          cur(nullptr), 
-          prev(nullptr) {}
+    TokenCursor(Source source, SharedPtr<SourceBuffer> buffer)
+        : pull(std::move(source)), window(std::move(buffer), CAPACITY) {}
 
-    inline int pos() {
-        return stream->cur;
+    explicit TokenCursor(const TokenArray& tokens)
+        : pull(), window(), stream(&tokens) {}
+
+    inline const TokenArray& tokens() const {
+        return stream != nullptr ? *stream : window;
     }
 
-    void next() {
-        if(cur != nullptr) {
-            prev = std::move(cur);
+    inline TokenRef at(TokenIndex i) const {
+        return { &tokens(), i };
+    }
+
+    // Makes sure the token `ahead` positions past the current one is available.
+    // Returns false if that position lies beyond the `Eof` token.
+    bool fill(size_t ahead) {
+        ASSERT(ahead <= MAX_LOOKAHEAD, "lookahead is larger than the token window.");
+        size_t needed = current + ahead + 1;
+        while (tokens().size() < needed) {
+            if (!pull || (!window.empty() && window.kind(window.size() - 1) == TokenKind::Eof)) {
+                return false;
+            }
+            window.push(pull());
         }
-        if(auto nxt = stream->eat_one_token(); nxt) {
-            cur = mk_ptr<Token>(std::move(nxt.value()));
-        } else {
-            cur = nullptr;
+        return true;
+    }
+
+    // The token `ahead` positions past the current one.
+    TokenIndex peek(size_t ahead) {
+        ASSERT(fill(ahead), "LOOKAHEAD FAILED: OUT OF BOUNDS");
+        return current + static_cast<TokenIndex>(ahead);
+    }
+
+    TokenIndex cur() const {
+        return current;
+    }
+
+    void next() {
+        if (started) {
+            current++;
         }
+        started = true;
+        fill(0);
     }
 
+    // Before the first token was consumed, checks the first token instead.
     bool can_advance() {
-        return stream->has_next();
+        if (!started && !fill(0)) {
+            return false;
+        }
+        return tokens().kind(current) != TokenKind::Eof;
     }
 };
 
@@ -69,10 +111,18 @@ public:
         Next = 1
     };
 
+    static_assert(TokDistance::Next <= TokenCursor::MAX_LOOKAHEAD, "the token window cannot hold the lookahead.");
+
     static CONST int MAX_PARSE_DIAGS = 10;
 
-    Parser(const LazyTokenStream& stream) 
-        : current_ctxt{}, tok_cur{std::move(stream)}, diags{MAX_PARSE_DIAGS} {}
+    // Parses while lexing, tokens are pulled from `lexer` as they are needed.
+    // Every node is allocated in `arena`.
+    Parser(Lexer& lexer, Arena& arena) 
+        : current_ctxt{}, tok_cur{[&lexer]() { return lexer.next_token(); }, lexer.get_cursor().source}, arena{arena}, diags{MAX_PARSE_DIAGS} {}
+
+    // Parses a stream that was already lexed.
+    Parser(LazyTokenStream& stream, Arena& arena) 
+        : current_ctxt{}, tok_cur{stream.tokens}, arena{arena}, diags{MAX_PARSE_DIAGS} {}
 
     // The whole given token stream into an Ast.
     void parse(AST& ast); 
@@ -80,8 +130,15 @@ public:
 private:
     Diagnostics diags;
     TokenCursor tok_cur;
+    Arena& arena;
     Identifier current_ctxt;
 
+    // Constructs a node in the arena, the `mk_ptr` of the AST.
+    template<typename T, typename... Args>
+    ArenaPtr<T> mk_node(Args&&... args) {
+        return arena.make<T>(std::forward<Args>(args)...);
+    }
+
     void eat() {
         if(!tok_cur.can_advance()) {
             return;
@@ -92,33 +149,25 @@ private:
 
     // Looks ahead `n` tokens from the current position, for a certain condition.
     // *defaults* to the next token in line;
-    bool ntok_for(Closure<bool, Token&> condition, int ntok) {
-        // Increment by 1 since the LazyTokenStream is [-1] indexed.
-        size_t ahead_pos = tok_cur.pos() + ntok;
-        
-        // Reached EOF, finish parsing.
-        if(ahead_pos >= tok_cur.stream_size) {
-            ASSERT(false, "LOOKAHEAD FAILED: OUT OF BOUNDS");
-        }
-        
-        Token& tok = tok_cur.stream->m_tokens.at(ahead_pos);
-        return condition(tok);
+    bool ntok_for(Closure<bool, TokenRef> condition, int ntok) {
+        return condition(tok_cur.at(tok_cur.peek(ntok)));
     }
 
     void align_into_begining() {
-        ASSERT(tok_cur.cur == nullptr, "parser was already aligned.");
+        ASSERT(!tok_cur.started, "parser was already aligned.");
         
         // Align the parser. 
         // Meaning we just set it to the start of the program token stream.
         eat(); 
     }
 
-    inline Token& prev_tok() { 
-        return *tok_cur.prev;
+    inline TokenRef prev_tok() { 
+        ASSERT(tok_cur.cur() > 0, "there is no token before the first one.");
+        return tok_cur.at(tok_cur.cur() - 1);
     }
 
-    inline Token& cur_tok() { 
-        return *tok_cur.cur;
+    inline TokenRef cur_tok() { 
+        return tok_cur.at(tok_cur.cur());
     }
 
     inline bool unary() {
@@ -143,46 +192,41 @@ private:
         );
     }
 
-    Ptr<Expr::BaseExpr> parse_expr_without_recovery();
-    Ptr<Expr::BaseExpr> expr(Expr::Precedence min_prec);
-    Ptr<Expr::BaseExpr> expr_primary();
+    ArenaPtr<ExprNode> parse_expr_without_recovery();
+    ArenaPtr<ExprNode> expr(Expr::Precedence min_prec);
+    ArenaPtr<ExprNode> expr_primary();
 
-    Ptr<Expr::FnCall> expr_ident_fn();
-    Ptr<Expr::Local> expr_ident_local();
-    Ptr<Expr::UnaryExpr> expr_unary();
-    Ptr<Expr::GroupExpr> expr_group();
-    Ptr<Expr::Literal> expr_literal();
+    ArenaPtr<FnCallNode> expr_ident_fn();
+    ArenaPtr<VarTerminalNode> expr_ident_local();
+    ArenaPtr<UnaryOpNode> expr_unary();
+    ArenaPtr<ExprNode> expr_group();
+    ArenaPtr<LiteralNode> expr_literal();
 
     // Computes the precedence of the right sibling of the current node.
     // This precedence will be using in the recursive manner when parsing expressions.
     Expr::Precedence rhs_expr_precedence(Tokenizer::BinOpKind binary_op);
 
-    Var parse_local_decl();
-    Assignment parse_local_assignment();
-    DerefAssignment parse_deref_assignment();
+    ArenaPtr<VarDeclarationNode> parse_local_decl();
+    ArenaPtr<AssignmentNode> parse_local_assignment();
+    ArenaPtr<DerefAssignmentNode> parse_deref_assignment();
     Option<Initializer> parse_local_initializer();
 
-    Ptr<Type> parse_type();
-    FnCall parse_fn_call();
-    Fn parse_fn_decl();
-    Block parse_block();
-    Break parse_break_stmt();
-    If parse_if_stmt();
-    Loop parse_loop_stmt();
+    TypeRef parse_type();
+    ArenaPtr<FnCallNode> parse_fn_call();
+    ArenaPtr<FnNode> parse_fn_decl();
+    ArenaPtr<BlockNode> parse_block();
+    ArenaPtr<BreakNode> parse_break_stmt();
+    ArenaPtr<IfNode> parse_if_stmt();
+    ArenaPtr<LoopNode> parse_loop_stmt();
 
     void parse_fn_header_params(FnHeader& header);
     void parse_fn_header(FnHeader& header);
 
-    Statement::Import parse_import_stmt();
-    Statement::Return parse_return_stmt();
+    ArenaPtr<ImportNode> parse_import_stmt();
+    ArenaPtr<ReturnNode> parse_return_stmt();
     Identifier parse_general_ident();
     Option<Parameter> parse_param_within_fn_header();
-    Ptr<Stmt> parse_stmt_without_recovery();
-    
-    // Used for the final AST body.
-    Ptr<FnNode> parse_function_to_node();
-    Ptr<StmtNode> stmt_to_node(const Ptr<Statement::Stmt>& stmt);
-    Ptr<ExprNode> expr_to_node(const Ptr<Expr::BaseExpr>& expr);
+    ArenaPtr<StmtNode> parse_stmt_without_recovery();
 };
 
 #endif // PARSER_HPP_
\ No newline at end of file
@@ -1,13 +1,12 @@
 #include "parser.hpp"
 
-using ScopeDelimiter = Statement::ScopeDelimiter;
 using Keyword = Tokenizer::Keyword;
 
-Statement::If Parser::parse_if_stmt() {
+ArenaPtr<IfNode> Parser::parse_if_stmt() {
     // Eat the 'if' keyword.
     eat();
 
-    Ptr<BaseExpr> condition = parse_expr_without_recovery();
+    ArenaPtr<ExprNode> condition = parse_expr_without_recovery();
 
     ASSERT(
         cur_tok().match_kind(TokenKind::OpenCurly),
@@ -15,12 +14,12 @@ Statement::If Parser::parse_if_stmt() {
     );
     
     eat();
-    Block if_block = parse_block();
+    ArenaPtr<BlockNode> if_block = parse_block();
 
     ASSERT(cur_tok().match_kind(TokenKind::CloseCurly), "must close 'if' body with '}'." );
     eat();
 
-    Statement::If if_stmt{};
+    ArenaPtr<BlockNode> else_block = nullptr;
     if(cur_tok().match_keyword(Keyword::Else)) 
     {
         eat(); // Eat the 'else' keyword.
@@ -30,21 +29,21 @@ Statement::If Parser::parse_if_stmt() {
         );
         
         eat();
-        Block else_block = parse_block();
+        else_block = parse_block();
 
         ASSERT(cur_tok().match_kind(TokenKind::CloseCurly), "must close 'else' body with '}'." );
         eat();
 
-        if_stmt.has_else = true;
-        if_stmt.else_block = std::move(else_block);
+        // An empty 'else' is the same as no 'else' at all.
+        if(else_block->children.empty()) {
+            else_block = nullptr;
+        }
     }
 
-    if_stmt.if_block = std::move(if_block);
-    if_stmt.condition = std::move(condition);
-    return std::move(if_stmt);
+    return mk_node<IfNode>(std::move(condition), std::move(if_block), std::move(else_block));
 }
 
-Statement::Break Parser::parse_break_stmt() {
+ArenaPtr<BreakNode> Parser::parse_break_stmt() {
     // Eat the 'break' keyword.
     eat();
     ASSERT(
@@ -52,10 +51,10 @@ Statement::Break Parser::parse_break_stmt() {
         "expected ';' after the break keyword." 
     );
     eat();
-    return Statement::Break();
+    return mk_node<BreakNode>();
 }
 
-Statement::Loop Parser::parse_loop_stmt() {
+ArenaPtr<LoopNode> Parser::parse_loop_stmt() {
     // Eat the loop keyword.
     eat();
     ASSERT(
@@ -64,7 +63,7 @@ Statement::Loop Parser::parse_loop_stmt() {
     );
     
     eat();
-    Block body = parse_block();
+    ArenaPtr<BlockNode> body = parse_block();
 
     ASSERT(
         cur_tok().match_kind(TokenKind::CloseCurly),
@@ -72,126 +71,120 @@ Statement::Loop Parser::parse_loop_stmt() {
     );
 
     eat();
-    Statement::Loop loop{std::move(body)};
-    return std::move(loop);
+    return mk_node<LoopNode>(std::move(body));
 }
 
-Statement::Return Parser::parse_return_stmt() {
+ArenaPtr<ReturnNode> Parser::parse_return_stmt() {
     // Eat the 'return' keyword.
     eat();
 
     if(cur_tok().match_kind(TokenKind::SemiColon)) {
         eat();
-        return Statement::Return{current_ctxt, nullptr};
+        return mk_node<ReturnNode>(Identifier(current_ctxt), nullptr);
     }
 
-    Statement::Return ret_stmt {
-        current_ctxt,
-        parse_expr_without_recovery()
-    };
+    ArenaPtr<ExprNode> expr = parse_expr_without_recovery();
 
     ASSERT(
-        ret_stmt.expr != nullptr,
-        std::format("expected an expression after 'return' but got '{}'", cur_tok().value)
+        expr != nullptr,
+        std::format("expected an expression after 'return' but got '{}'", cur_tok().value())
     );
     ASSERT(
         cur_tok().match_kind(TokenKind::SemiColon),
-        std::format("expected ';' after return statement but got '{}'", cur_tok().value)
+        std::format("expected ';' after return statement but got '{}'", cur_tok().value())
     );
     eat();
 
-    return std::move(ret_stmt);
+    return mk_node<ReturnNode>(Identifier(current_ctxt), std::move(expr));
 }
 
-Statement::Import Parser::parse_import_stmt() {
+ArenaPtr<ImportNode> Parser::parse_import_stmt() {
     // Eat the 'import' keyword.
     eat();
     ASSERT(
         cur_tok().match_kind(TokenKind::Identifier),
-        std::format("expected an identifier after 'import' but got '{}'", cur_tok().value)
+        std::format("expected an identifier after 'import' but got '{}'", cur_tok().value())
     );
 
-    Statement::Import import_stmt{
-        Identifier(cur_tok().value)
-    };
+    Identifier ident(cur_tok().sym());
 
     // Eat the identifier.
     eat();
     ASSERT(
         cur_tok().match_kind(TokenKind::SemiColon),
-        std::format("expected ';' after import statement but got '{}'", cur_tok().value)
+        std::format("expected ';' after import statement but got '{}'", cur_tok().value())
     );
     eat();
 
-    return std::move(import_stmt);
+    return mk_node<ImportNode>(std::move(ident));
 }
 
-Statement::Block Parser::parse_block() {
-    Statement::Block block{};
+ArenaPtr<BlockNode> Parser::parse_block() {
+    std::vector<ArenaPtr<StmtNode>> children{};
     while(
         !cur_tok().match_kind(TokenKind::CloseCurly) &&
         !cur_tok().match_keyword(Keyword::End)
     ) {
-        Ptr<Statement::Stmt> stmt = parse_stmt_without_recovery();
+        ArenaPtr<StmtNode> stmt = parse_stmt_without_recovery();
 
         if(cur_tok().match_kind(TokenKind::Eof)) 
         {
             // We reached an end-of-file position, which is invalid.
             ASSERT(false, "must close a scope with either '}' or 'end'");
-            return {};
+            return nullptr;
         }        
 
-        block.stmts.push_back(std::move(stmt));
+        children.push_back(std::move(stmt));
     }
-    return std::move(block);
+    return mk_node<BlockNode>(std::move(children));
 }
 
-Statement::FnCall Parser::parse_fn_call() {
-    Statement::FnCall fn_call{expr_ident_fn()};
+ArenaPtr<FnCallNode> Parser::parse_fn_call() {
+    ArenaPtr<FnCallNode> fn_call = expr_ident_fn();
     ASSERT(
         cur_tok().match_kind(TokenKind::SemiColon),
-        std::format("expected ';' after function call but got '{}'", cur_tok().value)
+        std::format("expected ';' after function call but got '{}'", cur_tok().value())
     );
     eat();
-    return std::move(fn_call);
+    return fn_call;
 }
 
-Ptr<Statement::Stmt> Parser::parse_stmt_without_recovery() {
+ArenaPtr<StmtNode> Parser::parse_stmt_without_recovery() {
     if(cur_tok().match_keyword(Keyword::Mut, Keyword::Let)) {
-        return mk_ptr(parse_local_decl());
+        return parse_local_decl();
     }
     if(cur_tok().match_keyword(Keyword::Fn)) {
-        return mk_ptr(parse_fn_decl());
+        return parse_fn_decl();
     }
     if(cur_tok().match_keyword(Keyword::Return)) {
-        return mk_ptr(parse_return_stmt());
+        return parse_return_stmt();
     }
     if(cur_tok().match_keyword(Keyword::If)) {
-        return mk_ptr(parse_if_stmt());
+        return parse_if_stmt();
     }
     if(cur_tok().match_keyword(Keyword::Loop)) {
-        return mk_ptr(parse_loop_stmt());
+        return parse_loop_stmt();
     }
     if(cur_tok().match_keyword(Keyword::Break)) {
-        return mk_ptr(parse_break_stmt());
+        return parse_break_stmt();
     }
     if(cur_tok().match_keyword(Keyword::Import)) {
-        return mk_ptr(parse_import_stmt());
+        return parse_import_stmt();
     }
     if(cur_tok().match_kind(TokenKind::Identifier)) {
         // First, check if the 'ident' could be a function call.
         if(
-            ntok_for([](Token& tok) {
+            ntok_for([](TokenRef tok) {
                 return tok.match_kind(TokenKind::OpenParen); 
             }, TokDistance::Next))
         {
-            return mk_ptr(parse_fn_call());
+            return parse_fn_call();
         }
-        return mk_ptr(parse_local_assignment());
+        return parse_local_assignment();
     }
     if(cur_tok().match_kind(TokenKind::At)) {
-        return mk_ptr(parse_deref_assignment());
+        return parse_deref_assignment();
     }
-    ASSERT(false, std::format("unknown piece of code, got '{}'", cur_tok().value));
+    ASSERT(false, std::format("unknown piece of code, got '{}'", cur_tok().value()));
     return nullptr;
 }
\ No newline at end of file
@@ -8,8 +8,6 @@
 #include "typing.hpp"
 
 using Tokenizer::Identifier;
-using Expr::ExprKind;
-using Expr::BaseExpr;
 
 /*
 -- Wombat BNF for statement rules:
@@ -45,150 +43,11 @@ MatchStmt := match <expression> with
              MatchArm*
              end
 */
-namespace Statement {
-
-enum class ScopeDelimiter : int {
-    // A scope delimiter of braces.
-    //
-    // E.g 'if true { block... }'
-    Braces,
-    // A scope delimiter of the end keyword.
-    //
-    // E.g 'fn int foo() [block] end'
-    EndKw
-};
-
-enum class StmtKind : int {
-    // Import a module.
-    //
-    // E.g 'import foo' or 'import @local.bar'
-    Import,
-    // A local variable declaration.
-    //
-    // E.g 'let foo: bool = True;
-    Local,
-    // A local variable assignment.
-    //
-    // E.g 'foo = 42;'
-    Assignment,
-    // A dereference assignment.
-    DerefAssignment,
-    // A function declaration.
-    //
-    // E.g 'fn int32 foo(mut bar: int32) ... end'
-    FnDefinition,
-    // A return statement.
-    //
-    // E.g 'return foo;'
-    FnReturn,
-    // A statement expression like funcation or macro calls.
-    // 
-    // E.g 'foo();'
-    Expr,
-    // An if statement.
-    //
-    // E.g 'if x > 2 { ... }'
-    If,
-    // An loop statement.
-    //
-    // E.g 'loop { ... }'
-    Loop,
-    // A break statement.
-    // 
-    // E.g 'loop { ... break; }'
-    Break
-};
-
-struct Stmt {
-    StmtKind kind;
-
-    Stmt(StmtKind kind) : kind(kind) {}
-    virtual ~Stmt() = default;
-};
-
-struct Import : public Stmt {
-    Identifier ident;
-
-    Import(Identifier ident) 
-        : Stmt(StmtKind::Import), ident(std::move(ident)) {}
-};
-
-struct FnCall : public Stmt {
-    // A wrapper for a function call expression.
-    // E.g 'foo(42, bar)'
-    Ptr<Expr::FnCall> inner_expr;
-
-    FnCall(Ptr<Expr::FnCall>&& fn_call)
-        : Stmt(StmtKind::Expr), inner_expr(std::move(fn_call)) {}
-};
-
-struct Return : public Stmt {
-    Identifier from;
-    Ptr<BaseExpr> expr;
-
-    Return(Identifier from, Ptr<BaseExpr> expr) 
-        : Stmt(StmtKind::FnReturn), expr(std::move(expr)), from(from) {}
-};
-
-struct Block {
-    using StmtList = std::vector<Ptr<Stmt>>;
-    
-    // A scope is just a list of statements to be executed.
-    StmtList stmts;
-
-    Block() : stmts{} {}
-
-    StmtList& as_list() {
-        return stmts;
-    }
-};
-
-struct If : public Stmt {
-    bool has_else;
-    Ptr<BaseExpr> condition;
-    Block if_block;
-    Block else_block;
-
-    If() 
-    : Stmt(StmtKind::If), 
-      has_else{false}, 
-      condition{nullptr}, 
-      if_block(), 
-      else_block() {}
-};
-
-struct Break : public Stmt {
-    Break() : Stmt(StmtKind::Break) {}
-};
-
-struct Loop : public Stmt {
-    Block body;
-
-    Loop() : Stmt(StmtKind::Loop), body() {}
-    Loop(Block&& body) : Stmt(StmtKind::Loop), body(std::move(body)) {}
-};
-
-inline std::string meaning_from_stmt_kind(const StmtKind& kind) {
-    switch(kind) {
-        case StmtKind::Local: return "stmt_LOCAL";
-        case StmtKind::Import: return "stmt_IMPORT"; 
-        case StmtKind::FnDefinition: return "stmt_FN_DEFINITION";
-        default: {
-            UNREACHABLE();
-            return "stmt_UNKNOWN"; // Add a return for safety
-        }
-    }
-}
-
-}
-
 namespace Declaration {
 
 using Keyword = Tokenizer::Keyword;
-using Stmt = Statement::Stmt;
-using StmtKind = Statement::StmtKind;
 
-inline Mutability mut_from_token(const Token& tok) {
+inline Mutability mut_from_token(TokenRef tok) {
     if(tok.match_keyword(Keyword::Mut)) {
         return Mutability::Mutable;
     }
@@ -197,72 +56,26 @@ inline Mutability mut_from_token(const Token& tok) {
     }
     ASSERT(false, std::format(
         "expected token that represents a variable declaration but got '{}'", 
-        tok.value
+        tok.value()
     ));
 }
 
-struct Initializer {
-    Ptr<BaseExpr> expr;
-    Tokenizer::AssignOp assignment;
-
-    Initializer(const Tokenizer::AssignOp& op, Ptr<BaseExpr> expr)
-        : expr(std::move(expr)), assignment(std::move(op)) {}
-};
-
 struct VarInfo {
     Mutability mut;
     Identifier ident;
-    SharedPtr<Type> type;
-
-    VarInfo(Mutability&& mut, Identifier&& ident, SharedPtr<Type>&& type)
-        : mut(std::move(mut)), ident(std::move(ident)), type(std::move(type)) {}
-};
-
-struct Assignment : public Stmt {
-    Identifier lvalue;
-    Initializer init;
+    TypeRef type;
 
-    Assignment(Identifier&& lvalue, Initializer&& init) 
-        : Stmt(StmtKind::Assignment), lvalue(std::move(lvalue)), init(std::move(init)) {}
-};
-
-struct DerefAssignment : public Stmt {
-    Ptr<Expr::BaseExpr> lvalue;
-    Initializer init;
-
-    DerefAssignment(Ptr<Expr::BaseExpr>&& lvalue, Initializer&& init) 
-        : Stmt(StmtKind::DerefAssignment), lvalue(std::move(lvalue)), init(std::move(init)) {}
-};
-
-struct Var : public Stmt {
-    VarInfo info;
-    Option<Initializer> init;
-
-    Var(
-        Mutability&& mut,
-        Identifier&& ident,
-        Ptr<Type>&& type,
-        Option<Initializer>&& init
-    ) : Stmt(StmtKind::Local),
-        info{std::move(mut), std::move(ident), std::move(type)},
-        init{std::move(init)} {}
-
-    bool is_initialized() const {
-        return init.has_value();
-    }
-
-    const Ptr<Expr::BaseExpr>& initializer_expr() {
-        return init.value().expr;
-    }
+    VarInfo(Mutability&& mut, Identifier&& ident, TypeRef type)
+        : mut(std::move(mut)), ident(std::move(ident)), type(type) {}
 };
 
 struct Parameter {
     Mutability mut;
     Identifier ident;
-    SharedPtr<Type> type;
+    TypeRef type;
 
-    Parameter(Mutability&& mut, Identifier&& ident, SharedPtr<Type>&& type)
-        : mut{std::move(mut)}, type{std::move(type)}, ident{std::move(ident)} {}
+    Parameter(Mutability&& mut, Identifier&& ident, TypeRef type)
+        : mut{std::move(mut)}, type{type}, ident{std::move(ident)} {}
 
     std::string as_str() {
         return std::format("{}{}: {}", 
@@ -279,11 +92,11 @@ struct FnHeader {
 
     Identifier ident;
     FnParams params;
-    SharedPtr<Type> ret_type;
+    TypeRef ret_type = nullptr;
 
     FnHeader() = default;
-    FnHeader(Identifier& ident, FnParams& params, SharedPtr<Type>& ret_type) 
-        : ident(std::move(ident)), params(std::move(params)),  ret_type(std::move(ret_type)){}
+    FnHeader(Identifier& ident, FnParams& params, TypeRef ret_type) 
+        : ident(std::move(ident)), params(std::move(params)),  ret_type(ret_type){}
     
     std::string as_str() {
         std::string within_paren_str{""};
@@ -298,16 +111,6 @@ struct FnHeader {
     }
 };
 
-struct Fn : public Stmt {
-    using FnBody = Statement::Block;
-
-    FnHeader header;
-    FnBody body;
-
-    Fn(FnHeader& header, FnBody& body)
-        : Stmt(StmtKind::FnDefinition), header(std::move(header)), body(std::move(body)) {}
-};
-
 }
 
 #endif // STMT_HPP_
\ No newline at end of file
@@ -2,14 +2,46 @@
 #include "sema_visitor.hpp"
 #include "typing.hpp"
 
-bool SemanticVisitor::sema_ptr_mut_within_assignment(Ptr<ExprNode>& expr) {
+SharedPtr<Symbol> SemanticVisitor::lookup(const Identifier& ident) {
+    if (SharedPtr<Symbol> sym = table.lookup(ident)) {
+        return sym;
+    }
+    if (globals != nullptr) {
+        if (SharedPtr<Symbol> sym = globals->lookup(ident)) {
+            return sym;
+        }
+    }
+
+    Option<size_t> index = find_builtin(ident.str());
+    if (!index.has_value()) {
+        return nullptr;
+    }
+    return builtin_symbol(index.value());
+}
+
+void SemanticVisitor::declare(FnNode& fn) {
+    ASSERT(!is_builtin(fn.header->name), "cannot redeclare a builtin function.");
+    ASSERT(
+        !table.sym_exists_within_current_scope(fn.header->name),
+        format("function '{}' was already declared.", fn.header->name.as_str())
+    );
+
+    table.insert_symbol(
+        fn.header->name, 
+        std::make_shared<SymFunction>(
+            SymFunction{fn.header->params, fn.header->ret_type}
+        )
+    );
+}
+
+bool SemanticVisitor::sema_ptr_mut_within_assignment(ArenaPtr<ExprNode>& expr) {
     switch(expr->id)
     {
         case NodeId::Term:
         {
-            auto* var = dynamic_cast<VarTerminalNode*>(expr.get());
-            ASSERT(table.sym_exists(var->ident), format("variable '{}' does not exist in the current scope", var->ident.as_str()));
-            SharedPtr<Symbol> sym = table.fetch_symbol(var->ident);
+            auto* var = static_cast<VarTerminalNode*>(expr.get());
+            SharedPtr<Symbol> sym = lookup(var->ident);
+            ASSERT(sym != nullptr, format("variable '{}' does not exist in the current scope", var->ident.as_str()));
             if (sym->sym_kind == SymKind::Var) {
                 SharedPtr<VarSymbol> metadata = std::dynamic_pointer_cast<VarSymbol>(sym);
                 if(metadata->mut != Mutability::Mutable) {
@@ -24,7 +56,7 @@ bool SemanticVisitor::sema_ptr_mut_within_assignment(Ptr<ExprNode>& expr) {
         }
         case NodeId::Un: 
         {
-            auto* un = dynamic_cast<UnaryOpNode*>(expr.get());
+            auto* un = static_cast<UnaryOpNode*>(expr.get());
             return sema_ptr_mut_within_assignment(un->lhs);
             break;
         }
@@ -35,21 +67,10 @@ bool SemanticVisitor::sema_ptr_mut_within_assignment(Ptr<ExprNode>& expr) {
     }
 }
 
-bool SemanticVisitor::sema_type_primitive_cmp(
-    SharedPtr<Type>& ty, 
-    Primitive&& expected
-) {
-    if (ty->fam != TypeFamily::Primitive) {
-        return false;
-    }
-    auto prim = std::dynamic_pointer_cast<PrimitiveType>(ty);
-    return prim && prim->cmp(std::move(expected));
-}
-
-SharedPtr<Type> SemanticVisitor::sema_ptr_arithmetics(
+TypeRef SemanticVisitor::sema_ptr_arithmetics(
     const BinOpKind& op, 
-    SharedPtr<Type>& lhs, 
-    SharedPtr<Type>& rhs
+    TypeRef lhs, 
+    TypeRef rhs
 ) {
     switch (op)
     {
@@ -75,13 +96,13 @@ SharedPtr<Type> SemanticVisitor::sema_ptr_arithmetics(
             // * ptr - ptr
             // * ptr - int
             if (lhs->fam == TypeFamily::Pointer && rhs->fam == TypeFamily::Pointer) {
-                auto l_ptr = std::dynamic_pointer_cast<PointerType>(lhs);
-                auto r_ptr = std::dynamic_pointer_cast<PointerType>(rhs);
+                auto* l_ptr = static_cast<const PointerType*>(lhs);
+                auto* r_ptr = static_cast<const PointerType*>(rhs);
                 ASSERT(
-                    sema_type_cmp(*l_ptr->underlying, *r_ptr->underlying),
+                    sema_type_cmp(l_ptr->underlying, r_ptr->underlying),
                     format("cannot perform '{}' operation on '{}' and '{}'", bin_op_str(op), lhs->as_str(), rhs->as_str())
                 );
-                return std::make_shared<PrimitiveType>(Primitive::Int);
+                return primitive_type(Primitive::Int);
             }
             if(lhs->fam == TypeFamily::Pointer && sema_type_primitive_cmp(rhs, Primitive::Int)) {
                 return lhs;
@@ -97,13 +118,13 @@ SharedPtr<Type> SemanticVisitor::sema_ptr_arithmetics(
         case BinOpKind::Le:
         {
             if (lhs->fam == TypeFamily::Pointer && rhs->fam == TypeFamily::Pointer) {
-                auto l_ptr = std::dynamic_pointer_cast<PointerType>(lhs);
-                auto r_ptr = std::dynamic_pointer_cast<PointerType>(rhs);
+                auto* l_ptr = static_cast<const PointerType*>(lhs);
+                auto* r_ptr = static_cast<const PointerType*>(rhs);
                 ASSERT(
-                    sema_type_cmp(*l_ptr->underlying, *r_ptr->underlying),
+                    sema_type_cmp(l_ptr->underlying, r_ptr->underlying),
                     format("invalid comparison of different types: '{}' with '{}'", lhs->as_str(), rhs->as_str())
                 );
-                return std::make_shared<PrimitiveType>(Primitive::Boolean);
+                return primitive_type(Primitive::Boolean);
             }
             ASSERT(false, format("invalid pointer comparison: '{}' vs '{}'", lhs->as_str(), rhs->as_str()));
             return nullptr;
@@ -114,10 +135,10 @@ SharedPtr<Type> SemanticVisitor::sema_ptr_arithmetics(
     }
 }
 
-SharedPtr<Type> SemanticVisitor::sema_process_type(
+TypeRef SemanticVisitor::sema_process_type(
     const BinOpKind& op, 
-    SharedPtr<Type>& lhs, 
-    SharedPtr<Type>& rhs
+    TypeRef lhs, 
+    TypeRef rhs
 ) {
     if (lhs->fam == TypeFamily::Array || rhs->fam == TypeFamily::Array) {
         ASSERT(
@@ -129,7 +150,7 @@ SharedPtr<Type> SemanticVisitor::sema_process_type(
     if (lhs->fam == TypeFamily::Pointer || rhs->fam == TypeFamily::Pointer) {
         return sema_ptr_arithmetics(op, lhs, rhs);
     }
-    if(!sema_type_cmp(*lhs, *rhs)) {
+    if(!sema_type_cmp(lhs, rhs)) {
         return nullptr;
     }
     switch (op) {
@@ -150,7 +171,7 @@ SharedPtr<Type> SemanticVisitor::sema_process_type(
         case BinOpKind::Shr:
         {
             if (sema_type_primitive_cmp(rhs, Primitive::Int)) {
-                return std::make_shared<PrimitiveType>(Primitive::Int);
+                return primitive_type(Primitive::Int);
             }
             ASSERT(false, format("cannot shift type '{}'", lhs->as_str()));
             return nullptr;
@@ -164,7 +185,7 @@ SharedPtr<Type> SemanticVisitor::sema_process_type(
         case BinOpKind::And:
         case BinOpKind::Or:
         {
-            return std::make_shared<PrimitiveType>(Primitive::Boolean);
+            return primitive_type(Primitive::Boolean);
         }
         default:
         {
@@ -174,34 +195,34 @@ SharedPtr<Type> SemanticVisitor::sema_process_type(
     }
 }
 
-void SemanticVisitor::sema_analyze(LiteralNode& lit) {
+void SemanticVisitor::visit(LiteralNode& lit) {
     switch (lit.kind)
     {
         case LiteralKind::Int:
-            lit.sema_type = std::make_shared<PrimitiveType>(Primitive::Int);
+            lit.sema_type = primitive_type(Primitive::Int);
             break;
         case LiteralKind::Float:
-            lit.sema_type = std::make_shared<PrimitiveType>(Primitive::Float);
+            lit.sema_type = primitive_type(Primitive::Float);
             break;
         case LiteralKind::Char:
-            lit.sema_type = std::make_shared<PrimitiveType>(Primitive::Char);
+            lit.sema_type = primitive_type(Primitive::Char);
             break;
         case LiteralKind::Str:
             ASSERT(false, "unimplemented");
         case LiteralKind::Bool:
-            lit.sema_type = std::make_shared<PrimitiveType>(Primitive::Boolean);
+            lit.sema_type = primitive_type(Primitive::Boolean);
             break;
         default:
             UNREACHABLE();
     }
 };
 
-void SemanticVisitor::sema_analyze(BinOpNode& bin) {
-    bin.lhs->analyze(*this);
-    bin.rhs->analyze(*this);
+void SemanticVisitor::visit(BinOpNode& bin) {
+    dispatch(*bin.lhs);
+    dispatch(*bin.rhs);
 
-    auto& lhs_type = bin.lhs->sema_type;
-    auto& rhs_type = bin.rhs->sema_type;
+    TypeRef lhs_type = bin.lhs->sema_type;
+    TypeRef rhs_type = bin.rhs->sema_type;
 
     ASSERT(
         lhs_type && rhs_type, 
@@ -226,8 +247,8 @@ void SemanticVisitor::sema_analyze(BinOpNode& bin) {
     }
 };
 
-void SemanticVisitor::sema_analyze(UnaryOpNode& un) {
-    un.lhs->analyze(*this);
+void SemanticVisitor::visit(UnaryOpNode& un) {
+    dispatch(*un.lhs);
 
     switch (un.op) {
         case UnOpKind::Neg:
@@ -245,7 +266,7 @@ void SemanticVisitor::sema_analyze(UnaryOpNode& un) {
         case UnOpKind::Not:
         {
             if (sema_type_primitive_cmp(un.lhs->sema_type, Primitive::Boolean)) {
-                un.sema_type = std::make_shared<PrimitiveType>(Primitive::Boolean);
+                un.sema_type = primitive_type(Primitive::Boolean);
                 return;
             }
             ASSERT(false, format("cannot apply 'not' to type '{}'", un.lhs->sema_type->as_str()));
@@ -257,7 +278,7 @@ void SemanticVisitor::sema_analyze(UnaryOpNode& un) {
                 sema_type_primitive_cmp(un.lhs->sema_type, Primitive::Boolean) ||
                 sema_type_primitive_cmp(un.lhs->sema_type, Primitive::Char)
             ) {
-                un.sema_type = std::make_shared<PrimitiveType>(Primitive::Int);
+                un.sema_type = primitive_type(Primitive::Int);
                 return;
             }
             ASSERT(false, format("cannot apply '!' to type '{}'", un.lhs->sema_type->as_str()));
@@ -265,7 +286,7 @@ void SemanticVisitor::sema_analyze(UnaryOpNode& un) {
         case UnOpKind::AddrOf:
         {
             ASSERT(un.lhs->category == ValueCategory::LValue, format("cannot take address of r-value expression: '{}'", un.lhs->id_str()));
-            un.sema_type = std::make_shared<PointerType>(un.lhs->sema_type);
+            un.sema_type = pointer_type(un.lhs->sema_type);
             un.category = ValueCategory::RValue;
             break;
         }
@@ -280,7 +301,7 @@ void SemanticVisitor::sema_analyze(UnaryOpNode& un) {
                 format("cannot dereference r-value expression: '{}'", un.lhs->id_str())
             );
             un.category = ValueCategory::LValue;
-            un.sema_type = (std::dynamic_pointer_cast<PointerType>(un.lhs->sema_type))->underlying;
+            un.sema_type = static_cast<const PointerType*>(un.lhs->sema_type)->underlying;
             break;
         }
         default:
@@ -288,13 +309,13 @@ void SemanticVisitor::sema_analyze(UnaryOpNode& un) {
     }
 };
 
-void SemanticVisitor::sema_analyze(VarTerminalNode& term) {
+void SemanticVisitor::visit(VarTerminalNode& term) {
+    SharedPtr<Symbol> sym = lookup(term.ident);
     ASSERT(
-        table.sym_exists(term.ident), 
+        sym != nullptr, 
         format("'{}' was not declared in this scope.", term.ident.as_str())
     );
 
-    SharedPtr<Symbol> sym = table.fetch_symbol(term.ident);
     switch (sym->sym_kind)
     {
         case SymKind::Fn:
@@ -312,12 +333,12 @@ void SemanticVisitor::sema_analyze(VarTerminalNode& term) {
     }
 };
 
-void SemanticVisitor::sema_analyze(AssignmentNode& assign) {
+void SemanticVisitor::visit(AssignmentNode& assign) {
+    SharedPtr<Symbol> sym = lookup(assign.lvalue);
     ASSERT(
-        table.sym_exists(assign.lvalue), 
+        sym != nullptr, 
         format("'{}' was not declared in this scope.", assign.lvalue.as_str())
     );
-    SharedPtr<Symbol> sym = table.fetch_symbol(assign.lvalue);
     switch (sym->sym_kind)
     {
         case SymKind::Var:
@@ -329,9 +350,9 @@ void SemanticVisitor::sema_analyze(AssignmentNode& assign) {
             );
             
             auto& expr = assign.rvalue;
-            expr->analyze(*this);
+            dispatch(*expr);
         
-            if(!sema_type_cmp(*expr->sema_type, *metadata->type)) {
+            if(!sema_type_cmp(expr->sema_type, metadata->type)) {
                 ASSERT(
                     false,
                     format(
@@ -358,9 +379,9 @@ void SemanticVisitor::sema_analyze(AssignmentNode& assign) {
     }    
 }
 
-void SemanticVisitor::sema_analyze(DerefAssignmentNode& deref_assign) {
-    deref_assign.lvalue->analyze(*this);
-    deref_assign.rvalue->analyze(*this);
+void SemanticVisitor::visit(DerefAssignmentNode& deref_assign) {
+    dispatch(*deref_assign.lvalue);
+    dispatch(*deref_assign.rvalue);
 
     ASSERT(
         deref_assign.lvalue->category == ValueCategory::LValue, 
@@ -368,7 +389,7 @@ void SemanticVisitor::sema_analyze(DerefAssignmentNode& deref_assign) {
     );
     sema_ptr_mut_within_assignment(deref_assign.lvalue);
     ASSERT(
-        sema_type_cmp(*deref_assign.lvalue->sema_type, *deref_assign.rvalue->sema_type),
+        sema_type_cmp(deref_assign.lvalue->sema_type, deref_assign.rvalue->sema_type),
         format(
             "mismatched types: cannot assign '{}' to pointer of type '{}'", 
             deref_assign.rvalue->sema_type->as_str(), 
@@ -377,9 +398,9 @@ void SemanticVisitor::sema_analyze(DerefAssignmentNode& deref_assign) {
     );
 };
 
-void SemanticVisitor::sema_analyze(VarDeclarationNode& decl) {
+void SemanticVisitor::visit(VarDeclarationNode& decl) {
     ASSERT(
-        !table.sym_exists(decl.info.ident), 
+        lookup(decl.info.ident) == nullptr, 
         format("'{}' was already declared in this scope.", decl.info.ident.as_str())
     );
 
@@ -393,10 +414,10 @@ void SemanticVisitor::sema_analyze(VarDeclarationNode& decl) {
     }
 
     auto& expr = decl.init;
-    expr->analyze(*this);   
+    dispatch(*expr);   
     ASSERT(expr->sema_type != nullptr, "[core:err]: expression must be bound to a type");
 
-    if(!sema_type_cmp(*expr->sema_type, *decl.info.type)) {
+    if(!sema_type_cmp(expr->sema_type, decl.info.type)) {
         ASSERT(
             false,
             format("mismatched types: got '{}', expected: '{}'", expr->sema_type->as_str(), decl.info.type->as_str())
@@ -410,12 +431,12 @@ void SemanticVisitor::sema_analyze(VarDeclarationNode& decl) {
     );
 }
 
-void SemanticVisitor::sema_analyze(FnCallNode& fn_call) {
+void SemanticVisitor::visit(FnCallNode& fn_call) {
+    SharedPtr<Symbol> sym = lookup(fn_call.ident);
     ASSERT(
-        table.sym_exists(fn_call.ident), 
+        sym != nullptr, 
         format("'{}' was not declared in this scope.", fn_call.ident.as_str())
     );
-    SharedPtr<Symbol> sym = table.fetch_symbol(fn_call.ident);
     ASSERT(
         sym->sym_kind == SymKind::Fn,
         format("'{}' is not a function and cannot be called.", fn_call.ident.as_str())
@@ -435,11 +456,11 @@ void SemanticVisitor::sema_analyze(FnCallNode& fn_call) {
     size_t cur = 0;
     while(cur < fn_call.args.size()) {
         auto& usr_arg = fn_call.args.at(cur);
-        usr_arg->analyze(*this);
+        dispatch(*usr_arg);
 
         auto& param = fn->params.at(cur);
         ASSERT(
-            sema_type_cmp(*usr_arg->sema_type, *param.type),
+            sema_type_cmp(usr_arg->sema_type, param.type),
             format(
                 "in '{}', '{}' expects argument of type '{}', but got '{}'",
                 fn_call.ident.as_str(),
@@ -454,44 +475,36 @@ void SemanticVisitor::sema_analyze(FnCallNode& fn_call) {
     fn_call.sema_type = fn->ret_type;
 };
 
-void SemanticVisitor::sema_analyze(BlockNode& block) {
+void SemanticVisitor::visit(BlockNode& block) {
     for (auto& stmt : block.children) {
-        if(stmt) stmt->analyze(*this);
+        if(stmt) dispatch(*stmt);
     }
 }
 
-void SemanticVisitor::sema_analyze(FnHeaderNode& fn_header) {
+void SemanticVisitor::visit(FnHeaderNode& fn_header) {
     for(const Parameter& param : fn_header.params) {
         SharedPtr<VarSymbol> sym = std::make_shared<VarSymbol>(param.type, param.mut);
         table.insert_symbol(param.ident, std::move(sym));
     }
 }
 
-void SemanticVisitor::sema_analyze(FnNode& fn) {
-    ASSERT(!is_builtin(fn.header->name), "cannot redeclare a builtin function.");
-
-    // Add a new function symbol to global scope.
-    table.insert_symbol(
-        fn.header->name, 
-        std::make_shared<SymFunction>(
-            SymFunction{fn.header->params, fn.header->ret_type}
-        )
-    );
+void SemanticVisitor::visit(FnNode& fn) {
+    // The signature was bound by `declare`, when the program was gathered.
     table.push_scope();
-    fn.header->analyze(*this);
-    fn.body->analyze(*this);
+    visit(*fn.header);
+    visit(*fn.body);
     table.pop_scope();
 }
 
-void SemanticVisitor::sema_analyze(ReturnNode& ret) {
-    SharedPtr<SymFunction> fn = std::dynamic_pointer_cast<SymFunction>(table.fetch_symbol(ret.fn));
+void SemanticVisitor::visit(ReturnNode& ret) {
+    SharedPtr<SymFunction> fn = std::dynamic_pointer_cast<SymFunction>(lookup(ret.fn));
 
     if (sema_type_primitive_cmp(fn->ret_type, Primitive::Free)) 
     {
         if (ret.expr == nullptr) {
             return;
         } else {
-            ret.expr->analyze(*this);
+            dispatch(*ret.expr);
             ASSERT(
                 false,
                 format(
@@ -512,9 +525,9 @@ void SemanticVisitor::sema_analyze(ReturnNode& ret) {
                 fn->ret_type->as_str()
             )
         );
-        ret.expr->analyze(*this);
+        dispatch(*ret.expr);
         ASSERT(
-            sema_type_cmp(*fn->ret_type, *ret.expr->sema_type),
+            sema_type_cmp(fn->ret_type, ret.expr->sema_type),
             format(
                 "Type mismatch in return: function '{}' expects '{}' but got '{}'", 
                 ret.fn.as_str(),
@@ -525,34 +538,33 @@ void SemanticVisitor::sema_analyze(ReturnNode& ret) {
     }
 };
 
-void SemanticVisitor::sema_analyze(BreakNode& brk) {
+void SemanticVisitor::visit(BreakNode& brk) {
     // A function just to pass over this function when analyzing any block;
     while(true) break;
 }
 
-void SemanticVisitor::sema_analyze(LoopNode& loop) {
-    loop.body->analyze(*this);
+void SemanticVisitor::visit(LoopNode& loop) {
+    visit(*loop.body);
 };
 
-void SemanticVisitor::sema_analyze(ImportNode& import) {
+void SemanticVisitor::visit(ImportNode& import) {
     ASSERT(false, "NOT IMPLEMENTED");
 };
 
-void SemanticVisitor::sema_analyze(IfNode& cfn) {
-    cfn.condition->analyze(*this);
+void SemanticVisitor::visit(IfNode& cfn) {
+    dispatch(*cfn.condition);
 
-    PrimitiveType boolean{Primitive::Boolean};
-    if(!sema_type_cmp(*cfn.condition->sema_type, boolean)) {
+    if(!sema_type_primitive_cmp(cfn.condition->sema_type, Primitive::Boolean)) {
         ASSERT(false, "'if' condition must have a 'bool' type");
     }
 
     table.push_scope();
-    cfn.if_block->analyze(*this);
+    visit(*cfn.if_block);
     table.pop_scope();
     
     if(cfn.else_block != nullptr) {
         table.push_scope();
-        cfn.else_block->analyze(*this);
+        visit(*cfn.else_block);
         table.pop_scope();
     }
 }
\ No newline at end of file
@@ -3,79 +3,58 @@
 
 #include "sym.hpp"
 #include "builtins.hpp"
-#include <array>
+#include "visit.hpp"
 
 using Tokenizer::bin_op_str;
 using Tokenizer::assign_op_str;
 using Tokenizer::un_op_str;
 
-struct LiteralNode;
-struct BinOpNode;
-struct UnaryOpNode;
-struct VarDeclarationNode;
-struct VarTerminalNode;
-struct AssignmentNode;
-struct DerefAssignmentNode;
-struct FnHeaderNode;
-struct FnNode;
-struct BlockNode;
-struct LoopNode;
-struct IfNode;
-struct BreakNode;
-struct ReturnNode;
-struct FnCallNode;
-struct ImportNode;
-struct ExprNode;
-
-struct SemanticVisitor {
-    using BuiltIns = std::array<std::string, 1>;
-
+struct SemanticVisitor : NodeVisitor<SemanticVisitor> {
     SymTable table;
+    // Function signatures of the whole program, shared read-only between visitors.
+    const SymTable* globals;
     
-    SemanticVisitor() : table() {}
-    
-    void include_builtins() {
-        for (const auto& builtin : BUILTINS) {
-            auto sym = sig_to_sym(builtin.signature);
-            ASSERT(sym.has_value(), format("caught an invalid signature parsing attempt: '{}'", builtin.signature));
-            
-            SharedPtr<SymFunction> fn = std::make_shared<SymFunction>(std::move(sym.value()));
-            table.insert_symbol(builtin.ident, std::move(fn));
-        }
-    };
+    explicit SemanticVisitor(const SymTable* globals = nullptr) : table(), globals(globals) {}
+
+    // The innermost symbol bound to `ident`, falling back to the globals and then the builtins, or `nullptr`.
+    SharedPtr<Symbol> lookup(const Identifier& ident);
+
+    // Binds the signature of `fn` in the current scope, before any body is analyzed.
+    void declare(FnNode& fn);
 
     inline bool is_builtin(const Identifier& ident) {
-        for(const auto& builtin_symbol : BUILTINS)
-            if(ident.matches(builtin_symbol.ident)) return true;
-        return false;
+        return find_builtin(ident.str()).has_value();
     };
 
-    inline bool sema_type_cmp(Type& given, Type& expected) {
-        return given.hash() == expected.hash();
+    // Types are interned, so equal types are the same object.
+    inline bool sema_type_cmp(TypeRef given, TypeRef expected) {
+        return given == expected;
     }
     
-    SharedPtr<Type> sema_ptr_arithmetics(const BinOpKind& op, SharedPtr<Type>& lhs, SharedPtr<Type>& rhs);
-    SharedPtr<Type> sema_process_type(const BinOpKind& op, SharedPtr<Type>& lhs, SharedPtr<Type>& rhs);
+    TypeRef sema_ptr_arithmetics(const BinOpKind& op, TypeRef lhs, TypeRef rhs);
+    TypeRef sema_process_type(const BinOpKind& op, TypeRef lhs, TypeRef rhs);
     
-    bool sema_type_primitive_cmp(SharedPtr<Type>& ty, Primitive&& expected);
-    bool sema_ptr_mut_within_assignment(Ptr<ExprNode>& expr);
-
-    void sema_analyze(LiteralNode& lit);
-    void sema_analyze(BinOpNode& bin);
-    void sema_analyze(UnaryOpNode& un);
-    void sema_analyze(VarTerminalNode& term);
-    void sema_analyze(VarDeclarationNode& decl);
-    void sema_analyze(FnHeaderNode& fn_header);
-    void sema_analyze(FnNode& fn);
-    void sema_analyze(BlockNode& block);
-    void sema_analyze(LoopNode& loop);
-    void sema_analyze(IfNode& cfn);
-    void sema_analyze(BreakNode& brk);
-    void sema_analyze(ReturnNode& ret);
-    void sema_analyze(FnCallNode& fn_call);
-    void sema_analyze(AssignmentNode& assignment);
-    void sema_analyze(DerefAssignmentNode& deref_assignment);
-    void sema_analyze(ImportNode& imprt);
+    inline bool sema_type_primitive_cmp(TypeRef ty, Primitive expected) {
+        return ty == primitive_type(expected);
+    }
+    bool sema_ptr_mut_within_assignment(ArenaPtr<ExprNode>& expr);
+
+    void visit(LiteralNode& lit);
+    void visit(BinOpNode& bin);
+    void visit(UnaryOpNode& un);
+    void visit(VarTerminalNode& term);
+    void visit(VarDeclarationNode& decl);
+    void visit(FnHeaderNode& fn_header);
+    void visit(FnNode& fn);
+    void visit(BlockNode& block);
+    void visit(LoopNode& loop);
+    void visit(IfNode& cfn);
+    void visit(BreakNode& brk);
+    void visit(ReturnNode& ret);
+    void visit(FnCallNode& fn_call);
+    void visit(AssignmentNode& assignment);
+    void visit(DerefAssignmentNode& deref_assignment);
+    void visit(ImportNode& imprt);
 };
 
 #endif // SEMANTICS_HPP_
\ No newline at end of file
@@ -0,0 +1,87 @@
+#include "sym.hpp"
+
+SymTable::SymTable() 
+    : m_slots(64) {}
+
+size_t SymTable::probe(SymId name) const {
+    size_t mask = m_slots.size() - 1;
+    // Fibonacci hashing spreads the dense interner ids over the table.
+    size_t slot = (static_cast<size_t>(name.id) * 0x9E3779B97F4A7C15ull >> 32) & mask;
+
+    while (m_slots[slot].name != NONE && m_slots[slot].name != name.id) {
+        slot = (slot + 1) & mask;
+    }
+    return slot;
+}
+
+void SymTable::grow() {
+    std::vector<Slot> old = std::move(m_slots);
+    m_slots.assign(old.size() * 2, Slot{});
+
+    for (const Slot& entry : old) {
+        if (entry.name != NONE) {
+            m_slots[probe(SymId{entry.name})] = entry;
+        }
+    }
+}
+
+void SymTable::push_scope() {
+    m_marks.push_back(static_cast<uint32_t>(m_bindings.size()));
+}
+
+void SymTable::pop_scope() {
+    ASSERT(!m_marks.empty(), "[fatal::err] cannot pop the global scope.");
+
+    uint32_t mark = m_marks.back();
+    m_marks.pop_back();
+
+    // Unwind innermost first, so every name falls back to the binding it shadowed.
+    for (size_t i = m_bindings.size(); i > mark; --i) {
+        const Binding& binding = m_bindings[i - 1];
+        m_slots[probe(binding.name)].top = binding.shadowed;
+    }
+    m_bindings.resize(mark);
+}
+
+bool SymTable::sym_exists_within_current_scope(const Identifier& ident) const {
+    uint32_t top = top_of(ident.id());
+    return top != NONE && m_bindings[top].depth == depth();
+}
+
+SharedPtr<Symbol> SymTable::lookup(const Identifier& ident) const {
+    uint32_t top = top_of(ident.id());
+    return top != NONE ? m_bindings[top].symbol : nullptr;
+}
+
+SharedPtr<Symbol> SymTable::fetch_symbol(const Identifier& ident) const {
+    SharedPtr<Symbol> symbol = lookup(ident);
+    ASSERT(symbol != nullptr, std::format("{} does not exist in any scope", ident.as_str()));
+    return symbol;
+}
+
+void SymTable::insert_symbol(const Identifier& ident, SharedPtr<Symbol> symbol) {
+    ASSERT(
+        m_bindings.size() < NONE, 
+        "[fatal::err] ran out of symbol bindings."
+    );
+
+    size_t slot = probe(ident.id());
+    if (m_slots[slot].name == NONE) {
+        // Keep the load factor under a half.
+        if ((m_used + 1) * 2 > m_slots.size()) {
+            grow();
+            slot = probe(ident.id());
+        }
+        m_slots[slot].name = ident.id().id;
+        m_used++;
+    }
+
+    Slot& entry = m_slots[slot];
+    if (entry.top != NONE && m_bindings[entry.top].depth == depth()) {
+        m_bindings[entry.top].symbol = std::move(symbol);
+        return;
+    }
+
+    m_bindings.push_back(Binding{ ident.id(), std::move(symbol), depth(), entry.top });
+    entry.top = static_cast<uint32_t>(m_bindings.size() - 1);
+}
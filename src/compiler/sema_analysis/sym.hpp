@@ -1,7 +1,8 @@
 #ifndef SEMA_ANALYSIS_HPP_
 #define SEMA_ANALYSIS_HPP_
 
-#include <unordered_map>
+#include <cstdint>
+#include <vector>
 #include "stmt.hpp"
 
 enum class SymKind : int {
@@ -31,90 +32,85 @@ struct Symbol {
 
 struct VarSymbol : public Symbol {
     Mutability mut;
-    SharedPtr<Type> type;
+    TypeRef type;
 
-    VarSymbol(SharedPtr<Type> type, const Mutability& mut)
-        : Symbol(SymKind::Var), type(std::move(type)), mut(mut) {}
+    VarSymbol(TypeRef type, const Mutability& mut)
+        : Symbol(SymKind::Var), type(type), mut(mut) {}
 };
 
 struct SymFunction : public Symbol {
     using FnParams = std::vector<Declaration::Parameter>;
 
     FnParams params;
-    SharedPtr<Type> ret_type;
+    TypeRef ret_type;
     
-    SymFunction(FnParams params, SharedPtr<Type> ret_type)
-        : Symbol(SymKind::Fn), params(std::move(params)), ret_type(std::move(ret_type)) {}
+    SymFunction(FnParams params, TypeRef ret_type)
+        : Symbol(SymKind::Fn), params(std::move(params)), ret_type(ret_type) {}
 };
 
-struct Scope {
-    using SymIdent = std::string;
-    using _Table = std::unordered_map<SymIdent, SharedPtr<Symbol>>;
+/// @brief `SymTable`
+/// A flat scoped symbol table.
+/// Every name maps to the stack of symbols that currently shadow each other, innermost first,
+/// through one open-addressed map keyed by `SymId`. Bindings are appended to a single log in declaration order,
+/// so a scope is just a mark into that log and popping it unwinds the bindings past the mark.
+class SymTable {
+public:
+    SymTable();
 
-    _Table syms;
-    SharedPtr<Scope> parent;
+    void push_scope();
+    void pop_scope();
 
-    Scope(SharedPtr<Scope> parent_scp = nullptr) 
-        : syms(), parent(std::move(parent_scp)) {}
+    bool sym_exists_within_current_scope(const Identifier& ident) const;
 
     bool sym_exists(const Identifier& ident) const {
-        return syms.find(ident.as_str()) != syms.end();
+        return lookup(ident) != nullptr;
     }
 
-    SharedPtr<Symbol> get_symbol_in_self(const Identifier& ident) const {
-        ASSERT(
-            sym_exists(ident), 
-            std::format("[fatal::err] {} does not exist in current scope.", ident.as_str()
-        ));
-        auto it = syms.find(ident.as_str());
-        return it->second;
-    }
-};
+    // The innermost symbol bound to `ident`, or `nullptr`.
+    SharedPtr<Symbol> lookup(const Identifier& ident) const;
 
-struct SymTable {
-    SharedPtr<Scope> cur;
+    // Same as `lookup`, but the symbol must exist.
+    SharedPtr<Symbol> fetch_symbol(const Identifier& ident) const;
 
-    SymTable() 
-        : cur(std::make_shared<Scope>()) {}
+    // Binds `ident` in the current scope, replacing a binding of the same scope.
+    void insert_symbol(const Identifier& ident, SharedPtr<Symbol> symbol);
 
-    void push_scope() {
-        cur = std::make_shared<Scope>(cur);
-    }
+private:
+    static CONST uint32_t NONE = UINT32_MAX;
 
-    void pop_scope() {
-        ASSERT(cur->parent != nullptr, "[fatal::err] cannot pop the global scope.");
-        cur = cur->parent;
-    }
+    struct Binding {
+        SymId name;
+        SharedPtr<Symbol> symbol;
+        // Scope depth the binding was made in.
+        uint32_t depth;
+        // The binding it shadows, or `NONE`.
+        uint32_t shadowed;
+    };
 
-    bool sym_exists_within_current_scope(const Identifier& ident) const {
-        return cur->sym_exists(ident);
-    }
+    struct Slot {
+        // `NONE` marks an empty slot.
+        uint32_t name = NONE;
+        // Innermost binding of `name`, or `NONE` once every binding was popped.
+        uint32_t top = NONE;
+    };
 
-    bool sym_exists(const Identifier& ident) const {
-        SharedPtr<Scope> scope = cur;
-        while(!scope->sym_exists(ident)) {
-            if(scope->parent == nullptr) {
-                return false;
-            }
-            scope = scope->parent;
-        }
-        return true;
-    } 
-
-    SharedPtr<Symbol> fetch_symbol(const Identifier& ident) const {
-        SharedPtr<Scope> scope = cur;
-        while (scope) {
-            if (scope->sym_exists(ident)) {
-                return scope->get_symbol_in_self(ident);
-            }
-            scope = scope->parent;
-        }
-        ASSERT(false, std::format("{} does not exist in any scope", ident.as_str()));
-        return nullptr;
+    std::vector<Slot> m_slots;
+    size_t m_used = 0;
+
+    std::vector<Binding> m_bindings;
+    // Size of `m_bindings` when each open scope was pushed.
+    std::vector<uint32_t> m_marks;
+
+    // The slot of `name`, or the empty slot it would take.
+    size_t probe(SymId name) const;
+    void grow();
+
+    inline uint32_t depth() const {
+        return static_cast<uint32_t>(m_marks.size());
     }
 
-    void insert_symbol(const Identifier& ident, SharedPtr<Symbol> symbol) {
-        cur->syms[ident.as_str()] = std::move(symbol);
+    inline uint32_t top_of(SymId name) const {
+        return m_slots[probe(name)].top;
     }
 };
 
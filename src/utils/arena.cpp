@@ -0,0 +1,40 @@
+#include "arena.hpp"
+
+void* Arena::allocate(size_t size, size_t align) {
+    ASSERT(
+        align <= alignof(std::max_align_t) && (align & (align - 1)) == 0,
+        "[arena::err] unsupported alignment."
+    );
+
+    if (size > CHUNK_SIZE) {
+        // Oversized objects get a chunk of their own.
+        auto chunk = std::make_unique<std::byte[]>(size);
+        void* mem = chunk.get();
+
+        // Keep the chunk being filled last.
+        m_chunks.insert(m_chunks.empty() ? m_chunks.end() : m_chunks.end() - 1, std::move(chunk));
+        m_reserved_bytes += size;
+        m_used_bytes += size;
+        return mem;
+    }
+
+    size_t offset = (m_chunk_used + align - 1) & ~(align - 1);
+    if (offset + size > CHUNK_SIZE) {
+        m_chunks.emplace_back(std::make_unique<std::byte[]>(CHUNK_SIZE));
+        m_reserved_bytes += CHUNK_SIZE;
+        m_chunk_used = 0;
+        offset = 0;
+    }
+
+    m_used_bytes += offset + size - m_chunk_used;
+    m_chunk_used = offset + size;
+    return m_chunks.back().get() + offset;
+}
+
+Arena::Stats Arena::stats() const {
+    return Stats {
+        .objects = m_objects,
+        .used_bytes = m_used_bytes,
+        .reserved_bytes = m_reserved_bytes
+    };
+}
@@ -0,0 +1,70 @@
+#ifndef ARENA_HPP_
+#define ARENA_HPP_
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <utility>
+#include <vector>
+
+#include "alias.hpp"
+#include "common.hpp"
+
+/// @brief `ArenaDelete`
+/// Runs the destructor of an object living in an `Arena`, the memory itself is released with the arena.
+struct ArenaDelete {
+    template<typename T>
+    void operator()(T* ptr) const noexcept {
+        ptr->~T();
+    }
+};
+
+// Unique ownership of an object whose memory belongs to an `Arena`.
+template<typename T>
+using ArenaPtr = std::unique_ptr<T, ArenaDelete>;
+
+/// @brief `Arena`
+/// A bump allocator, objects are placed one after another in 64KiB chunks.
+/// Nothing is freed on its own, every chunk is released at once when the arena is destroyed.
+/// Objects must therefore never outlive the arena they were made in.
+class Arena {
+public:
+    struct Stats {
+        // Objects created through `make`.
+        size_t objects;
+        // Bytes handed out, alignment padding included.
+        size_t used_bytes;
+        // Bytes held by the chunks.
+        size_t reserved_bytes;
+    };
+
+    Arena() = default;
+    ~Arena() = default;
+
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    // Returns `size` bytes aligned to `align`, valid until the arena is destroyed.
+    void* allocate(size_t size, size_t align);
+
+    // Constructs a `T` in the arena.
+    template<typename T, typename... Args>
+    ArenaPtr<T> make(Args&&... args) {
+        void* mem = allocate(sizeof(T), alignof(T));
+        m_objects++;
+        return ArenaPtr<T>(::new (mem) T(std::forward<Args>(args)...));
+    }
+
+    Stats stats() const;
+
+private:
+    static CONST size_t CHUNK_SIZE = 1 << 16;
+
+    std::vector<std::unique_ptr<std::byte[]>> m_chunks;
+    size_t m_chunk_used = CHUNK_SIZE;
+    size_t m_used_bytes = 0;
+    size_t m_reserved_bytes = 0;
+    size_t m_objects = 0;
+};
+
+#endif // ARENA_HPP_
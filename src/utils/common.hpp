@@ -2,6 +2,7 @@
 #define COMMON_HPP_
 
 #include <cstdio>
+#include <cstdlib>
 #include <iostream>
 #include <string>
 #include <source_location>
@@ -15,6 +16,29 @@ CONST char* ASSERT_PREFIX = "ASSERTION";
 CONST char* TODO_PREFIX = "TODO";
 CONST char* UNREACHABLE_PREFIX = "UNREACHABLE";
 
+/// @brief `AssertionFailure`
+/// The report of a failed `ASSERT`, thrown instead of exiting while an `AssertionCapture` is alive.
+/// Parallel stages use it to report failures in a fixed order, no matter which worker failed first.
+struct AssertionFailure {
+    std::string report;
+};
+
+inline thread_local int assertion_captures = 0;
+
+// While alive, failed assertions on the current thread throw an `AssertionFailure`.
+struct AssertionCapture {
+    AssertionCapture() { assertion_captures++; }
+    ~AssertionCapture() { assertion_captures--; }
+
+    AssertionCapture(const AssertionCapture&) = delete;
+    AssertionCapture& operator=(const AssertionCapture&) = delete;
+};
+
+[[noreturn]] inline void report_failure(const AssertionFailure& failure) {
+    std::fputs(failure.report.c_str(), stderr);
+    std::exit(EXIT_FAILURE);
+}
+
 inline void ASSERT(
     bool cond, 
     const std::string& msg, 
@@ -22,10 +46,15 @@ inline void ASSERT(
     std::source_location loc = std::source_location::current()
 ) {
     if (!cond) {
-        std::fprintf(stderr, "[%s] ", prefix.c_str());
-        std::fprintf(stderr, "%s:%d:%d ", loc.file_name(), loc.line(), loc.column());
-        std::fprintf(stderr, "- %s\n", msg.c_str());
-        std::exit(EXIT_FAILURE);
+        AssertionFailure failure{
+            "[" + prefix + "] " 
+            + loc.file_name() + ":" + std::to_string(loc.line()) + ":" + std::to_string(loc.column()) 
+            + " - " + msg + "\n"
+        };
+        if (assertion_captures > 0) {
+            throw failure;
+        }
+        report_failure(failure);
     }
 }
 
@@ -9,6 +9,8 @@ using Path = fs::path;
 
 CONST char* SRC_EXTENSTION = ".wo";
 CONST char* OUT_EXTENSION  = ".out";
+// Passed instead of a source file, the program is read from stdin.
+CONST char* STDIN_SOURCE   = "-";
 
 inline bool real_loc(const fs::path& fp) {
     return fs::exists(fp);
@@ -22,4 +24,12 @@ inline bool matches_ext(const fs::path& fp, const char* ext) {
     return fp.extension() == ext;
 }
 
+// The path outputs of `src` are named after, a program from stdin is named 'stdin' in the working directory.
+inline fs::path artifact_path(const fs::path& src) {
+    if (src == STDIN_SOURCE) {
+        return fs::path("stdin") += SRC_EXTENSTION;
+    }
+    return src;
+}
+
 #endif // FILE_HPP_
\ No newline at end of file
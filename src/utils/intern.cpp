@@ -0,0 +1,91 @@
+#include <cstring>
+#include <limits>
+
+#include "common.hpp"
+#include "intern.hpp"
+
+Interner::Interner() {
+    // Reserve `SymId{0}` for the empty string.
+    m_ids.emplace(std::string_view{}, push_name(std::string_view{}));
+}
+
+Interner& Interner::global() {
+    static Interner interner;
+    return interner;
+}
+
+std::string_view Interner::store(std::string_view name) {
+    if (name.size() > CHUNK_SIZE) {
+        // Oversized names get a chunk of their own.
+        auto chunk = std::make_unique<char[]>(name.size());
+        std::memcpy(chunk.get(), name.data(), name.size());
+        std::string_view stored{ chunk.get(), name.size() };
+
+        // Keep the chunk being filled last.
+        m_chunks.insert(m_chunks.empty() ? m_chunks.end() : m_chunks.end() - 1, std::move(chunk));
+        m_stored_bytes += name.size();
+        return stored;
+    }
+
+    if (CHUNK_SIZE - m_chunk_used < name.size()) {
+        m_chunks.emplace_back(std::make_unique<char[]>(CHUNK_SIZE));
+        m_chunk_used = 0;
+    }
+
+    char* dst = m_chunks.back().get() + m_chunk_used;
+    std::memcpy(dst, name.data(), name.size());
+    m_chunk_used += name.size();
+    m_stored_bytes += name.size();
+    return { dst, name.size() };
+}
+
+SymId Interner::push_name(std::string_view name) {
+    size_t biased = m_names + FIRST_SEGMENT;
+    size_t segment = std::bit_width(biased) - 1 - FIRST_SEGMENT_BITS;
+
+    if (m_owned_segments[segment] == nullptr) {
+        m_owned_segments[segment] = std::make_unique<std::string_view[]>(FIRST_SEGMENT << segment);
+        m_segments[segment].store(m_owned_segments[segment].get(), std::memory_order_release);
+    }
+    m_owned_segments[segment][biased - (FIRST_SEGMENT << segment)] = name;
+    return SymId{ static_cast<uint32_t>(m_names++) };
+}
+
+SymId Interner::intern(std::string_view name) {
+    std::lock_guard lock(m_mutex);
+    m_lookups++;
+
+    if (auto it = m_ids.find(name); it != m_ids.end()) {
+        m_bytes_saved += name.size();
+        return it->second;
+    }
+
+    ASSERT(
+        m_names < std::numeric_limits<uint32_t>::max(),
+        "[interner::err] ran out of symbol ids."
+    );
+
+    std::string_view stored = store(name);
+    SymId sym = push_name(stored);
+    m_ids.emplace(stored, sym);
+    return sym;
+}
+
+Option<SymId> Interner::find(std::string_view name) const {
+    std::lock_guard lock(m_mutex);
+    if (auto it = m_ids.find(name); it != m_ids.end()) {
+        return it->second;
+    }
+    return std::nullopt;
+}
+
+Interner::Stats Interner::stats() const {
+    std::lock_guard lock(m_mutex);
+    return Stats {
+        // The reserved empty string is not counted.
+        .symbols = m_names - 1,
+        .stored_bytes = m_stored_bytes,
+        .lookups = m_lookups,
+        .bytes_saved = m_bytes_saved
+    };
+}
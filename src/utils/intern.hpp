@@ -0,0 +1,119 @@
+#ifndef INTERN_HPP_
+#define INTERN_HPP_
+
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "alias.hpp"
+
+/// @brief `SymId`
+/// A 32-bit handle to a string owned by the global `Interner`.
+/// Two symbols are equal if and only if their names are equal, so comparing and hashing is an integer operation.
+/// It is intentionally not formattable, use `str()` when the name itself is needed.
+struct SymId {
+    uint32_t id = 0;
+
+    bool operator==(const SymId& other) const = default;
+
+    // The name behind the symbol, valid for the lifetime of the program.
+    std::string_view str() const;
+
+    std::string as_str() const {
+        return std::string(str());
+    }
+};
+
+template<>
+struct std::hash<SymId> {
+    size_t operator()(const SymId& sym) const noexcept {
+        return sym.id;
+    }
+};
+
+/// @brief `Interner`
+/// Maps every distinct name seen by the compiler to a `SymId`.
+/// Names are copied once into chunked storage that never moves, so views into it never dangle.
+/// The empty string is always `SymId{0}`, which is also what a default constructed `SymId` refers to.
+/// Safe to share between threads: `intern` and `find` serialize on a mutex, `lookup` takes no lock.
+class Interner {
+public:
+    struct Stats {
+        // Distinct names stored.
+        size_t symbols;
+        // Bytes used by the stored names.
+        size_t stored_bytes;
+        // Total calls to `intern`.
+        size_t lookups;
+        // Bytes of names that were already interned, and would have been copied otherwise.
+        size_t bytes_saved;
+    };
+
+    Interner(const Interner&) = delete;
+    Interner& operator=(const Interner&) = delete;
+
+    // The interner shared by every stage of the compiler.
+    static Interner& global();
+
+    // Returns the symbol of `name`, storing it if it was not seen before.
+    SymId intern(std::string_view name);
+
+    // Returns the symbol of `name` only if it was already interned.
+    Option<SymId> find(std::string_view name) const;
+
+    inline std::string_view lookup(SymId sym) const {
+        size_t biased = size_t(sym.id) + FIRST_SEGMENT;
+        size_t segment = std::bit_width(biased) - 1 - FIRST_SEGMENT_BITS;
+        return m_segments[segment].load(std::memory_order_acquire)[biased - (FIRST_SEGMENT << segment)];
+    }
+
+    Stats stats() const;
+
+private:
+    static CONST size_t CHUNK_SIZE = 1 << 16;
+
+    // Names are indexed by id in segments that double in size and never move,
+    // segment `k` holds ids [FIRST_SEGMENT * (2^k - 1), FIRST_SEGMENT * (2^(k+1) - 1)).
+    static CONST size_t FIRST_SEGMENT_BITS = 10;
+    static CONST size_t FIRST_SEGMENT = size_t(1) << FIRST_SEGMENT_BITS;
+    static CONST size_t SEGMENTS = 33 - FIRST_SEGMENT_BITS;
+
+    mutable std::mutex m_mutex;
+
+    std::vector<std::unique_ptr<char[]>> m_chunks;
+    size_t m_chunk_used = CHUNK_SIZE;
+    size_t m_stored_bytes = 0;
+
+    std::array<std::unique_ptr<std::string_view[]>, SEGMENTS> m_owned_segments;
+    std::array<std::atomic<std::string_view*>, SEGMENTS> m_segments{};
+    size_t m_names = 0;
+    std::unordered_map<std::string_view, SymId> m_ids;
+
+    size_t m_lookups = 0;
+    size_t m_bytes_saved = 0;
+
+    Interner();
+
+    // Copies `name` into stable storage.
+    std::string_view store(std::string_view name);
+
+    // Appends `name` under the next id.
+    SymId push_name(std::string_view name);
+};
+
+inline SymId intern(std::string_view name) {
+    return Interner::global().intern(name);
+}
+
+inline std::string_view SymId::str() const {
+    return Interner::global().lookup(*this);
+}
+
+#endif // INTERN_HPP_
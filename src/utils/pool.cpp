@@ -0,0 +1,99 @@
+#include <algorithm>
+
+#include "common.hpp"
+#include "pool.hpp"
+
+WorkerPool::WorkerPool(size_t size) {
+    for (size_t worker = 1; worker < std::max<size_t>(size, 1); ++worker) {
+        m_threads.emplace_back([this, worker] { work(worker); });
+    }
+}
+
+WorkerPool::~WorkerPool() {
+    {
+        std::lock_guard lock(m_mutex);
+        m_stop = true;
+    }
+    m_wake.notify_all();
+    for (auto& thread : m_threads) {
+        thread.join();
+    }
+}
+
+size_t WorkerPool::hardware_workers() {
+    return std::max<size_t>(std::thread::hardware_concurrency(), 1);
+}
+
+void WorkerPool::drain(const Job& job, size_t worker) {
+    for (size_t index = m_next.fetch_add(1); index < m_count; index = m_next.fetch_add(1)) {
+        job(index, worker);
+    }
+}
+
+void WorkerPool::work(size_t worker) {
+    size_t seen = 0;
+    while (true) {
+        const Job* job = nullptr;
+        {
+            std::unique_lock lock(m_mutex);
+            m_wake.wait(lock, [&] { return m_stop || m_generation != seen; });
+            if (m_stop) {
+                return;
+            }
+            seen = m_generation;
+            job = m_job;
+        }
+
+        drain(*job, worker);
+
+        std::lock_guard lock(m_mutex);
+        if (--m_busy == 0) {
+            m_done.notify_one();
+        }
+    }
+}
+
+void WorkerPool::run(size_t count, const Job& job) {
+    // Not worth waking anyone.
+    if (m_threads.empty() || count <= 1) {
+        for (size_t index = 0; index < count; ++index) {
+            job(index, 0);
+        }
+        return;
+    }
+
+    {
+        std::lock_guard lock(m_mutex);
+        m_job = &job;
+        m_count = count;
+        m_next = 0;
+        m_busy = m_threads.size();
+        m_generation++;
+    }
+    m_wake.notify_all();
+
+    drain(job, 0);
+
+    std::unique_lock lock(m_mutex);
+    m_done.wait(lock, [&] { return m_busy == 0; });
+    m_job = nullptr;
+}
+
+void WorkerPool::run_checked(size_t count, const Job& job) {
+    std::vector<Option<AssertionFailure>> failures(count);
+
+    run(count, [&](size_t index, size_t worker) {
+        AssertionCapture capture;
+        try {
+            job(index, worker);
+        } catch (AssertionFailure& failure) {
+            failures[index] = std::move(failure);
+        }
+    });
+
+    for (auto& failure : failures) {
+        if (failure.has_value()) {
+            report_failure(failure.value());
+        }
+    }
+}
@@ -0,0 +1,63 @@
+#ifndef POOL_HPP_
+#define POOL_HPP_
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "alias.hpp"
+
+/// @brief `WorkerPool`
+/// A fixed set of threads for index-parallel jobs.
+/// `run(count, job)` calls `job(index, worker)` once for every index in [0, count) and returns once every call did.
+/// The calling thread takes part as worker 0, so a pool of size 1 runs everything inline.
+/// Jobs passed to `run` must not throw, stages that can fail use `run_checked`.
+class WorkerPool {
+public:
+    using Job = Closure<void, size_t, size_t>;
+
+    explicit WorkerPool(size_t size);
+    ~WorkerPool();
+
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    // Workers taking part in a job, the calling thread included.
+    size_t size() const {
+        return m_threads.size() + 1;
+    }
+
+    void run(size_t count, const Job& job);
+
+    // Like `run`, but a failed `ASSERT` inside a job is held until every job finished.
+    // The failure with the lowest index is then reported, which is the one a serial run would have stopped at.
+    void run_checked(size_t count, const Job& job);
+
+    // Threads the machine can run at once, at least one.
+    static size_t hardware_workers();
+
+private:
+    std::vector<std::thread> m_threads;
+
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+    std::condition_variable m_done;
+
+    // The job being run, published under `m_mutex`.
+    const Job* m_job = nullptr;
+    size_t m_count = 0;
+    size_t m_generation = 0;
+    // Pool threads still working on the current job.
+    size_t m_busy = 0;
+    bool m_stop = false;
+
+    // Next index to hand out.
+    std::atomic<size_t> m_next = 0;
+
+    void work(size_t worker);
+    void drain(const Job& job, size_t worker);
+};
+
+#endif // POOL_HPP_